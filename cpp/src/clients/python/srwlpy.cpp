@@ -97,6 +97,7 @@ static const char strEr_BadPrec_CalcElecFieldSR[] = "Incorrect precision paramet
 static const char strEr_BadArg_CalcStokesUR[] = "Incorrect arguments for UR Stokes parameters calculation function";
 static const char strEr_BadArg_CalcPowDenSR[] = "Incorrect arguments for SR power density calculation function";
 static const char strEr_BadArg_CalcElecFieldGaussian[] = "Incorrect precision parameters for Gaussian beam electric field calculation";
+static const char strEr_BadArg_CalcElecFieldGaussianModes[] = "Incorrect arguments for Gaussian beam modes electric field calculation";
 static const char strEr_BadArg_CalcElecFieldSpherWave[] = "Incorrect precision parameters for spherical wave electric field calculation";
 static const char strEr_BadArg_CalcIntFromElecField[] = "Incorrect arguments for intensity extraction function";
 static const char strEr_BadArg_ResizeElecField[] = "Incorrect arguments for electric field resizing function";
@@ -112,6 +113,16 @@ static const char strEr_BadArg_UtiUndFromMagFldTab[] = "Incorrect arguments for
 static const char strEr_BadArg_UtiUndFindMagFldInterpInds[] = "Incorrect arguments for magnetic field interpolaton index search function";
 static const char strEr_BadArg_UtiIntInf[] = "Incorrect arguments for function analyzing intensity distributions";
 static const char strEr_BadArg_UtiIntProc[] = "Incorrect arguments for function performing misc. operations on intensity distributions";
+static const char strEr_BadArg_UtiSampPartBeam[] = "Incorrect arguments for function generating particle beam phase-space coordinates";
+static const char strEr_BadArg_UtiTrjPrep[] = "Incorrect arguments for trajectory preparation function";
+static const char strEr_BadArg_UtiTrjPrepDel[] = "Incorrect arguments for prepared trajectory release function";
+static const char strEr_BadArg_UtiMagFldInterpPrep[] = "Incorrect arguments for magnetic field interpolation preparation function";
+static const char strEr_BadArg_UtiMagFldInterpPrepDel[] = "Incorrect arguments for prepared magnetic field interpolation release function";
+static const char strEr_BadArg_UtiIntInfMult[] = "Incorrect arguments for function analyzing multiple intensity distributions";
+static const char strEr_BadArg_UtiIntProcMult[] = "Incorrect arguments for function performing azimuthal integration of multiple intensity distributions";
+static const char strEr_BadArg_UtiIntProcPrep[] = "Incorrect arguments for intensity processing preparation function";
+static const char strEr_BadArg_UtiIntProcPrepDel[] = "Incorrect arguments for prepared intensity processing release function";
+static const char strEr_BadArg_UtiProfProc[] = "Incorrect arguments for function controlling built-in profiling";
 static const char strEr_BadArg_UtiVer[] = "Incorrect arguments for function returning SRW version number";
 
 /************************************************************************//**
@@ -4567,6 +4578,7 @@ static PyObject* srwlpy_CalcPartTrajFromKickMatr(PyObject *self, PyObject *args)
 
 	//SRWLPrtTrj trj = {0,0,0,0,0,0}; //zero pointers, since SRWL structures are definied in C (no constructors)
 	SRWLPrtTrj trj = {0,0,0,0,0,0,0,0,0}; //zero pointers, since SRWL structures are definied in C (no constructors)
+	vector<SRWLPrtTrj> vTrj; //for list of trajectories
 	SRWLKickM *arKickM = 0;
 
 	try
@@ -4574,7 +4586,19 @@ static PyObject* srwlpy_CalcPartTrajFromKickMatr(PyObject *self, PyObject *args)
 		if(!PyArg_ParseTuple(args, "OOO:CalcPartTrajFromKickMatr", &oPartTraj, &oListKickMatr, &oPrecPar)) throw strEr_BadArg_CalcPartTrajFromKickMatr;
 		if((oPartTraj == 0) || (oListKickMatr == 0) || (oPrecPar == 0)) throw strEr_BadArg_CalcPartTrajFromKickMatr;
 		
-		ParseSructSRWLPrtTrj(&trj, oPartTraj, &vBuf);
+		if(PyList_Check(oPartTraj))
+		{//many particles are tracked through the same kick-matrices
+			int nTrj = (int)PyList_Size(oPartTraj);
+			if(nTrj <= 0) throw strEr_BadArg_CalcPartTrajFromKickMatr;
+			vTrj.resize(nTrj, trj);
+			for(int i=0; i<nTrj; i++)
+			{
+				PyObject *oTrj = PyList_GetItem(oPartTraj, (Py_ssize_t)i);
+				if(oTrj == 0) throw strEr_BadArg_CalcPartTrajFromKickMatr;
+				ParseSructSRWLPrtTrj(&(vTrj[i]), oTrj, &vBuf);
+			}
+		}
+		else ParseSructSRWLPrtTrj(&trj, oPartTraj, &vBuf);
 
 		int nKickM = 0;
 		if(PyList_Check(oListKickMatr))
@@ -4604,7 +4628,8 @@ static PyObject* srwlpy_CalcPartTrajFromKickMatr(PyObject *self, PyObject *args)
 		double *pPrecPar = arPrecPar;
 		CopyPyListElemsToNumArray(oPrecPar, 'd', pPrecPar, nPrecPar);
 
-		ProcRes(srwlCalcPartTrajFromKickMatr(&trj, arKickM, nKickM, arPrecPar));
+		if(!vTrj.empty()) ProcRes(srwlCalcPartTrajFromKickMatrMult(&(vTrj[0]), (int)vTrj.size(), arKickM, nKickM, arPrecPar));
+		else ProcRes(srwlCalcPartTrajFromKickMatr(&trj, arKickM, nKickM, arPrecPar));
 	}
 	catch(const char* erText) 
 	{
@@ -4662,9 +4687,9 @@ static PyObject* srwlpy_CalcElecFieldSR(PyObject *self, PyObject *args)
 
 		//double *arPrecPar = (double*)GetPyArrayBuf(vBuf, oPrecPar, PyBUF_SIMPLE);
 		//if(arPrecPar == 0) throw strEr_BadPrec_CalcElecFieldSR;
-		double arPrecPar[7];
+		double arPrecPar[11];
 		double *pPrecPar = arPrecPar;
-		int nPrecPar = 7;
+		int nPrecPar = 11;
 		CopyPyListElemsToNumArray(oPrecPar, 'd', pPrecPar, nPrecPar);
 
 		ProcRes(srwlCalcElecFieldSR(&wfr, pTrj, pMagCnt, arPrecPar, nPrecPar));
@@ -4726,6 +4751,67 @@ static PyObject* srwlpy_CalcElecFieldGaussian(PyObject *self, PyObject *args)
 	return oWfr;
 }
 
+/************************************************************************//**
+ * Calculates Wavefronts (electric fields) of a set of Gauss-Hermite modes of a Gaussian Beam;
+ * see help to srwlCalcElecFieldGaussianModes
+ ***************************************************************************/
+static PyObject* srwlpy_CalcElecFieldGaussianModes(PyObject *self, PyObject *args)
+{
+	PyObject *oListWfr=0, *oGsnBm=0, *oModeInds=0;
+	vector<Py_buffer> vBuf;
+	SRWLWfr *arWfr=0;
+	SRWLWfr **arpWfr=0;
+	int *arModeInds=0;
+	int nWfr=0;
+	SRWLGsnBm gsnBm;
+
+	try
+	{
+		if(!PyArg_ParseTuple(args, "OOO:CalcElecFieldGaussianModes", &oListWfr, &oGsnBm, &oModeInds)) throw strEr_BadArg_CalcElecFieldGaussianModes;
+		if((oListWfr == 0) || (oGsnBm == 0) || (oModeInds == 0)) throw strEr_BadArg_CalcElecFieldGaussianModes;
+		if(!PyList_Check(oListWfr)) throw strEr_BadArg_CalcElecFieldGaussianModes;
+
+		nWfr = (int)PyList_Size(oListWfr);
+		if(nWfr <= 0) throw strEr_BadArg_CalcElecFieldGaussianModes;
+
+		int nModeInds=0;
+		CPyParse::CopyPyNestedListElemsToNumAr(oModeInds, 'i', arModeInds, nModeInds);
+		if(nModeInds < 2*nWfr) throw strEr_BadArg_CalcElecFieldGaussianModes;
+
+		ParseSructSRWLGsnBm(&gsnBm, oGsnBm);
+
+		arWfr = new SRWLWfr[nWfr];
+		arpWfr = new SRWLWfr*[nWfr];
+		for(int i=0; i<nWfr; i++)
+		{
+			PyObject *oWfr = PyList_GetItem(oListWfr, (Py_ssize_t)i);
+			ParseSructSRWLWfr((arWfr + i), oWfr, &vBuf, gmWfrPyPtr);
+			arpWfr[i] = arWfr + i;
+		}
+
+		ProcRes(srwlCalcElecFieldGaussianModes(arpWfr, nWfr, &gsnBm, arModeInds));
+
+		for(int i=0; i<nWfr; i++) UpdatePyWfr(PyList_GetItem(oListWfr, (Py_ssize_t)i), arWfr + i);
+	}
+	catch(const char* erText) 
+	{
+		PyErr_SetString(PyExc_RuntimeError, erText);
+		oListWfr = 0;
+	}
+
+	ReleasePyBuffers(vBuf);
+	if(arWfr)
+	{
+		for(int i=0; i<nWfr; i++) EraseElementFromMap((arWfr + i), gmWfrPyPtr);
+		delete[] arWfr;
+	}
+	if(arpWfr) delete[] arpWfr;
+	if(arModeInds) delete[] arModeInds;
+
+	if(oListWfr) Py_XINCREF(oListWfr);
+	return oListWfr;
+}
+
 /************************************************************************//**
  * Calculates Wavefront (electric field) of a Gaussian Beam;
  * see help to srwlCalcElecFieldSR
@@ -4851,12 +4937,14 @@ static PyObject* srwlpy_CalcPowDenSR(PyObject *self, PyObject *args)
 
 		if((pTrj == 0) && (pMagCnt == 0)) throw strEr_BadArg_CalcPowDenSR;
 
-		double arPrecPar[5];
+		double arPrecPar[8];
 		double *pPrecPar = arPrecPar;
-		int nPrecPar = 5;
+		int nPrecPar = 8;
 		CopyPyListElemsToNumArray(oPrecPar, 'd', pPrecPar, nPrecPar);
 
-		ProcRes(srwlCalcPowDenSR(&stokes, &eBeam, pTrj, pMagCnt, arPrecPar));
+		double relTol = (nPrecPar > 5)? arPrecPar[5] : 0.; //adaptive observation mesh refinement
+		ProcRes(srwlCalcPowDenSRAdapt(&stokes, &eBeam, pTrj, pMagCnt, arPrecPar, relTol, arPrecPar + 6));
+		if((nPrecPar > 7) && PyList_Check(oPrecPar)) UpdatePyListNum(oPrecPar, arPrecPar, nPrecPar); //refinement statistics
 		UpdatePyStokes(oStokes, &stokes);
 	}
 	catch(const char* erText) 
@@ -5629,6 +5717,60 @@ static PyObject* srwlpy_UtiIntInf(PyObject *self, PyObject *args)
 	return oRes;
 }
 
+/************************************************************************//**
+ * Calculates statistical characteristics of multiple intensity distributions (frames / photon energy slices)
+ ***************************************************************************/
+static PyObject* srwlpy_UtiIntInfMult(PyObject *self, PyObject *args)
+{
+	PyObject *oData=0, *oMesh=0, *oPar=0, *oRes=0;
+	vector<Py_buffer> vBuf;
+	double *arPar=0, *arInf=0;
+	int nFrames=1;
+	try
+	{
+		if(!PyArg_ParseTuple(args, "OO|iO:UtiIntInfMult", &oData, &oMesh, &nFrames, &oPar)) throw strEr_BadArg_UtiIntInfMult;
+		if((oData == 0) || (oMesh == 0) || (nFrames <= 0)) throw strEr_BadArg_UtiIntInfMult;
+
+		char *pcData=0;
+		Py_ssize_t sizeBuf;
+		if(!(pcData = GetPyArrayBuf(oData, &vBuf, &sizeBuf))) throw strEr_BadArg_UtiIntInfMult;
+
+		SRWLRadMesh mesh;
+		ParseSructSRWLRadMesh(&mesh, oMesh);
+
+		Py_ssize_t dataItemSize = (Py_ssize_t)round((sizeBuf/(((double)mesh.ne)*mesh.nx*mesh.ny*nFrames)));
+		char typeData = 0;
+		if(dataItemSize == (Py_ssize_t)sizeof(float)) typeData = 'f';
+		else if(dataItemSize == (Py_ssize_t)sizeof(double)) typeData = 'd';
+		else throw strEr_BadArg_UtiIntInfMult;
+
+		int nPar = 0;
+		if((oPar != 0) && (oPar != Py_None))
+		{
+			CopyPyListElemsToNumArray(oPar, 'd', arPar, nPar);
+		}
+
+		const int nInfPerDistr = 16;
+		int nDistr = ((mesh.ne > 1)? mesh.ne : 1)*nFrames;
+		arInf = new double[nInfPerDistr*nDistr];
+		ProcRes(srwlUtiIntInfMult(arInf, pcData, typeData, &mesh, nFrames, arPar, nPar));
+
+		oRes = SetPyListOfLists(arInf, nInfPerDistr*nDistr, nDistr, (char*)"d");
+	}
+	catch(const char* erText) 
+	{
+		PyErr_SetString(PyExc_RuntimeError, erText);
+		oRes = 0;
+	}
+
+	ReleasePyBuffers(vBuf);
+	if(arPar != 0) delete[] arPar;
+	if(arInf != 0) delete[] arInf;
+
+	if(oRes) Py_XINCREF(oRes);
+	return oRes;
+}
+
 /************************************************************************//**
  * Performs misc. operations on input 
  ***************************************************************************/
@@ -5850,6 +5992,323 @@ static PyObject* srwlpy_UtiUndFindMagFldInterpInds(PyObject *self, PyObject *arg
 	return oResNumInds;
 }
 
+/************************************************************************//**
+ * Generates 6D phase-space coordinates of particles of a Gaussian beam
+ * see help to srwlUtiSampPartBeam
+ ***************************************************************************/
+static PyObject* srwlpy_UtiSampPartBeam(PyObject *self, PyObject *args)
+{
+	PyObject *oPart=0, *oPartBeam=0, *oPar=0;
+	vector<Py_buffer> vBuf;
+	double *arPar=0;
+
+	try
+	{
+		if(!PyArg_ParseTuple(args, "OO|O:UtiSampPartBeam", &oPart, &oPartBeam, &oPar)) throw strEr_BadArg_UtiSampPartBeam;
+		if((oPart == 0) || (oPartBeam == 0)) throw strEr_BadArg_UtiSampPartBeam;
+
+		Py_ssize_t sizeBuf=0;
+		double *arPart = (double*)GetPyArrayBuf(oPart, &vBuf, &sizeBuf);
+		if(arPart == 0) throw strEr_BadArg_UtiSampPartBeam;
+		long long nPart = (long long)(sizeBuf/(6*sizeof(double)));
+
+		SRWLPartBeam partBeam;
+		ParseSructSRWLPartBeam(&partBeam, oPartBeam, vBuf);
+
+		//arPar: [0]- index of first particle, [1]- type of generator, [2]- seed
+		long long iStart = 0, seed = 0;
+		char typeGen = 1;
+		int nPar = 0;
+		if((oPar != 0) && (oPar != Py_None)) CopyPyListElemsToNumArray(oPar, 'd', arPar, nPar);
+		if(nPar > 0) iStart = (long long)arPar[0];
+		if(nPar > 1) typeGen = (char)arPar[1];
+		if(nPar > 2) seed = (long long)arPar[2];
+
+		ProcRes(srwlUtiSampPartBeam(arPart, nPart, &partBeam, iStart, typeGen, seed));
+	}
+	catch(const char* erText) 
+	{
+		PyErr_SetString(PyExc_RuntimeError, erText);
+		oPart = 0;
+	}
+
+	if(arPar != 0) delete[] arPar;
+	ReleasePyBuffers(vBuf);
+
+	if(oPart) Py_XINCREF(oPart);
+	return oPart;
+}
+
+/************************************************************************//**
+ * Prepares interpolating structure of particle trajectory for SR calculations
+ ***************************************************************************/
+static PyObject* srwlpy_UtiTrjPrep(PyObject *self, PyObject *args)
+{//Returns integer handle of prepared trajectory (to be released by UtiTrjPrepDel)
+	PyObject *oPartTraj=0, *oResHndl=0;
+	vector<Py_buffer> vBuf;
+	SRWLPrtTrj trj = {0,0,0,0,0,0,0,0,0}; //zero pointers
+	try
+	{
+		if(!PyArg_ParseTuple(args, "O:UtiTrjPrep", &oPartTraj)) throw strEr_BadArg_UtiTrjPrep;
+		if(oPartTraj == 0) throw strEr_BadArg_UtiTrjPrep;
+
+		ParseSructSRWLPrtTrj(&trj, oPartTraj, &vBuf);
+
+		SRWLPrtTrjPrep *hTrjPrep = 0;
+		ProcRes(srwlUtiTrjPrep(&hTrjPrep, &trj));
+		oResHndl = PyLong_FromVoidPtr(hTrjPrep);
+	}
+	catch(const char* erText) 
+	{
+		PyErr_SetString(PyExc_RuntimeError, erText);
+		oResHndl = 0;
+	}
+	ReleasePyBuffers(vBuf);
+	return oResHndl;
+}
+
+/************************************************************************//**
+ * Releases prepared trajectory (or, if called with 0, all interpolating structures of trajectories kept in memory)
+ ***************************************************************************/
+static PyObject* srwlpy_UtiTrjPrepDel(PyObject *self, PyObject *args)
+{
+	PyObject *oHndl=0;
+	try
+	{
+		if(!PyArg_ParseTuple(args, "O:UtiTrjPrepDel", &oHndl)) throw strEr_BadArg_UtiTrjPrepDel;
+		if((oHndl == 0) || (!PyNumber_Check(oHndl))) throw strEr_BadArg_UtiTrjPrepDel;
+
+		SRWLPrtTrjPrep *hTrjPrep = (SRWLPrtTrjPrep*)PyLong_AsVoidPtr(oHndl);
+		if(PyErr_Occurred()) throw strEr_BadArg_UtiTrjPrepDel;
+		ProcRes(srwlUtiTrjPrepDel(hTrjPrep));
+	}
+	catch(const char* erText) 
+	{
+		PyErr_SetString(PyExc_RuntimeError, erText);
+		return 0;
+	}
+	Py_RETURN_NONE;
+}
+
+/************************************************************************//**
+ * Prepares interpolation of magnetic field vs gap / phase for given mesh of resulting field and given container of tabulated fields
+ ***************************************************************************/
+static PyObject* srwlpy_UtiMagFldInterpPrep(PyObject *self, PyObject *args)
+{//Returns integer handle of prepared interpolation (to be released by UtiMagFldInterpPrepDel)
+	PyObject *oDispMagCnt=0, *oMagFldCnt=0, *oResHndl=0;
+	vector<Py_buffer> vBuf;
+	SRWLMagFldC magCnt = {0,0,0,0,0,0,0,0,0,0}; //since SRWL structures are definied in C (no constructors)
+	SRWLMagFldC dispMagCnt = {0,0,0,0,0,0,0,0,0,0};
+	try
+	{
+		if(!PyArg_ParseTuple(args, "OO:UtiMagFldInterpPrep", &oDispMagCnt, &oMagFldCnt)) throw strEr_BadArg_UtiMagFldInterpPrep;
+		if((oDispMagCnt == 0) || (oMagFldCnt == 0)) throw strEr_BadArg_UtiMagFldInterpPrep;
+
+		ParseSructSRWLMagFldC(&dispMagCnt, oDispMagCnt, &vBuf);
+		if((dispMagCnt.nElem != 1) || (dispMagCnt.arMagFldTypes[0] != 'a')) throw strEr_BadArg_UtiMagFldInterpPrep;
+		ParseSructSRWLMagFldC(&magCnt, oMagFldCnt, &vBuf);
+
+		SRWLMagFldInterpPrep *hPrep = 0;
+		ProcRes(srwlUtiMagFldInterpPrep(&hPrep, &dispMagCnt, &magCnt));
+		oResHndl = PyLong_FromVoidPtr(hPrep);
+	}
+	catch(const char* erText) 
+	{
+		PyErr_SetString(PyExc_RuntimeError, erText);
+		oResHndl = 0;
+	}
+	DeallocMagCntArrays(&dispMagCnt);
+	DeallocMagCntArrays(&magCnt);
+	ReleasePyBuffers(vBuf);
+	return oResHndl;
+}
+
+/************************************************************************//**
+ * Releases prepared magnetic field interpolation (or, if called with 0, all prepared interpolations)
+ ***************************************************************************/
+static PyObject* srwlpy_UtiMagFldInterpPrepDel(PyObject *self, PyObject *args)
+{
+	PyObject *oHndl=0;
+	try
+	{
+		if(!PyArg_ParseTuple(args, "O:UtiMagFldInterpPrepDel", &oHndl)) throw strEr_BadArg_UtiMagFldInterpPrepDel;
+		if((oHndl == 0) || (!PyNumber_Check(oHndl))) throw strEr_BadArg_UtiMagFldInterpPrepDel;
+
+		SRWLMagFldInterpPrep *hPrep = (SRWLMagFldInterpPrep*)PyLong_AsVoidPtr(oHndl);
+		if(PyErr_Occurred()) throw strEr_BadArg_UtiMagFldInterpPrepDel;
+		ProcRes(srwlUtiMagFldInterpPrepDel(hPrep));
+	}
+	catch(const char* erText) 
+	{
+		PyErr_SetString(PyExc_RuntimeError, erText);
+		return 0;
+	}
+	Py_RETURN_NONE;
+}
+
+/************************************************************************//**
+ * Performs azimuthal integration or averaging of multiple 2D intensity distributions (frames) stored one after another
+ ***************************************************************************/
+static PyObject* srwlpy_UtiIntProcMult(PyObject *self, PyObject *args)
+{
+	PyObject *oInt1=0, *oMesh1=0, *oInt2=0, *oMesh2=0, *oPar=0;
+	int nFrames=0;
+	vector<Py_buffer> vBuf;
+	double *arPar=0;
+	try
+	{
+		if(!PyArg_ParseTuple(args, "OOOOiO:UtiIntProcMult", &oInt1, &oMesh1, &oInt2, &oMesh2, &nFrames, &oPar)) throw strEr_BadArg_UtiIntProcMult;
+		if((oInt1 == 0) || (oMesh1 == 0) || (oInt2 == 0) || (oMesh2 == 0) || (oPar == 0) || (nFrames <= 0)) throw strEr_BadArg_UtiIntProcMult;
+
+		SRWLRadMesh mesh1, mesh2;
+		ParseSructSRWLRadMesh(&mesh1, oMesh1);
+		ParseSructSRWLRadMesh(&mesh2, oMesh2);
+
+		int nPar=0;
+		CPyParse::CopyPyNestedListElemsToNumAr(oPar, 'd', arPar, nPar);
+		if(nPar < 1) throw strEr_BadArg_UtiIntProcMult;
+
+		Py_ssize_t sizeBuf;
+		char *pcInt1=0, *pcInt2=0;
+		char typeInt1=0, typeInt2=0;
+		if(!(pcInt1 = GetPyArrayBuf(oInt1, &vBuf, &sizeBuf))) throw strEr_BadArg_UtiIntProcMult;
+		long long nTot1 = ((long long)mesh1.ne)*((long long)mesh1.nx)*((long long)mesh1.ny)*nFrames;
+		Py_ssize_t intItemSize = (Py_ssize_t)round((sizeBuf/nTot1));
+		if(intItemSize == (Py_ssize_t)sizeof(float)) typeInt1 = 'f';
+		else if(intItemSize == (Py_ssize_t)sizeof(double)) typeInt1 = 'd';
+		else throw strEr_BadArg_UtiIntProcMult;
+
+		if(!(pcInt2 = GetPyArrayBuf(oInt2, &vBuf, &sizeBuf))) throw strEr_BadArg_UtiIntProcMult;
+		long long nTot2 = ((long long)mesh2.ne)*((long long)mesh2.nx)*((long long)mesh2.ny)*nFrames;
+		intItemSize = (Py_ssize_t)round((sizeBuf/nTot2));
+		if(intItemSize == (Py_ssize_t)sizeof(float)) typeInt2 = 'f';
+		else if(intItemSize == (Py_ssize_t)sizeof(double)) typeInt2 = 'd';
+		else throw strEr_BadArg_UtiIntProcMult;
+
+		ProcRes(srwlUtiIntProcMult(pcInt1, typeInt1, &mesh1, pcInt2, typeInt2, &mesh2, nFrames, arPar, nPar));
+	}
+	catch(const char* erText) 
+	{
+		PyErr_SetString(PyExc_RuntimeError, erText);
+		oInt1 = 0;
+	}
+
+	if(arPar) delete[] arPar;
+	ReleasePyBuffers(vBuf);
+
+	if(oInt1) Py_XINCREF(oInt1);
+	return oInt1;
+}
+
+/************************************************************************//**
+ * Prepares resampling plan of azimuthal integration / averaging of intensity distributions
+ ***************************************************************************/
+static PyObject* srwlpy_UtiIntProcPrep(PyObject *self, PyObject *args)
+{//Returns integer handle of prepared processing (to be released by UtiIntProcPrepDel)
+	PyObject *oMesh1=0, *oMesh2=0, *oPar=0, *oResHndl=0;
+	double *arPar=0;
+	try
+	{
+		if(!PyArg_ParseTuple(args, "OOO:UtiIntProcPrep", &oMesh1, &oMesh2, &oPar)) throw strEr_BadArg_UtiIntProcPrep;
+		if((oMesh1 == 0) || (oMesh2 == 0) || (oPar == 0)) throw strEr_BadArg_UtiIntProcPrep;
+
+		SRWLRadMesh mesh1, mesh2;
+		ParseSructSRWLRadMesh(&mesh1, oMesh1);
+		ParseSructSRWLRadMesh(&mesh2, oMesh2);
+
+		int nPar=0;
+		CPyParse::CopyPyNestedListElemsToNumAr(oPar, 'd', arPar, nPar);
+		if(nPar < 1) throw strEr_BadArg_UtiIntProcPrep;
+
+		SRWLIntProcPlan *hPlan = 0;
+		ProcRes(srwlUtiIntProcPrep(&hPlan, &mesh1, &mesh2, arPar, nPar));
+		oResHndl = PyLong_FromVoidPtr(hPlan);
+	}
+	catch(const char* erText) 
+	{
+		PyErr_SetString(PyExc_RuntimeError, erText);
+		oResHndl = 0;
+	}
+	if(arPar) delete[] arPar;
+	return oResHndl;
+}
+
+/************************************************************************//**
+ * Releases prepared intensity processing
+ ***************************************************************************/
+static PyObject* srwlpy_UtiIntProcPrepDel(PyObject *self, PyObject *args)
+{
+	PyObject *oHndl=0;
+	try
+	{
+		if(!PyArg_ParseTuple(args, "O:UtiIntProcPrepDel", &oHndl)) throw strEr_BadArg_UtiIntProcPrepDel;
+		if((oHndl == 0) || (!PyNumber_Check(oHndl))) throw strEr_BadArg_UtiIntProcPrepDel;
+
+		SRWLIntProcPlan *hPlan = (SRWLIntProcPlan*)PyLong_AsVoidPtr(oHndl);
+		if(PyErr_Occurred()) throw strEr_BadArg_UtiIntProcPrepDel;
+		ProcRes(srwlUtiIntProcPrepDel(hPlan));
+	}
+	catch(const char* erText) 
+	{
+		PyErr_SetString(PyExc_RuntimeError, erText);
+		return 0;
+	}
+	Py_RETURN_NONE;
+}
+
+/************************************************************************//**
+ * Controls built-in profiling of main computation stages
+ ***************************************************************************/
+static PyObject* srwlpy_UtiProfProc(PyObject *self, PyObject *args)
+{
+	try
+	{
+		int op = 0;
+		if(!PyArg_ParseTuple(args, "i:UtiProfProc", &op)) throw strEr_BadArg_UtiProfProc;
+		ProcRes(srwlUtiProfProc(op));
+	}
+	catch(const char* erText) 
+	{
+		PyErr_SetString(PyExc_RuntimeError, erText);
+		return 0;
+	}
+	Py_RETURN_NONE;
+}
+
+/************************************************************************//**
+ * Returns data accumulated by built-in profiling: list of [path of stage names, index of parent, number of calls, total time [s], time of child stages [s], bytes]
+ ***************************************************************************/
+static PyObject* srwlpy_UtiProfGet(PyObject *self, PyObject *args)
+{
+	PyObject *oRes=0;
+	try
+	{
+		int nNodes = 0;
+		ProcRes(srwlUtiProfGet(0, &nNodes));
+		vector<double> vRes(6*nNodes + 1);
+		ProcRes(srwlUtiProfGet(&(vRes[0]), &nNodes));
+
+		vector<string> vPath(nNodes);
+		char sName[33];
+		oRes = PyList_New(nNodes);
+		for(int i=0; i<nNodes; i++)
+		{
+			double *t = &(vRes[6*i]);
+			int iParent = (int)t[0];
+			ProcRes(srwlUtiProfGetStageName(sName, (int)t[1]));
+			vPath[i] = ((iParent >= 0) && (iParent < i))? (vPath[iParent] + "/" + sName) : string(sName);
+			PyList_SetItem(oRes, i, Py_BuildValue("[siLddL]", vPath[i].c_str(), iParent, (long long)t[2], t[3], t[4], (long long)t[5]));
+		}
+	}
+	catch(const char* erText) 
+	{
+		PyErr_SetString(PyExc_RuntimeError, erText);
+		if(oRes != 0) Py_DECREF(oRes);
+		return 0;
+	}
+	return oRes;
+}
+
 /************************************************************************//**
  * Returns version number / ID of SRW for Python
  ***************************************************************************/
@@ -5904,6 +6363,7 @@ static PyMethodDef srwlpy_methods[] = {
 	{"CalcPartTrajFromKickMatr", srwlpy_CalcPartTrajFromKickMatr, METH_VARARGS, "CalcPartTrajFromKickMatr() Calculates charged particle trajectory from an array of kick matrices"},
 	{"CalcElecFieldSR", srwlpy_CalcElecFieldSR, METH_VARARGS, "CalcElecFieldSR() Calculates Electric Field (Wavefront) of Synchrotron Radiation by a relativistic charged particle traveling in external 3D magnetic field"},
 	{"CalcElecFieldGaussian", srwlpy_CalcElecFieldGaussian, METH_VARARGS, "CalcElecFieldGaussian() Calculates Electric Field (Wavefront) of a coherent Gaussian Beam"},
+	{"CalcElecFieldGaussianModes", srwlpy_CalcElecFieldGaussianModes, METH_VARARGS, "CalcElecFieldGaussianModes() Calculates Electric Fields (Wavefronts) of a set of Gauss-Hermite modes of a coherent Gaussian Beam"},
 	{"CalcElecFieldPointSrc", srwlpy_CalcElecFieldPointSrc, METH_VARARGS, "CalcElecFieldPointSrc() Calculates Electric Field (Wavefront) of a spherical wave"},
 	{"CalcStokesUR", srwlpy_CalcStokesUR, METH_VARARGS, "CalcStokesUR() Calculates Stokes parameters of Synchrotron Radiation by a relativistic finite-emittance electron beam traveling in periodic magnetic field of an undulator"},
 	{"CalcPowDenSR", srwlpy_CalcPowDenSR, METH_VARARGS, "CalcPowDenSR() Calculates Power Density distribution of Synchrotron Radiation by a relativistic finite-emittance electron beam traveling in arbitrary magnetic field"},
@@ -5917,9 +6377,20 @@ static PyMethodDef srwlpy_methods[] = {
 	{"UtiFFT", srwlpy_UtiFFT, METH_VARARGS, "UtiFFT() Performs 1D or 2D FFT (as defined by arguments)"},
 	{"UtiConvWithGaussian", srwlpy_UtiConvWithGaussian, METH_VARARGS, "UtiConvWithGaussian() Performs convolution of 1D or 2D data wave with 1D or 2D Gaussian (as defined by arguments)"},
 	{"UtiIntInf", srwlpy_UtiIntInf, METH_VARARGS, "UtiIntInf() Calculates basic statistical characteristics of intensity distribution"},
+	{"UtiIntInfMult", srwlpy_UtiIntInfMult, METH_VARARGS, "UtiIntInfMult() Calculates statistical characteristics of multiple intensity distributions (frames / photon energy slices) in one pass over the data of each"},
 	{"UtiIntProc", srwlpy_UtiIntProc, METH_VARARGS, "UtiIntProc() Performs misc. operations on one or two intensity distributions"},
 	{"UtiUndFromMagFldTab", srwlpy_UtiUndFromMagFldTab, METH_VARARGS, "UtiUndFromMagFldTab() Attempts to create periodic undulator structure from tabulated magnetic field"},
 	{"UtiUndFindMagFldInterpInds", srwlpy_UtiUndFindMagFldInterpInds, METH_VARARGS, "UtiUndFindMagFldInterpInds() Finds indexes of undulator gap and phase values and associated magnetic fields requiired to be used in field interpolation based on gap and phase"},
+	{"UtiSampPartBeam", srwlpy_UtiSampPartBeam, METH_VARARGS, "UtiSampPartBeam() Generates 6D phase-space coordinates of particles of a Gaussian beam, reproducibly for any block of particle indexes"},
+	{"UtiTrjPrep", srwlpy_UtiTrjPrep, METH_VARARGS, "UtiTrjPrep() Prepares interpolating structure of particle trajectory and keeps it in memory for reuse by subsequent SR calculations; returns handle to be released by UtiTrjPrepDel"},
+	{"UtiTrjPrepDel", srwlpy_UtiTrjPrepDel, METH_VARARGS, "UtiTrjPrepDel() Releases prepared particle trajectory"},
+	{"UtiMagFldInterpPrep", srwlpy_UtiMagFldInterpPrep, METH_VARARGS, "UtiMagFldInterpPrep() Prepares interpolation of magnetic field vs gap / phase (CalcMagnField) for given mesh and container of tabulated fields; returns handle to be released by UtiMagFldInterpPrepDel"},
+	{"UtiMagFldInterpPrepDel", srwlpy_UtiMagFldInterpPrepDel, METH_VARARGS, "UtiMagFldInterpPrepDel() Releases prepared magnetic field interpolation"},
+	{"UtiIntProcMult", srwlpy_UtiIntProcMult, METH_VARARGS, "UtiIntProcMult() Performs azimuthal integration or averaging (as UtiIntProc with type 3) of a number of 2D intensity distributions stored one after another"},
+	{"UtiIntProcPrep", srwlpy_UtiIntProcPrep, METH_VARARGS, "UtiIntProcPrep() Prepares resampling plan of azimuthal integration / averaging (UtiIntProc with type 3 and fixed numbers of points) for given meshes and parameters; returns handle to be released by UtiIntProcPrepDel"},
+	{"UtiIntProcPrepDel", srwlpy_UtiIntProcPrepDel, METH_VARARGS, "UtiIntProcPrepDel() Releases prepared intensity processing"},
+	{"UtiProfProc", srwlpy_UtiProfProc, METH_VARARGS, "UtiProfProc() Controls built-in profiling of main computation stages: 0- disable, 1- enable, 2- reset accumulated data"},
+	{"UtiProfGet", srwlpy_UtiProfGet, METH_VARARGS, "UtiProfGet() Returns data accumulated by built-in profiling: list of [stage path, parent index, number of calls, total time [s], time of child stages [s], bytes processed]"},
 	{"UtiVer", srwlpy_UtiVer, METH_VARARGS, "UtiVerNo() Returns version number / ID of SRW for Python"},
 	{NULL, NULL}
 };
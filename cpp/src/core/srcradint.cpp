@@ -16,6 +16,11 @@
 #include "srmlttsk.h"
 #include "srprgind.h"
 #include "gmmeth.h"
+#include "srerror.h"
+
+#ifdef _WITH_OMP //Pre-processor definition for compiling with OpenMP library
+#include "omp.h"
+#endif
 
 //*************************************************************************
 
@@ -463,10 +468,6 @@ void srTCSR::performMethodDependentSetupActions()
 
 	if(m_PrecParams.m_MC_NumMacroPart > 0) 
 	{// Monte-Carlo, for tests
-		m_pRadInt = new srTRadInt();
-		m_pWfrSmpAux = new srTWfrSmp(m_Wfr.yStart, m_Wfr.xStart, m_Wfr.xStart + m_Wfr.xStep*(m_Wfr.nx - 1), 1, m_Wfr.zStart, m_Wfr.zStart + m_Wfr.zStep*(m_Wfr.nz - 1), 1, 0, m_Wfr.eStart, m_Wfr.eStart + m_Wfr.eStep*(m_Wfr.ne - 1), 1, "EV");
-		m_pWfrAux = new srTSRWRadStructAccessData(&(m_TrjDat.EbmDat), &m_TrjDat, m_pWfrSmpAux, 0);
-		
 		double prec_or_step = (m_PrecParams.m_MethNo > 0)? m_PrecParams.m_PrecPar : m_PrecParams.m_sStep;
 		m_pParPrecElecFldSingle = new srTParPrecElecFld(m_PrecParams.m_MethNo, prec_or_step, m_PrecParams.m_sIntegStart, m_PrecParams.m_sIntegEnd, m_PrecParams.m_NxNzOversampFact);
 
@@ -514,9 +515,6 @@ void srTCSR::performMethodDependentFinishActions()
 
 	if(m_PrecParams.m_MC_NumMacroPart > 0) 
 	{// Monte-Carlo, for tests
-		if(m_pRadInt != 0) { delete m_pRadInt; m_pRadInt = 0;}
-		if(m_pWfrSmpAux != 0) { delete m_pWfrSmpAux; m_pWfrSmpAux = 0;}
-		if(m_pWfrAux != 0) { delete m_pWfrAux; m_pWfrAux = 0;}
 		if(m_pParPrecElecFldSingle != 0) { delete m_pParPrecElecFldSingle; m_pParPrecElecFldSingle = 0;}
 		if(m_pTrjDatAux != 0) { delete m_pTrjDatAux; m_pTrjDatAux = 0;}
 	}
@@ -542,6 +540,8 @@ void srTCSR::computeElectricFieldFreqDomain()
 	checkInputConsistency();
 	performMethodDependentSetupActions();
 
+	if(m_PrecParams.m_MC_NumMacroPart > 0) { computeElectricFieldFreqDomainMonteCarlo(); return;}
+
 	char FinalResAreSymOverX = 0, FinalResAreSymOverZ = 0;
 	analyzeFinalResultsSymmetry(FinalResAreSymOverX, FinalResAreSymOverZ);
 
@@ -620,6 +620,189 @@ void srTCSR::computeElectricFieldFreqDomain()
 
 //*************************************************************************
 
+void srTCSR::computeElectricFieldFreqDomainMonteCarlo()
+{//Each macro-particle is drawn once: its trajectory is computed once, its field is computed on the whole observation mesh
+ //and added coherently (with the exp(-i*k*sc) phase factor) to the partial sums of the thread processing it.
+ //Assumes that performMethodDependentSetupActions was already called.
+	long long nPart = m_PrecParams.m_MC_NumMacroPart;
+	long long nTot = (((long long)m_Wfr.nz)*((long long)m_Wfr.nx)*((long long)m_Wfr.ne)) << 1;
+	srTEbmDat& e_beam = m_pTrjDatAux->EbmDat;
+
+	//All macro-particles are drawn in advance (each one from its index in the LPTau sequence), so that they do not depend on the number of threads
+	double arCov[36];
+	for(int i=0; i<36; i++) arCov[i] = 0.;
+	for(int i=0; i<6; i++) arCov[i*7] = m_sigArr[i]*m_sigArr[i];
+	CGenMathRandGaussSampler partSampler;
+	partSampler.Setup(6, m_xcArr, arCov, 1); //use LPTau
+	double *arPart6D = new double[nPart*6];
+	partSampler.GetPoints(0, nPart, arPart6D);
+
+	double *arPhotEn = new double[m_Wfr.ne];
+	for(int ie=0; ie<m_Wfr.ne; ie++) arPhotEn[ie] = m_Wfr.eStart + ie*m_Wfr.eStep;
+
+	int nThreads = 1;
+#ifdef _WITH_OMP
+	nThreads = omp_get_max_threads();
+#endif
+
+	//Per-thread wavefronts for the whole mesh and partial sums of Ex, Ez (allocated by the threads)
+	srTWfrSmp WfrSmpMesh(m_Wfr.yStart, m_Wfr.xStart, m_Wfr.xStart + m_Wfr.xStep*(m_Wfr.nx - 1), m_Wfr.nx, m_Wfr.zStart, m_Wfr.zStart + m_Wfr.zStep*(m_Wfr.nz - 1), m_Wfr.nz, 0, m_Wfr.eStart, m_Wfr.eStart + m_Wfr.eStep*(m_Wfr.ne - 1), m_Wfr.ne, "EV");
+	srTSRWRadStructAccessData **arWfrThr = new srTSRWRadStructAccessData*[nThreads];
+	double **arSumThr = new double*[nThreads];
+	for(int it=0; it<nThreads; it++) { arWfrThr[it] = 0; arSumThr[it] = 0;}
+
+	srTCompProgressIndicator CompProgressInd(nPart, 0.5);
+
+	int result = 0;
+	try
+	{
+		CErrWarnBind WarnBind(&gVectWarnNos); //warnings of worker threads go to the list of calling thread
+#ifdef _WITH_OMP
+		#pragma omp parallel firstprivate(WarnBind)
+#endif
+		{
+			int iThr = 0;
+#ifdef _WITH_OMP
+			iThr = omp_get_thread_num();
+#endif
+			double *pSumEx = arSumThr[iThr] = new double[nTot << 1], *pSumEz = pSumEx + nTot;
+			for(long long j=0; j<(nTot << 1); j++) pSumEx[j] = 0.;
+			double *arCosSin = new double[m_Wfr.ne << 1];
+
+			//Own copy of the trajectory data (including the field data, which is modified when the interpolating structure is computed)
+			srTRadInt RadIntLoc;
+			srTTrjDat TrjDatLoc(*m_pTrjDatAux);
+			TrjDatLoc.m_doNotDeleteData = true;
+			if(m_pTrjDatAux->BxInData != 0)
+			{
+				TrjDatLoc.BxInData = new srTFunDer[TrjDatLoc.LenFieldData];
+				for(long long j=0; j<TrjDatLoc.LenFieldData; j++) TrjDatLoc.BxInData[j] = m_pTrjDatAux->BxInData[j];
+			}
+			if(m_pTrjDatAux->BzInData != 0)
+			{
+				TrjDatLoc.BzInData = new srTFunDer[TrjDatLoc.LenFieldData];
+				for(long long j=0; j<TrjDatLoc.LenFieldData; j++) TrjDatLoc.BzInData[j] = m_pTrjDatAux->BzInData[j];
+			}
+			srTEbmDat& e_beamLoc = TrjDatLoc.EbmDat;
+			srTCompProgressCounter ProgressCounter(CompProgressInd); //particles are counted per thread and passed to the shared indicator at a bounded rate
+
+			//The wavefront structure is set up using the trajectory of the "central" particle
+			srTSRWRadStructAccessData *pWfrLoc = 0;
+			try
+			{
+				int resLoc = 0;
+				if(resLoc = TrjDatLoc.ComputeInterpolatingStructure()) throw resLoc;
+				pWfrLoc = arWfrThr[iThr] = new srTSRWRadStructAccessData(&e_beamLoc, &TrjDatLoc, &WfrSmpMesh, 0);
+			}
+			catch(int ErrNo)
+			{
+#ifdef _WITH_OMP
+				#pragma omp atomic write
+#endif
+				result = ErrNo;
+			}
+
+#ifdef _WITH_OMP
+			#pragma omp for schedule(static)
+#endif
+			for(long long i=0; i<nPart; i++)
+			{
+				int resCur = 0;
+#ifdef _WITH_OMP
+				#pragma omp atomic read
+				resCur = result;
+#else
+				resCur = result;
+#endif
+				if((resCur != 0) || (pWfrLoc == 0)) continue; //error or abort: skip remaining particles
+
+				double *point6d = arPart6D + i*6;
+				e_beamLoc.x0 = point6d[0];
+				e_beamLoc.dxds0 = point6d[1];
+				e_beamLoc.z0 = point6d[2];
+				e_beamLoc.dzds0 = point6d[3];
+				e_beamLoc.SetNewEnergy(point6d[4]);
+				e_beamLoc.sc = point6d[5];
+
+				try
+				{
+					if(resCur = TrjDatLoc.ComputeInterpolatingStructure()) throw resCur;
+					RadIntLoc.ComputeElectricFieldFreqDomain(&TrjDatLoc, &WfrSmpMesh, m_pParPrecElecFldSingle, pWfrLoc, 0);
+				}
+				catch(int ErrNo) { resCur = ErrNo;}
+
+				if(resCur == 0)
+				{
+					for(int ie=0; ie<m_Wfr.ne; ie++)
+					{
+						double ksc = -arPhotEn[ie]*m_AuxIntPar.k_d_e*e_beamLoc.sc;
+						arCosSin[ie << 1] = cos(ksc); arCosSin[(ie << 1) + 1] = sin(ksc);
+					}
+
+					float *tEx = pWfrLoc->pBaseRadX, *tEz = pWfrLoc->pBaseRadZ;
+					double *tSumEx = pSumEx, *tSumEz = pSumEz;
+					for(long long j=0; j<nTot; j+=2)
+					{
+						long long ie2 = j%(m_Wfr.ne << 1);
+						double cos_ksc = arCosSin[ie2], sin_ksc = arCosSin[ie2 + 1];
+						double ReEx = *(tEx++), ImEx = *(tEx++), ReEz = *(tEz++), ImEz = *(tEz++);
+						*(tSumEx++) += ReEx*cos_ksc - ImEx*sin_ksc; *(tSumEx++) += ReEx*sin_ksc + ImEx*cos_ksc;
+						*(tSumEz++) += ReEz*cos_ksc - ImEz*sin_ksc; *(tSumEz++) += ReEz*sin_ksc + ImEz*cos_ksc;
+					}
+				}
+				RadIntLoc.DeallocateMemForRadDistr();
+
+				if(resCur == 0) resCur = ProgressCounter.Add();
+				if((resCur == 0) && (iThr == 0)) resCur = srYield.Check();
+				if(resCur != 0)
+				{
+#ifdef _WITH_OMP
+					#pragma omp atomic write
+					result = resCur;
+#else
+					result = resCur;
+#endif
+				}
+			}
+
+			TrjDatLoc.DeallocateMemoryForCfs();
+			TrjDatLoc.DeleteInitialFieldData();
+			delete[] arCosSin;
+		}
+		if(result != 0) throw result;
+
+		//Reduction of the partial sums in fixed order; mean field of macro-particles is multiplied by sqrt of number of electrons
+		double multNorm = sqrt(e_beam.Neb)/((double)nPart);
+		float *tEx = m_Wfr.pBaseRadX, *tEz = m_Wfr.pBaseRadZ;
+		for(long long j=0; j<nTot; j++)
+		{
+			double sumEx = 0., sumEz = 0.;
+			for(int it=0; it<nThreads; it++) { sumEx += arSumThr[it][j]; sumEz += arSumThr[it][nTot + j];}
+			*(tEx++) = (float)(sumEx*multNorm);
+			*(tEz++) = (float)(sumEz*multNorm);
+		}
+	}
+	catch(int ErrNo) { result = ErrNo;}
+
+	for(int it=0; it<nThreads; it++)
+	{
+		if(arWfrThr[it] != 0) delete arWfrThr[it];
+		if(arSumThr[it] != 0) delete[] arSumThr[it];
+	}
+	delete[] arWfrThr;
+	delete[] arSumThr;
+	delete[] arPhotEn;
+	delete[] arPart6D;
+
+	performMethodDependentFinishActions();
+	if(result != 0) throw result;
+
+	srTGenOptElem GenOptElem;
+	if(result = GenOptElem.ComputeRadMoments(&m_Wfr)) throw result;
+}
+
+//*************************************************************************
+
 void srTCSR::radIntegrationResiduals(srTEXZY& exzy,	srTEFourier& Ew, srTEFourier* arr_dEwds)
 {//assumes that m_FldArr.sStep, etc. parameters are already defined
 	srTEFourier	EwDummy;
@@ -1008,68 +1191,4 @@ void srTCSR::computeFuncToIntegAtOnePointOnTrj(long long i, srTEXZY exzy, srTEFo
 
 //*************************************************************************
 
-//void srTCSR::createAuxWfrSmp()
-//{
-//	m_pWfrSmpAux = new srTWfrSmp(m_Wfr.yStart, m_Wfr.xStart, m_Wfr.xStart + m_Wfr.xStep*(m_Wfr.nx - 1), m_Wfr.nx, m_Wfr.zStart, m_Wfr.zStart + m_Wfr.zStep*(m_Wfr.nz - 1), m_Wfr.nz, m_Wfr.eStart, m_Wfr.eStart + m_Wfr.eStep*(m_Wfr.ne - 1), m_Wfr.ne, "EV");
-//}
-
-//*************************************************************************
-
-void srTCSR::radIntegrationMonteCarlo(srTEXZY& exzy, srTEFourier& Ew)
-{//dedicated for test
-	Ew.EwX_Re = Ew.EwX_Im = Ew.EwZ_Re = Ew.EwZ_Im = 0.;
-	srTEbmDat& e_beam = m_pTrjDatAux->EbmDat;
 
-    double k = exzy.e*m_AuxIntPar.k_d_e;
-	char rand_mode = 1; //use LPTau
-	double point6d[6];
-	for(int i=0; i<m_PrecParams.m_MC_NumMacroPart; i++)
-	{
-		m_pWfrSmpAux->yStart = m_pWfrSmpAux->yEnd = exzy.y;
-		m_pWfrSmpAux->zStart = m_pWfrSmpAux->zEnd = exzy.z;
-		m_pWfrSmpAux->xStart = m_pWfrSmpAux->xEnd = exzy.x;
-		m_pWfrSmpAux->LambStart = m_pWfrSmpAux->LambEnd = exzy.e;
-		m_pWfrAux->yStart = exzy.y;
-		m_pWfrAux->zStart = exzy.z;
-		m_pWfrAux->xStart = exzy.x;
-		m_pWfrAux->eStart = exzy.e;
-
-		float *pEx = m_pWfrAux->pBaseRadX, *pEz = m_pWfrAux->pBaseRadZ;
-		*pEx = 0; *(pEx + 1) = 0; *pEz = 0; *(pEz + 1) = 0;
-		
-		m_gmRand.NextRandGauss6D(m_xcArr, m_sigArr, point6d, rand_mode);
-		e_beam.x0 = point6d[0];
-		e_beam.dxds0 = point6d[1];
-		e_beam.z0 = point6d[2];
-		e_beam.dzds0 = point6d[3];
-		e_beam.SetNewEnergy(point6d[4]);
-		e_beam.sc = point6d[5];
-
-		m_pTrjDatAux->ComputeInterpolatingStructure();
-		m_pRadInt->ComputeElectricFieldFreqDomain(m_pTrjDatAux, m_pWfrSmpAux, m_pParPrecElecFldSingle, m_pWfrAux, 0);
-
-		double ksc = -k*e_beam.sc;
-        double cos_ksc = cos(ksc), sin_ksc = sin(ksc);
-
-		double newEwX_Re = (*pEx)*cos_ksc - (*(pEx + 1))*sin_ksc;
-		double newEwX_Im = (*pEx)*sin_ksc + (*(pEx + 1))*cos_ksc;
-		double newEwZ_Re = (*pEz)*cos_ksc - (*(pEz + 1))*sin_ksc;
-		double newEwZ_Im = (*pEz)*sin_ksc + (*(pEz + 1))*cos_ksc;
-
-		m_pRadInt->DeallocateMemForRadDistr();
-
-		double inv_i_p_1 = 1./(double(i + 1));
-		Ew.EwX_Re = (i*Ew.EwX_Re + newEwX_Re)*inv_i_p_1;
-		Ew.EwX_Im = (i*Ew.EwX_Im + newEwX_Im)*inv_i_p_1;
-		Ew.EwZ_Re = (i*Ew.EwZ_Re + newEwZ_Re)*inv_i_p_1;
-		Ew.EwZ_Im = (i*Ew.EwZ_Im + newEwZ_Im)*inv_i_p_1;
-
-			//if((i==200) || (i==400) || (i==600) || (i==800) || (i==1000) || (i==1200) || (i==1400) || (i==1600) || (i==1800) || (i==2000))
-			//{
-			//	int aha = 1;
-			//}
-	}
-	Ew *= sqrt(e_beam.Neb);
-}
-
-//*************************************************************************
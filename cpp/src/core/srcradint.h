@@ -153,12 +153,8 @@ class srTCSR {
 	srTFieldBasedArrays m_FldArr;
     TAuxParamForIntegCSR m_AuxIntPar;
 
-	srTRadInt* m_pRadInt;
-	srTWfrSmp* m_pWfrSmpAux;
-	srTSRWRadStructAccessData* m_pWfrAux;
 	srTParPrecElecFld* m_pParPrecElecFldSingle;
 	srTTrjDat* m_pTrjDatAux;
-	CGenMathRand m_gmRand;
 	double m_xcArr[6], m_sigArr[6];
 
 public:
@@ -167,7 +163,7 @@ public:
 	{
 		m_PrecParams.setupFromArray(_pdPrcPar);
 		checkAndCorrectIntegLimits();
-		m_pRadInt = 0; m_pWfrSmpAux = 0; m_pWfrAux = 0; m_pParPrecElecFldSingle = 0; m_pTrjDatAux = 0;
+		m_pParPrecElecFldSingle = 0; m_pTrjDatAux = 0;
 	}
 
 	~srTCSR()
@@ -183,9 +179,6 @@ public:
 	}
 	void genRadIntegration(srTEXZY& exzy, srTEFourier& Ew)
 	{// Put here more functionality (switching to different methods) later
-
-		if(m_PrecParams.m_MC_NumMacroPart > 0) { radIntegrationMonteCarlo(exzy, Ew); return;}
-
 		srTEFourier EwResid, dEwdsAtEdges[2];
 
 		radIntegrationResiduals(exzy, EwResid, dEwdsAtEdges);
@@ -237,14 +230,12 @@ public:
 	void estimateAbsoluteTolerance();
 	void performMethodDependentSetupActions();
 	void performMethodDependentFinishActions();
-	//void createAuxWfrSmp();
 	void analyzeFinalResultsSymmetry(char& FinalResAreSymOverX, char& FinalResAreSymOverZ);
 	void fillInSymPartsOfResults(char FinalResAreSymOverX, char FinalResAreSymOverZ);
     void copySymEnergySlice(float* pOrigDataEx, float* pOrigDataEz, float* pSymDataEx, float* pSymDataEz, char SymWithRespectToXax, char SymWithRespectToZax);
 	void radIntegrationManual(srTEXZY& exzy, srTEFourier* arr_dEwds, srTEFourier& Ew);
 	void radIntegrationAutoUnd(srTEXZY& exzy, srTEFourier* arr_dEwds, srTEFourier& Ew);
 	void radIntegrationAutoWig(srTEXZY& exzy, srTEFourier* arr_dEwds, srTEFourier& Ew);
-    void radIntegrationMonteCarlo(srTEXZY& exzy, srTEFourier& Ew);
 
 	void radIntegrationResiduals(srTEXZY& exzy, srTEFourier& Ew, srTEFourier* dEwds);
 	void computeTrajArrays(srTFieldBasedArrays& FldArr, srTMagFldCont* pMagLensCont);
@@ -256,6 +247,7 @@ public:
 	void computeFuncToIntegAtOnePointOnTrj(long long i, srTEXZY exzy, srTEFourier& Ew, complex<double>& ampX, complex<double>& ampZ, complex<double>& arg);
 
     void computeElectricFieldFreqDomain();
+    void computeElectricFieldFreqDomainMonteCarlo();
 };
 
 //*************************************************************************
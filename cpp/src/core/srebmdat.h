@@ -199,6 +199,18 @@ public:
 		pMom2[10] = Mee; 
 		pMom2[11] = Mss;
 	}
+	void GetCovMatr6D(double* arCov)
+	{//6x6 covariance matrix (row by row) of (x, dxds, z, dzds, s, relative energy deviation)
+		if(arCov == 0) return;
+		double arM[] = {
+			Mxx,  Mxxp,  Mxz,  Mxzp,  Mxs,  Mxe,
+			Mxxp, Mxpxp, Mxpz, Mxpzp, Mxps, Mxpe,
+			Mxz,  Mxpz,  Mzz,  Mzzp,  Mzs,  Mze,
+			Mxzp, Mxpzp, Mzzp, Mzpzp, Mzps, Mzpe,
+			Mxs,  Mxps,  Mzs,  Mzps,  Mss,  Mse,
+			Mxe,  Mxpe,  Mze,  Mzpe,  Mse,  Mee};
+		for(int i=0; i<36; i++) arCov[i] = arM[i];
+	}
 	double GetSigmaE_GeV()
 	{
 		SigmaRelE = ::sqrt(::fabs(Mee));
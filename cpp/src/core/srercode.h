@@ -250,6 +250,7 @@
 #define INCONSISTENT_PARAMS_MI_PROC 195 + FIRST_XOP_ERR
 
 #define IMPROPER_OPTICAL_COMPONENT_HYPERBOLOID 196 + FIRST_XOP_ERR
+#define SRWL_INCORRECT_PARAM_FOR_PART_BEAM_SAMP 197 + FIRST_XOP_ERR
 
 //-------------------------------------------------------------------------
 /* Warning codes */
@@ -14,6 +14,10 @@
 #include "srgsnbm.h"
 #include "sroptelm.h"
 
+#ifdef _WITH_OMP //Pre-processor definition for compiling with OpenMP library
+#include "omp.h"
+#endif
+
 //*************************************************************************
 
 srTGsnBeam::srTGsnBeam(double SpecFlux, int InPolar, double InSigX_intens_m, int In_mx, double InSigZ_intens_m, int In_mz, double InSigT_intens_s, int InTypeT, double* pMom1, double s0, double RepRate_Hz, double PulseEn_J, double AvgPhotEn_eV)
@@ -96,10 +100,15 @@ double srTGsnBeam::Factorial(long n)
 //*************************************************************************
 
 double srTGsnBeam::HermitePolynomial(int n, double x)
-{
+{//upward recurrence: H(n) = 2*(x*H(n-1) - (n-1)*H(n-2))
 	if(n == 0) return 1.;
-	if(n == 1) return 2.*x;
-	return 2.*(x*HermitePolynomial(n - 1, x) - (n - 1)*HermitePolynomial(n - 2, x));
+	double h0 = 1., h1 = 2.*x;
+	for(int k=2; k<=n; k++)
+	{
+		double h2 = 2.*(x*h1 - (k - 1)*h0);
+		h0 = h1; h1 = h2;
+	}
+	return h1;
 }
 
 //*************************************************************************
@@ -224,102 +233,246 @@ void srTGsnBeam::ComputeElectricField(srTWfrSmp* pWfrSmp, srTSRWRadStructAccessD
 
 //*************************************************************************
 
+void srTGsnBeam::ComputeElectricFieldModes(srTWfrSmp* pWfrSmp, srTSRWRadStructAccessData** arWfr, const int* arModeInds, int nModes)
+{// m, eV !
+//Computes a set of Gauss-Hermite modes (arModeInds[2*i], arModeInds[2*i+1]) of this beam, one mode per wavefront; all wavefronts should have the same mesh
+	if((pWfrSmp == 0) || (arWfr == 0) || (arModeInds == 0) || (nModes <= 0)) throw INCORRECT_PARAMS_SR_COMP;
+
+	DistrInfoDat = *pWfrSmp;
+	DistrInfoDat.EnsureZeroTransverseRangesForSinglePoints();
+	for(int i=0; i<nModes; i++)
+	{
+		if(arWfr[i] == 0) throw INCORRECT_PARAMS_SR_COMP;
+		arWfr[i]->SetRadSamplingFromObs(DistrInfoDat);
+	}
+
+	int res = 0;
+	if(arWfr[0]->PresT)
+	{//time-domain fields are created mode by mode
+		int mxOrig = mx, mzOrig = mz;
+		for(int i=0; i<nModes; i++)
+		{
+			mx = arModeInds[i << 1]; mz = arModeInds[(i << 1) + 1];
+			if(res = CreateWavefrontElFieldTimeDomain(*(arWfr[i]))) break;
+		}
+		mx = mxOrig; mz = mzOrig;
+		if(res) throw res;
+	}
+	else
+	{
+		if(res = CreateWavefrontElFieldFreqDomainModes(arWfr, arModeInds, nModes)) throw res;
+	}
+
+	srTGenOptElem GenOptElem;
+	for(int i=0; i<nModes; i++)
+	{
+		arWfr[i]->SetNonZeroWavefrontLimitsToFullRange();
+		if(res = GenOptElem.ComputeRadMoments(arWfr[i])) throw res;
+	}
+}
+
+//*************************************************************************
+
 int srTGsnBeam::CreateWavefrontElFieldFreqDomain(srTSRWRadStructAccessData& RadAccessData)
 {// m, eV or s!
-//can create frequency- or time-domain electric field
+	srTSRWRadStructAccessData* pWfr = &RadAccessData;
+	int arModeInds[] = {mx, mz};
+	return CreateWavefrontElFieldFreqDomainModes(&pWfr, arModeInds, 1);
+}
+
+//*************************************************************************
+
+int srTGsnBeam::CreateWavefrontElFieldFreqDomainModes(srTSRWRadStructAccessData** arWfr, const int* arModeInds, int nModes)
+{// m, eV !
+//Creates Gauss-Hermite modes (arModeInds[2*i], arModeInds[2*i+1]) in wavefronts arWfr[i], which must all have the same mesh.
+//The field is separable in x and z: per-energy constants and 1D x/z factors (Hermite function x Gaussian x phase) are computed once
+//for all modes, and the 2D field of each mode is then formed as an outer product.
+	if((arWfr == 0) || (arModeInds == 0) || (nModes <= 0)) return INCORRECT_PARAMS_SR_COMP;
+
 	int result;
 	const double TwoPI = 6.28318530717959;
 	const double InvTwoPI = 1./TwoPI;
+	const double Pi = 3.1415926535898;
 	const double enMult = 2.53384080189E+06;
+	const double sqrt_2 = sqrt(2.);
+
+	srTSRWRadStructAccessData &Wfr0 = *(arWfr[0]);
+	const long ne = Wfr0.ne, nx = Wfr0.nx, nz = Wfr0.nz;
 
-	RadAccessData.SetAvgPhotEnergyFromLimits(); //OC180314
+	int mxMax = 0, mzMax = 0;
+	for(int iMode=0; iMode<nModes; iMode++)
+	{
+		srTSRWRadStructAccessData *pWfr = arWfr[iMode];
+		if(pWfr == 0) return INCORRECT_PARAMS_SR_COMP;
+		if((pWfr->ne != ne) || (pWfr->nx != nx) || (pWfr->nz != nz) || 
+		   (pWfr->eStart != Wfr0.eStart) || (pWfr->eStep != Wfr0.eStep) || 
+		   (pWfr->xStart != Wfr0.xStart) || (pWfr->xStep != Wfr0.xStep) || 
+		   (pWfr->zStart != Wfr0.zStart) || (pWfr->zStep != Wfr0.zStep)) return INCORRECT_PARAMS_SR_COMP;
+
+		int mxCur = arModeInds[iMode << 1], mzCur = arModeInds[(iMode << 1) + 1];
+		if((mxCur < 0) || (mzCur < 0)) return INCORRECT_PARAMS_SR_COMP;
+		if(mxMax < mxCur) mxMax = mxCur;
+		if(mzMax < mzCur) mzMax = mzCur;
+
+		pWfr->SetAvgPhotEnergyFromLimits(); //OC180314
+	}
 
 	if(result = CheckInputConsistency()) return result;
 	SetupSourceConstantsFreqDomain();
 
-	//x0Prop = EbmDat.x0 + EbmDat.dxds0*LongDist;
-	//z0Prop = EbmDat.z0 + EbmDat.dzds0*LongDist;
-
-	double ActNormConstElField = NormConstElField; //OC081014
-	if(RadAccessData.ElecFldUnit == 2) ActNormConstElField *= sqrt(1.602176462e-16); //case of field units: sqrt(J/eV/mm^2) or sqrt(W/mm^2)
-
 	double InvLongDist = 1./LongDist;
+	const double &x0 = EbmDat.x0, &z0 = EbmDat.z0, &dxds0 = EbmDat.dxds0, &dzds0 = EbmDat.dzds0;
 
-	float* tRadX = RadAccessData.pBaseRadX;
-	float* tRadZ = RadAccessData.pBaseRadZ;
-
-	double z = RadAccessData.zStart - z0Prop;
-	double z_mi_z0 = RadAccessData.zStart - EbmDat.z0; //OC210413
-
-	for(int iz=0; iz<RadAccessData.nz; iz++)
+	//Per-energy constants
+	vector<double> vPropInvSigX(ne), vPropInvSigZ(ne), vPropInvTwoSigXe2(ne), vPropInvTwoSigZe2(ne);
+	vector<double> vPhMultX(ne), vPhMultZ(ne), vXpMult(ne), vZpMult(ne), vNuX(ne), vNuZ(ne), vAmpE(ne);
+	double en = Wfr0.eStart;
+	for(long ie=0; ie<ne; ie++)
 	{
-		double ze2 = z*z;
-		double z_mi_z0_e2 = z_mi_z0*z_mi_z0; //OC210413
-		double zz = z_mi_z0 + EbmDat.z0; //OC210413
-
-		double x = RadAccessData.xStart - x0Prop;
-		double x_mi_x0 = RadAccessData.xStart - EbmDat.x0; //OC210413
-
-		for(int ix=0; ix<RadAccessData.nx; ix++)
+		double PropRatX = en*PropagMultX, PropRatZ = en*PropagMultZ;
+		double InvPropRatX = 1./PropRatX, InvPropRatZ = 1./PropRatZ;
+		double SigMultX = 1. + InvPropRatX*InvPropRatX, SigMultZ = 1. + InvPropRatZ*InvPropRatZ;
+		double DisMultX = 1. + PropRatX*PropRatX, DisMultZ = 1. + PropRatZ*PropRatZ;
+
+		double PropInvTwoSigXe2 = InvTwoSigXe2/SigMultX, PropInvTwoSigZe2 = InvTwoSigZe2/SigMultZ;
+		vPropInvTwoSigXe2[ie] = PropInvTwoSigXe2; vPropInvTwoSigZe2[ie] = PropInvTwoSigZe2;
+		double PropInvSigX = sqrt(2.*PropInvTwoSigXe2), PropInvSigZ = sqrt(2.*PropInvTwoSigZe2);
+		vPropInvSigX[ie] = PropInvSigX; vPropInvSigZ[ie] = PropInvSigZ;
+
+		double PropInvRx = InvLongDist/DisMultX, PropInvRz = InvLongDist/DisMultZ;
+		vPhMultX[ie] = en*enMult*PropInvRx; vPhMultZ[ie] = en*enMult*PropInvRz;
+		vXpMult[ie] = (1./PropInvRx - LongDist)*dxds0; vZpMult[ie] = (1./PropInvRz - LongDist)*dzds0; //OC210413
+		vNuX[ie] = atan(InvPropRatX); vNuZ[ie] = atan(InvPropRatZ);
+
+		double argForExp = 0;
+		if(m_AvgPhotEn > 0) 
 		{
-			double xe2 = x*x;
-			double x_mi_x0_e2 = x_mi_x0*x_mi_x0; //OC210413
-			double xx = x_mi_x0 + EbmDat.x0; //OC210413
+			double dPhotEn = en - m_AvgPhotEn;
+			argForExp = -dPhotEn*dPhotEn*m_InvTwoSigPhotEnE2;
+		}
+		vAmpE[ie] = sqrt(PropInvSigX*PropInvSigZ)*exp(argForExp);
+		en += Wfr0.eStep;
+	}
 
-			double en = RadAccessData.eStart;
-			for(int ie=0; ie<RadAccessData.ne; ie++)
+	//1D factors: normalized Hermite functions of all required orders x Gaussian ([n][ix][ie]), and phase factors ([ix][ie]{re,im});
+	//normalized functions H_n(u)/sqrt(2^n n!) are obtained by stable recurrence, so that high orders do not overflow
+	long nxe = nx*ne, nze = nz*ne;
+	vector<double> vHermGsnX((mxMax + 1)*nxe), vHermGsnZ((mzMax + 1)*nze), vPhFactX(nxe << 1), vPhFactZ(nze << 1);
+	for(int iq=0; iq<2; iq++)
+	{
+		bool isX = (iq == 0);
+		long np = isX? nx : nz;
+		long npe = isX? nxe : nze;
+		int nMax = isX? mxMax : mzMax;
+		double *pHermGsn = isX? &vHermGsnX[0] : &vHermGsnZ[0];
+		double *pPhFact = isX? &vPhFactX[0] : &vPhFactZ[0];
+		const double *pPropInvSig = isX? &vPropInvSigX[0] : &vPropInvSigZ[0];
+		const double *pPropInvTwoSige2 = isX? &vPropInvTwoSigXe2[0] : &vPropInvTwoSigZe2[0];
+		const double *pPhMult = isX? &vPhMultX[0] : &vPhMultZ[0];
+		const double *pPosMult = isX? &vXpMult[0] : &vZpMult[0];
+		double pStart = isX? Wfr0.xStart : Wfr0.zStart, pStep = isX? Wfr0.xStep : Wfr0.zStep;
+		double p0Prop = isX? x0Prop : z0Prop, p0 = isX? x0 : z0, dpds0 = isX? dxds0 : dzds0;
+
+		for(long ip=0; ip<np; ip++)
+		{
+			double pAbs = pStart + ip*pStep;
+			double p = pAbs - p0Prop, pe2 = p*p;
+			double p_mi_p0 = pAbs - p0; //OC210413
+			double PhArgConst = p_mi_p0*p_mi_p0 + 2*LongDist*p0*dpds0;
+			double PhArgLin = 2*pAbs - LongDist*dpds0;
+
+			long ofst = ip*ne;
+			for(long ie=0; ie<ne; ie++)
 			{
-				double PropRatX = en*PropagMultX, PropRatZ = en*PropagMultZ;
-				double PropRatXe2 = PropRatX*PropRatX, PropRatZe2 = PropRatZ*PropRatZ;
-				double InvPropRatX = 1./PropRatX, InvPropRatZ = 1./PropRatZ;
-
-				double SigMultX = 1. + InvPropRatX*InvPropRatX, SigMultZ = 1. + InvPropRatZ*InvPropRatZ;
-				double DisMultX = 1. + PropRatXe2, DisMultZ = 1. + PropRatZe2;
+				double u = p*pPropInvSig[ie];
+				double h0 = exp(-pe2*pPropInvTwoSige2[ie]);
+				double *tHermGsn = pHermGsn + ofst + ie;
+				*tHermGsn = h0;
+				if(nMax > 0)
+				{
+					double h1 = sqrt_2*u*h0;
+					tHermGsn += npe; *tHermGsn = h1;
+					for(int n=2; n<=nMax; n++)
+					{
+						double h2 = sqrt(2./n)*u*h1 - sqrt((n - 1.)/n)*h0;
+						tHermGsn += npe; *tHermGsn = h2;
+						h0 = h1; h1 = h2;
+					}
+				}
 
-				double PropInvTwoSigXe2 = InvTwoSigXe2/SigMultX, PropInvTwoSigZe2 = InvTwoSigZe2/SigMultZ;
-				double PropInvSigX = sqrt(2.*PropInvTwoSigXe2), PropInvSigZ = sqrt(2.*PropInvTwoSigZe2);
-				double PropInvRx = InvLongDist/DisMultX, PropInvRz = InvLongDist/DisMultZ;
+				double Phase = pPhMult[ie]*(PhArgConst + pPosMult[ie]*PhArgLin);
+				Phase -= TwoPI*((long long)(Phase*InvTwoPI));
+				double *tPhFact = pPhFact + ((ofst + ie) << 1);
+				*tPhFact = cos(Phase); *(tPhFact + 1) = sin(Phase);
+			}
+		}
+	}
 
-				double xpMult = (1./PropInvRx - LongDist)*EbmDat.dxds0, zpMult = (1./PropInvRz - LongDist)*EbmDat.dzds0; //OC210413
+	//Outer products, mode by mode
+	double NormConstElFieldBase = sqrt(PhotPerBW/((1.E+06)*Pi)); //NormConstElField without the Hermite normalization (the latter is included in the 1D factors)
+	vector<double> vCoefE(ne << 1);
+	for(int iMode=0; iMode<nModes; iMode++)
+	{
+		srTSRWRadStructAccessData &RadAccessData = *(arWfr[iMode]);
+		int mxCur = arModeInds[iMode << 1], mzCur = arModeInds[(iMode << 1) + 1];
 
-				double NuX = atan(InvPropRatX), NuZ = atan(InvPropRatZ);
+		double ActNormConstElField = NormConstElFieldBase; //OC081014
+		if(RadAccessData.ElecFldUnit == 2) ActNormConstElField *= sqrt(1.602176462e-16); //case of field units: sqrt(J/eV/mm^2) or sqrt(W/mm^2)
 
-				//double Phase = en*enMult*(xe2*PropInvRx + ze2*PropInvRz) + (mx + 0.5)*NuX + (mz + 0.5)*NuZ;
-				double Phase = en*enMult*((x_mi_x0_e2 + 2*LongDist*EbmDat.x0*EbmDat.dxds0 + xpMult*(2*xx - LongDist*EbmDat.dxds0))*PropInvRx 
-										+ (z_mi_z0_e2 + 2*LongDist*EbmDat.z0*EbmDat.dzds0 + zpMult*(2*zz - LongDist*EbmDat.dzds0))*PropInvRz) 
-							   + (mx + 0.5)*NuX + (mz + 0.5)*NuZ; //OC210413 //??
+		for(long ie=0; ie<ne; ie++)
+		{
+			double PhaseE = (mxCur + 0.5)*vNuX[ie] + (mzCur + 0.5)*vNuZ[ie];
+			double BufA = ActNormConstElField*vAmpE[ie];
+			vCoefE[ie << 1] = BufA*cos(PhaseE); vCoefE[(ie << 1) + 1] = BufA*sin(PhaseE);
+		}
 
-				Phase -= TwoPI*long(Phase*InvTwoPI);
-				double CosPh = cos(Phase), SinPh = sin(Phase);
+		const double *pHermGsnX = &vHermGsnX[0] + mxCur*nxe, *pHermGsnZ = &vHermGsnZ[0] + mzCur*nze;
+		const double *pPhFactX = &vPhFactX[0], *pPhFactZ = &vPhFactZ[0], *pCoefE = &vCoefE[0];
 
-				//double ExpAr = exp(-xe2*PropInvTwoSigXe2 - ze2*PropInvTwoSigZe2);
-				double argForExp = -xe2*PropInvTwoSigXe2 - ze2*PropInvTwoSigZe2;
-				if(m_AvgPhotEn > 0) 
+#ifdef _WITH_OMP
+		#pragma omp parallel
+#endif
+		{
+			vector<double> vRowZ(ne << 1);
+			double *pRowZ = &vRowZ[0];
+#ifdef _WITH_OMP
+			#pragma omp for schedule(static)
+#endif
+			for(long iz=0; iz<nz; iz++)
+			{
+				const double *tHermGsnZ = pHermGsnZ + iz*ne, *tPhFactZ = pPhFactZ + ((iz*ne) << 1), *tCoefE = pCoefE;
+				double *tRowZ = pRowZ;
+				for(long ie=0; ie<ne; ie++)
 				{
-					double dPhotEn = en - m_AvgPhotEn;
-					argForExp -= dPhotEn*dPhotEn*m_InvTwoSigPhotEnE2;
+					double ReZ = (*tHermGsnZ)*(*tPhFactZ), ImZ = (*tHermGsnZ)*(*(tPhFactZ + 1));
+					*(tRowZ++) = ReZ*(*tCoefE) - ImZ*(*(tCoefE + 1));
+					*(tRowZ++) = ReZ*(*(tCoefE + 1)) + ImZ*(*tCoefE);
+					tHermGsnZ++; tPhFactZ += 2; tCoefE += 2;
 				}
 
-				double ExpAr = exp(argForExp);
-				double HermX = HermitePolynomial(mx, x*PropInvSigX), HermZ = HermitePolynomial(mz, z*PropInvSigZ);
-
-				//double BufA = NormConstElField*sqrt(PropInvSigX*PropInvSigZ)*ExpAr*HermX*HermZ;
-				double BufA = ActNormConstElField*sqrt(PropInvSigX*PropInvSigZ)*ExpAr*HermX*HermZ; //OC081014
-				double ReA = BufA*CosPh, ImA = BufA*SinPh;
-
-				SetupProperPolariz(ReA, ImA, tRadX, tRadZ);
-
-				tRadX += 2; tRadZ += 2;
-				en += RadAccessData.eStep;
+				long long ofstRow = ((long long)iz)*((long long)nxe) << 1;
+				float *tRadX = RadAccessData.pBaseRadX + ofstRow;
+				float *tRadZ = RadAccessData.pBaseRadZ + ofstRow;
+				const double *tHermGsnX = pHermGsnX, *tPhFactX = pPhFactX;
+				for(long ix=0; ix<nx; ix++)
+				{
+					tRowZ = pRowZ;
+					for(long ie=0; ie<ne; ie++)
+					{
+						double ReX = (*tHermGsnX)*(*tPhFactX), ImX = (*tHermGsnX)*(*(tPhFactX + 1));
+						double ReA = ReX*(*tRowZ) - ImX*(*(tRowZ + 1));
+						double ImA = ReX*(*(tRowZ + 1)) + ImX*(*tRowZ);
+						SetupProperPolariz(ReA, ImA, tRadX, tRadZ);
+
+						tRadX += 2; tRadZ += 2; tRowZ += 2;
+						tHermGsnX++; tPhFactX += 2;
+					}
+				}
 			}
-			x += RadAccessData.xStep;
-			x_mi_x0 += RadAccessData.xStep; //OC210413
 		}
-		z += RadAccessData.zStep;
-		z_mi_z0 += RadAccessData.zStep; //OC210413
+		RadAccessData.Pres = 0;
+		RadAccessData.PresT = 0;
 	}
-	RadAccessData.Pres = 0;
-	RadAccessData.PresT = 0;
 	return 0;
 }
 
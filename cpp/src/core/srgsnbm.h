@@ -63,10 +63,12 @@ public:
 	void SetupSourceConstantsFreqDomain();
 	void SetupSourceConstantsTimeDomain();
 	int CreateWavefrontElFieldFreqDomain(srTSRWRadStructAccessData&);
+	int CreateWavefrontElFieldFreqDomainModes(srTSRWRadStructAccessData** arWfr, const int* arModeInds, int nModes);
 	int CreateWavefrontElFieldTimeDomain(srTSRWRadStructAccessData&);
 
 	//void ComputeElectricFieldFreqDomain(srTWfrSmp* pWfrSmp, srTSRWRadStructAccessData* pWfr);
 	void ComputeElectricField(srTWfrSmp* pWfrSmp, srTSRWRadStructAccessData* pWfr);
+	void ComputeElectricFieldModes(srTWfrSmp* pWfrSmp, srTSRWRadStructAccessData** arWfr, const int* arModeInds, int nModes);
 
 	double Factorial(long n);
 	double HermitePolynomial(int n, double x);
@@ -14,6 +14,7 @@
 
 #include "srgtrjdt.h"
 #include "srwlib.h"
+#include "srwlprof.h"
 #include "auxparse.h"
 #include "gminterp.h"
 #include <algorithm>
@@ -26,6 +27,7 @@ void srTGenTrjDat::CompTrjCrdVelRK(double sStart, double sEnd, long long ns, dou
  //Independent variable is s = c*t; initial conditions are assumed to be defined for s = c*t = 0
  //3D trajectory is calculated in Laboratory Frame
  //Z is assumed to be longitudinal variable here!
+	CSRWLProfScope profScope(srwlProfTrjInteg, ns*9*sizeof(double));
 	if(ns <= 0) throw SRWL_INCORRECT_PARAM_FOR_TRJ_COMP;
 	if(m_hMagElem.rep == 0) throw SRWL_INCORRECT_PARAM_FOR_TRJ_COMP;
 	//if(sStart*sEnd > 0) throw SRWL_INCORRECT_INIT_COND_FOR_TRJ_COMP;
@@ -366,9 +368,60 @@ void srTGenTrjDat::CompTrjCrdVelRK(double sStart, double sEnd, long long ns, dou
 void srTGenTrjDat::CompTrjKickMatr(SRWLKickM* arKickM, int nKickM, double sStart, double sEnd, long long ns, double* pInPrecPar, double* pOutBtX, double* pOutX, double* pOutBtY, double* pOutY, double* pOutBtZ, double* pOutZ)
 {
 	if((arKickM == 0) || (nKickM <= 0)) throw SRWL_INCORRECT_PARAM_FOR_TRJ_COMP;
-	if(ns <= 0) throw SRWL_INCORRECT_PARAM_FOR_TRJ_COMP;
 
-	//sort arKickM to find groups of kick-matrices with non-overlapping longitudinal intervals
+	vector<vector<int> > vIndNonOverlapKickGroups;
+	vector<pair<double, double> > vIndNonOverlapKickGroupRanges;
+	SetupKickGroups(arKickM, nKickM, vIndNonOverlapKickGroups, vIndNonOverlapKickGroupRanges);
+
+	CompTrjKickMatr(arKickM, vIndNonOverlapKickGroups, vIndNonOverlapKickGroupRanges, sStart, sEnd, ns, pInPrecPar, pOutBtX, pOutX, pOutBtY, pOutY, pOutBtZ, pOutZ);
+}
+
+//*************************************************************************
+
+void srTGenTrjDat::CompTrjKickMatrMult(SRWLPrtTrj* arTrj, int nTrj, SRWLKickM* arKickM, int nKickM, double* pInPrecPar)
+{//Trajectories of many particles in the same kick-matrices: the groups of kick-matrices are set up once,
+ //and the particles (which are independent) are tracked in parallel; each trajectory is the same as computed by CompTrjKickMatr
+	if((arTrj == 0) || (nTrj <= 0)) throw SRWL_INCORRECT_PARAM_FOR_TRJ_COMP;
+
+	vector<vector<int> > vIndNonOverlapKickGroups;
+	vector<pair<double, double> > vIndNonOverlapKickGroupRanges;
+	SetupKickGroups(arKickM, nKickM, vIndNonOverlapKickGroups, vIndNonOverlapKickGroupRanges);
+
+	const double elecEn0 = 0.51099890221e-03; //[GeV]
+	int resErNo = 0;
+#ifdef _WITH_OMP
+	#pragma omp parallel for schedule(dynamic, 1)
+#endif
+	for(int iTrj=0; iTrj<nTrj; iTrj++)
+	{
+		SRWLPrtTrj &trj = arTrj[iTrj];
+		SRWLParticle &part = trj.partInitCond;
+		double arMom1[] = {(part.gamma)*(part.relE0)*elecEn0, part.x, part.xp, part.y, part.yp, part.z};
+		try
+		{
+			srTEbmDat elecBeam(1., 1., arMom1, 6, 0, 0, part.z, part.nq);
+			srTGenTrjDat genTrjDat(&elecBeam);
+			genTrjDat.CompTrjKickMatr(arKickM, vIndNonOverlapKickGroups, vIndNonOverlapKickGroupRanges, trj.ctStart, trj.ctEnd, trj.np, pInPrecPar, trj.arXp, trj.arX, trj.arYp, trj.arY, trj.arZp, trj.arZ);
+		}
+		catch(int erNo)
+		{//exceptions can't leave parallel region; the first error is re-thrown after all particles are processed
+#ifdef _WITH_OMP
+			#pragma omp critical(srTGenTrjDat_CompTrjKickMatrMult)
+#endif
+			{
+				if(resErNo == 0) resErNo = erNo;
+			}
+		}
+	}
+	if(resErNo != 0) throw resErNo;
+}
+
+//*************************************************************************
+
+void srTGenTrjDat::SetupKickGroups(SRWLKickM* arKickM, int nKickM, vector<vector<int> >& vIndNonOverlapKickGroups, vector<pair<double, double> >& vIndNonOverlapKickGroupRanges)
+{//Sorts arKickM to find groups of kick-matrices with non-overlapping longitudinal intervals; does not depend on particle, so can be done once for many trajectories
+	if((arKickM == 0) || (nKickM <= 0)) throw SRWL_INCORRECT_PARAM_FOR_TRJ_COMP;
+
 	vector<pair<int, pair<double, double> > > vKickStInd;
 	SRWLKickM *t_arKickM = arKickM;
 	for(int i=0; i<nKickM; i++)
@@ -377,12 +430,13 @@ void srTGenTrjDat::CompTrjKickMatr(SRWLKickM* arKickM, int nKickM, double sStart
 		pair<double, double> curRange(t_arKickM->z - curHalfRange, t_arKickM->z + curHalfRange);
 		pair<int, pair<double, double> > curPair(i, curRange);
 		vKickStInd.push_back(curPair);
+		t_arKickM++;
 	}
 
 	sort(vKickStInd.begin(), vKickStInd.end(), CAuxParse::LessInPairBasedOnFirstInNestedPair<int, double, double>);
 
-	vector<vector<int> > vIndNonOverlapKickGroups;
-	vector<pair<double, double> > vIndNonOverlapKickGroupRanges;
+	vIndNonOverlapKickGroups.clear();
+	vIndNonOverlapKickGroupRanges.clear();
 	vector<int> vIndKickM;
 	vIndKickM.push_back(vKickStInd[0].first);
 	double curGroupStart = vKickStInd[0].second.first;
@@ -399,6 +453,7 @@ void srTGenTrjDat::CompTrjKickMatr(SRWLKickM* arKickM, int nKickM, double sStart
 			vIndNonOverlapKickGroupRanges.push_back(curRange);
 
 			vIndKickM.erase(vIndKickM.begin(), vIndKickM.end());
+			vIndKickM.push_back(vKickStInd[j].first);
 			curGroupStart = newStart;
 			curGroupEnd = newEnd;
 		}
@@ -417,7 +472,14 @@ void srTGenTrjDat::CompTrjKickMatr(SRWLKickM* arKickM, int nKickM, double sStart
 
 		vIndKickM.erase(vIndKickM.begin(), vIndKickM.end());
 	}
-	//sorting completed
+}
+
+//*************************************************************************
+
+void srTGenTrjDat::CompTrjKickMatr(SRWLKickM* arKickM, vector<vector<int> >& vIndNonOverlapKickGroups, vector<pair<double, double> >& vIndNonOverlapKickGroupRanges, double sStart, double sEnd, long long ns, double* pInPrecPar, double* pOutBtX, double* pOutX, double* pOutBtY, double* pOutY, double* pOutBtZ, double* pOutZ)
+{//Trajectory of one particle, with groups of kick-matrices set up by SetupKickGroups
+	if(ns <= 0) throw SRWL_INCORRECT_PARAM_FOR_TRJ_COMP;
+	CSRWLProfScope profScope(srwlProfTrjInteg, ns*6*sizeof(double));
 
 	bool trjShouldBeAdded = (pInPrecPar[0] == 1);
 	const double sResEdgeToler = 1.E-12;
@@ -673,7 +735,15 @@ void srTGenTrjDat::IntegrateKicks(SRWLKickM* arKickM, vector<vector<int> >& vInd
 	double *tX = pTrjRes, *tBtX = pTrjRes + 1, *tY = pTrjRes + 2, *tBtY = pTrjRes + 3, *tZ = pTrjRes + 4;
 	*tX = initCond[0]; *tBtX = initCond[1]; *tY = initCond[2]; *tBtY = initCond[3]; *tZ = initCond[4];
 
-	map<int, pair<double, pair<double, double> > >  mAuxPrevKick; //to keep previous kick values and longitudinal positions at which these values were obtained by interpolation
+	//To keep previous kick values and longitudinal positions at which these values were obtained by interpolation (vs index of kick-matrix)
+	int nKickM = 0;
+	for(int i=0; i<nGroups; i++)
+	{
+		vector<int>& curVectIndKicks = vIndNonOverlapKickGroups[i];
+		for(int j=0; j<(int)curVectIndKicks.size(); j++) if(nKickM <= curVectIndKicks[j]) nKickM = curVectIndKicks[j] + 1;
+	}
+	vector<pair<double, pair<double, double> > > vAuxPrevKick(nKickM);
+	vector<char> vAuxPrevKickIsDef(nKickM, 0);
 	double arF[12];
 	double sStep = (ns > 1)? (sEnd - sStart)/(ns - 1) : 0.;
 	//s is longitudinal position from here on!
@@ -744,10 +814,9 @@ void srTGenTrjDat::IntegrateKicks(SRWLKickM* arKickM, vector<vector<int> >& vInd
 								mult *= dsKick/pCurKickM->rz;
 
 								bool calcNewKickVals = false;
-								map<int, pair<double, pair<double, double> > >::iterator itPrevKick = mAuxPrevKick.find(indCurKick);
-								if(itPrevKick != mAuxPrevKick.end())
+								if(vAuxPrevKickIsDef[indCurKick])
 								{//to save time: don't interpolate (use previous interpolated kick value) if the current kick step is not exceeded
-									pair<double, pair<double, double> > &pairKickInf = itPrevKick->second;
+									pair<double, pair<double, double> > &pairKickInf = vAuxPrevKick[indCurKick];
 									double sPrevKick = pairKickInf.first;
 									double sStepKick = (pCurKickM->nz > 1)? pCurKickM->rz/(pCurKickM->nz - 1) : 0.;
 									if((s - sPrevKick) <= sStepKick)
@@ -879,14 +948,15 @@ void srTGenTrjDat::IntegrateKicks(SRWLKickM* arKickM, vector<vector<int> >& vInd
 										ky_ds += dky*dsKick;
 									}
 									pair<double, pair<double, double> > pairNewKickInf(s, pair<double, double>(newKickX, newKickY));
-									mAuxPrevKick[indCurKick] = pairNewKickInf;
+									vAuxPrevKick[indCurKick] = pairNewKickInf;
+									vAuxPrevKickIsDef[indCurKick] = 1;
 								}
 							//}
 						//}
 					}
 					else if(s >= sEndCurKick)
 					{
-						mAuxPrevKick.erase(indCurKick); //to minimize search in this lookup table
+						vAuxPrevKickIsDef[indCurKick] = 0;
 					}
 				}
 				//to add kicks to trajectory here:
@@ -168,6 +168,8 @@ class srTMagElem;
 class srTWfrSmp;
 struct SRWLStructKickMatrix;
 typedef struct SRWLStructKickMatrix SRWLKickM;
+struct SRWLStructParticleTrajectory;
+typedef struct SRWLStructParticleTrajectory SRWLPrtTrj;
 typedef CSmartPtr<srTGenTrjDat> srTGenTrjHndl;
 
 //*************************************************************************
@@ -234,6 +236,9 @@ public:
 	void CompTrjCrdVelRK(double sSt, double sEn, long long np, double* pInPrecPar, double* pOutBtxData, double* pOutXData, double* pOutBtyData, double* pOutYData, double* pOutBtzData, double* pOutZData, double* pOutBxData, double* pOutByData, double* pOutBzData);
 	//void CompTrjKickMatr(SRWLKickM* arKickM, int nKickM, double sSt, double sEn, long np, double* pInPrecPar, double* pOutBtxData, double* pOutXData, double* pOutBtyData, double* pOutYData, double* pOutBtzData, double* pOutZData);
 	void CompTrjKickMatr(SRWLKickM* arKickM, int nKickM, double sSt, double sEn, long long np, double* pInPrecPar, double* pOutBtxData, double* pOutXData, double* pOutBtyData, double* pOutYData, double* pOutBtzData, double* pOutZData);
+	void CompTrjKickMatr(SRWLKickM* arKickM, vector<vector<int> >& vIndNonOverlapKickGroups, vector<pair<double, double> >& vIndNonOverlapKickGroupRanges, double sSt, double sEn, long long np, double* pInPrecPar, double* pOutBtxData, double* pOutXData, double* pOutBtyData, double* pOutYData, double* pOutBtzData, double* pOutZData);
+	static void CompTrjKickMatrMult(SRWLPrtTrj* arTrj, int nTrj, SRWLKickM* arKickM, int nKickM, double* pInPrecPar);
+	static void SetupKickGroups(SRWLKickM* arKickM, int nKickM, vector<vector<int> >& vIndNonOverlapKickGroups, vector<pair<double, double> >& vIndNonOverlapKickGroupRanges);
 	//void IntegrateKicks(SRWLKickM* arKickM, vector<vector<int> >& vIndNonOverlapKickGroups, vector<pair<double, double> >& vIndNonOverlapKickGroupRanges, double inv_B_pho, double* initCond, double sStart, double sEnd, int ns, double* pTrjRes);
 	void IntegrateKicks(SRWLKickM* arKickM, vector<vector<int> >& vIndNonOverlapKickGroups, vector<pair<double, double> >& vIndNonOverlapKickGroupRanges, double inv_B_pho, double* initCond, double sStart, double sEnd, long long ns, double* pTrjRes);
 
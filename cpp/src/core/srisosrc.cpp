@@ -14,6 +14,10 @@
 #include "srisosrc.h"
 #include "srwlib.h"
 
+#ifdef _WITH_OMP //Pre-processor definition for compiling with OpenMP library
+#include "omp.h"
+#endif
+
 //*************************************************************************
 
 srTIsotrSrc::srTIsotrSrc(SRWLPtSrc* pPtSrc)
@@ -69,44 +73,64 @@ int srTIsotrSrc::CreateWavefrontElField(srTSRWRadStructAccessData& RadAccessData
 	double Inv_ye2 = 1./LongDistE2;
 	double enMult = (2.53384080189E+06)*LongDist;
 
-	float* tRadX = RadAccessData.pBaseRadX;
-	float* tRadZ = RadAccessData.pBaseRadZ;
+	long nx = RadAccessData.nx, nz = RadAccessData.nz, ne = RadAccessData.ne;
+	double eStart = RadAccessData.eStart, eStep = RadAccessData.eStep;
 
-	double z = RadAccessData.zStart - z0;
-	for(int iz=0; iz<RadAccessData.nz; iz++)
+#ifdef _WITH_OMP
+	#pragma omp parallel for schedule(static)
+#endif
+	for(long iz=0; iz<nz; iz++)
 	{
+		double z = RadAccessData.zStart + iz*RadAccessData.zStep - z0;
 		double ze2 = z*z;
 
+		long long ofst = (((long long)iz)*((long long)nx)*((long long)ne)) << 1;
+		float* tRadX = RadAccessData.pBaseRadX + ofst;
+		float* tRadZ = RadAccessData.pBaseRadZ + ofst;
+
 		double x = RadAccessData.xStart - x0;
-		for(int ix=0; ix<RadAccessData.nx; ix++)
+		for(long ix=0; ix<nx; ix++)
 		{
 			double xe2 = x*x;
 			double a = (xe2 + ze2)*Inv_ye2;
 			double CoordPhaseTerm = enMult*a*(1 - 0.25*a + 0.125*a*a);
 
-			double en = RadAccessData.eStart;
-			for(int ie=0; ie<RadAccessData.ne; ie++)
-			{
-				double Phase = en*CoordPhaseTerm;
-				//Phase -= TwoPI*long(Phase*InvTwoPI);
-				Phase -= TwoPI*((long long)(Phase*InvTwoPI));
+			double R2 = LongDistE2 + xe2 + ze2;
+			double GeomFact = LongDistE3/(R2*sqrt(R2));
+			double NormConst = NormConstElField*GeomFact;
 
-				double CosPh = cos(Phase), SinPh = sin(Phase);
+			//Phase is linear in photon energy: it is advanced by a constant rotation and re-evaluated directly every m_nPhaseRecurSteps steps
+			double CosDPh = 1., SinDPh = 0.;
+			if(ne > 1)
+			{
+				double DPhase = eStep*CoordPhaseTerm;
+				DPhase -= TwoPI*((long long)(DPhase*InvTwoPI));
+				CosDPh = cos(DPhase); SinDPh = sin(DPhase);
+			}
 
-				double R2 = LongDistE2 + xe2 + ze2;
-				double GeomFact = LongDistE3/(R2*sqrt(R2));
-				double NormConst = NormConstElField*GeomFact;
+			double CosPh = 1., SinPh = 0.;
+			for(long ie=0; ie<ne; ie++)
+			{
+				if((ie % m_nPhaseRecurSteps) == 0)
+				{
+					double Phase = (eStart + ie*eStep)*CoordPhaseTerm;
+					Phase -= TwoPI*((long long)(Phase*InvTwoPI));
+					CosPh = cos(Phase); SinPh = sin(Phase);
+				}
+				else
+				{
+					double CosPhPrev = CosPh;
+					CosPh = CosPhPrev*CosDPh - SinPh*SinDPh;
+					SinPh = CosPhPrev*SinDPh + SinPh*CosDPh;
+				}
 
 				double ReA = NormConst*CosPh, ImA = NormConst*SinPh;
-				//SetupProperPolariz(ReA, ImA, tRadX, tRadZ);
 				SetupProperPolariz(ReA, ImA, x, z, tRadX, tRadZ);
 
 				tRadX += 2; tRadZ += 2;
-				en += RadAccessData.eStep;
 			}
 			x += RadAccessData.xStep;
 		}
-		z += RadAccessData.zStep;
 	}
 	return 0;
 }
@@ -135,15 +159,23 @@ void srTIsotrSrc::ComputeElectricField(srTSRWRadStructAccessData &wfr) //, doubl
 
 	double R0e2 = R0*R0;
 
-	float* tRadX = wfr.pBaseRadX;
-	float* tRadZ = wfr.pBaseRadZ;
+	long nx = wfr.nx, nz = wfr.nz, ne = wfr.ne;
+	double dWaveNum = multWaveNum*wfr.eStep;
 
-	double z = wfr.zStart - z0;
-	for(int iz=0; iz<wfr.nz; iz++)
+#ifdef _WITH_OMP
+	#pragma omp parallel for schedule(static)
+#endif
+	for(long iz=0; iz<nz; iz++)
 	{
+		double z = wfr.zStart + iz*wfr.zStep - z0;
 		double ze2 = z*z;
+
+		long long ofst = (((long long)iz)*((long long)nx)*((long long)ne)) << 1;
+		float* tRadX = wfr.pBaseRadX + ofst;
+		float* tRadZ = wfr.pBaseRadZ + ofst;
+
 		double x = wfr.xStart - x0;
-		for(int ix=0; ix<wfr.nx; ix++)
+		for(long ix=0; ix<nx; ix++)
 		{
 			double xe2 = x*x;
 			double curRe2 = R0e2 + xe2 + ze2;
@@ -151,23 +183,39 @@ void srTIsotrSrc::ComputeElectricField(srTSRWRadStructAccessData &wfr) //, doubl
 			double sqrt_curR = sqrt(curR); //curRe2^(1/4)
 			double multElFld = constElFld*sqrt_curR/curRe2;
 
-			double phEn = wfr.eStart;
-			for(int ie=0; ie<wfr.ne; ie++)
+			//Phase (waveNum*curR) is linear in photon energy: it is advanced by a constant rotation and re-evaluated directly every m_nPhaseRecurSteps steps
+			double cosDPh = 1., sinDPh = 0.;
+			if(ne > 1)
+			{
+				double dPhase = dWaveNum*curR;
+				dPhase -= twoPi*((long long)(dPhase*invTwoPi));
+				cosDPh = cos(dPhase); sinDPh = sin(dPhase);
+			}
+
+			double cosPh = 1., sinPh = 0.;
+			for(long ie=0; ie<ne; ie++)
 			{
-				double waveNum = multWaveNum*phEn;
-				double phase = waveNum*curR;
-				phase -= twoPi*((long long)(phase*invTwoPi));
-				double cosPh = cos(phase), sinPh = sin(phase);
+				if((ie % m_nPhaseRecurSteps) == 0)
+				{
+					double phEn = wfr.eStart + ie*wfr.eStep;
+					double phase = multWaveNum*phEn*curR;
+					phase -= twoPi*((long long)(phase*invTwoPi));
+					cosPh = cos(phase); sinPh = sin(phase);
+				}
+				else
+				{
+					double cosPhPrev = cosPh;
+					cosPh = cosPhPrev*cosDPh - sinPh*sinDPh;
+					sinPh = cosPhPrev*sinDPh + sinPh*cosDPh;
+				}
 
 				double reE = multElFld*cosPh, imE = multElFld*sinPh;
 				SetupProperPolariz(reE, imE, x, z, tRadX, tRadZ);
 
 				tRadX += 2; tRadZ += 2;
-				phEn += wfr.eStep;
 			}
 			x += wfr.xStep;
 		}
-		z += wfr.zStep;
 	}
 }
 
@@ -28,6 +28,11 @@ class srTIsotrSrc {
 	double LongDist;
 	double NormConstElField;
 
+	//Max. number of successive photon energy points for which the spherical-wave phase factor is obtained by complex rotation
+	//(rather than by direct cos/sin evaluation); the rotation accumulates at most m_nPhaseRecurSteps*eStep/e times the rounding error
+	//of the directly evaluated phase (~1e-16*k*R rad), so for eStep < e/16 the result agrees with direct evaluation within that rounding error
+	static const int m_nPhaseRecurSteps = 16;
+
 public:
 
 	srTEbmDat EbmDat;
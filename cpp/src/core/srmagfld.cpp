@@ -1415,7 +1415,7 @@ void srTMagFldCont::DetermineLongStartAndEndPos()
 
 //*************************************************************************
 
-void srTMagFld3d::tabInterpB(srTMagFldCont& magCont, double arPrecPar[6], double* arPar1, double* arPar2, double* arCoefBx, double* arCoefBy) //OC02112017
+void srTMagFld3d::tabInterpB(srTMagFldCont& magCont, double arPrecPar[6], double* arPar1, double* arPar2, double* arCoefBx, double* arCoefBy, srTMagFldInterpPrep* pPrep) //OC02112017
 //void srTMagFld3d::tabInterpB(srTMagFldCont& magCont, double* arPrecPar, double* arPar1, double* arPar2, double* arCoefBx, double* arCoefBy)
 {
 	//if((arPrecPar == 0) || (arPar1 == 0)) return; //throw exception?
@@ -1438,48 +1438,10 @@ void srTMagFld3d::tabInterpB(srTMagFldCont& magCont, double arPrecPar[6], double
 	if(arPar2 == 0) dimInterp = 1;
 
 	int nMag = magCont.size();
-	if(nMag == 1)
-	{//Just copy the only available data for one phase and gap to the resulting array
-
-		TVector3d vP, vB;
-		double *tBx = BxArr, *tBy = ByArr, *tBz = BzArr;
-		double z = zStart; //+ mCenP.z; //OC170615
-
-		for(int iz=0; iz<nz; iz++)
-		{
-			if(zArr != 0) z = zArr[iz]; //+ mCenP.z; //OC170615
-			double y = yStart; //+ mCenP.y; //OC170615
-			
-			for(int iy=0; iy<ny; iy++)
-			{
-				if(yArr != 0) y = yArr[iy]; //+ mCenP.y; //OC170615
-				double x = xStart; //+ mCenP.x; //OC170615
-			
-				for(int ix=0; ix<nx; ix++)
-				{
-					if(xArr != 0) x = xArr[ix]; //+ mCenP.x; //OC170615
-					vP.x = x; vP.y = y; vP.z = z;
-					vP = mTrans.TrPoint(vP); //OC170615
-
-					vB.x = vB.y = vB.z = 0.;
-					magCont.compB_i(vP, vB, 0);
-					vB = mTrans.TrVectField_inv(vB); //OC170615??
-					if(arCoefBx != 0) vB.x *= (*arCoefBx);
-					if(arCoefBy != 0) vB.y *= (*arCoefBy);
-
-					if(BxArr != 0) *(tBx++) = vB.x;
-					if(ByArr != 0) *(tBy++) = vB.y;
-					if(BzArr != 0) *(tBz++) = vB.z;
-					x += xStep;
-				}
-				y += yStep;
-			}
-			z += zStep;
-		}
-	}
-
 	int nMag_mi_1 = nMag - 1;
 	if(ordInterp > nMag_mi_1) ordInterp = nMag_mi_1;
+	if(nMag == 1) dimInterp = 0; //just copy the only available data for one phase and gap to the resulting array
+
 
 	int arIndForInterp2d[12], nIndForInterp2d=0;
 	double relPar1, relPar2;
@@ -1641,152 +1603,240 @@ void srTMagFld3d::tabInterpB(srTMagFldCont& magCont, double arPrecPar[6], double
 		}
 	}
 
-	TVector3d vP, vB, vBm1, vB0, vBp1, vBp2; //for 1D interpolation (vs gap)
-	//TVector3d vB_0_m1, vB_m1_0, vB_0_0, vB_p1_0, vB_0_p1, vB_p1_p1; //for 2D interpolation (vs gap and phase)
-	//TVector3d ar_vB[5]; //for 2D interpolation (vs gap and phase)
-	double arInterpBx[5], arInterpBy[5], arInterpBz[5]; //for 2D interpolation (vs gap and phase)
+	//Container members involved in the interpolation (the same for all nodes)
+	int arIndMag[12], nIndMag = 0;
+	if(dimInterp == 0) arIndMag[nIndMag++] = 0;
+	else if(dimInterp == 1)
+	{
+		arIndMag[nIndMag++] = i0; arIndMag[nIndMag++] = ip1;
+		if(ordInterp > 1) arIndMag[nIndMag++] = im1;
+		if(ordInterp > 2) arIndMag[nIndMag++] = ip2;
+	}
+	else if(dimInterp == 2)
+	{
+		for(int i=0; i<nIndForInterp2d; i++) arIndMag[nIndMag++] = arIndForInterp2d[i];
+	}
+
+	//Fields of these members resampled on the mesh in advance (if the interpolation is prepared)
+	const double *arResB[12];
+	for(int i=0; i<nIndMag; i++) arResB[i] = (pPrep != 0)? pPrep->GetResB(*this, magCont, arIndMag[i]) : 0;
+
+	double *arX = new double[nx], *arY = new double[ny], *arZ = new double[nz];
+	compMeshCoord(arX, arY, arZ);
 
-	double *tBx = BxArr, *tBy = ByArr, *tBz = BzArr;
-	double z = zStart; //+ mCenP.z; //OC170615
-	for(int iz=0; iz<nz; iz++)
+	//Rows of the mesh (vs x) are processed in parallel; each node only depends on its coordinates and on the fields of the members at this node
+	long long nRows = ((long long)ny)*((long long)nz);
+#ifdef _WITH_OMP
+	#pragma omp parallel for schedule(dynamic, 16) if(nRows > 1)
+#endif
+	for(long long iRow=0; iRow<nRows; iRow++)
 	{
-		if(zArr != 0) z = zArr[iz]; //+ mCenP.z; //OC170615
-		//vP.z = z;
-		double y = yStart; //+ mCenP.y; //OC170615
-		for(int iy=0; iy<ny; iy++)
+		int iz = (int)(iRow/ny);
+		int iy = (int)(iRow - ((long long)iz)*ny);
+		double y = arY[iy], z = arZ[iz];
+
+		TVector3d vP, vB(0.,0.,0.), arB[12];
+		double arInterpBx[12], arInterpBy[12], arInterpBz[12]; //for 2D interpolation (vs gap and phase)
+
+		long long ofst = iRow*nx;
+		for(int ix=0; ix<nx; ix++)
 		{
-			if(yArr != 0) y = yArr[iy]; //+ mCenP.y; //OC170615
-			//vP.y = y;
-			double x = xStart; //+ mCenP.x; //OC170615
-			for(int ix=0; ix<nx; ix++)
+			long long ofstNode = ofst + ix;
+			if(pPrep == 0)
 			{
-				if(xArr != 0) x = xArr[ix]; //+ mCenP.x; //OC170615
-				//vP.x = x;
-				vP.x = x; vP.y = y; vP.z = z;
+				vP.x = arX[ix]; vP.y = y; vP.z = z;
 				vP = mTrans.TrPoint(vP); //OC170615
+			}
 
-				if(dimInterp == 1)
+			for(int i=0; i<nIndMag; i++)
+			{
+				TVector3d &vAuxB = arB[i];
+				int iMag = arIndMag[i];
+				if(arResB[i] != 0)
 				{
-					vB0.x = vB0.y = vB0.z = 0.;
-					magCont.compB_i(vP, vB0, i0);
-					vB0 = mTrans.TrVectField_inv(vB0); //OC170615??
-					if(arCoefBx != 0) vB0.x *= arCoefBx[i0];
-					if(arCoefBy != 0) vB0.y *= arCoefBy[i0];
-					//if(arCoefBz != 0) vB0.z *= arCoefBz[i0]; //to add?
-
-					vBp1.x = vBp1.y = vBp1.z = 0.;
-					magCont.compB_i(vP, vBp1, ip1);
-					vBp1 = mTrans.TrVectField_inv(vBp1); //OC170615??
-					if(arCoefBx != 0) vBp1.x *= arCoefBx[ip1];
-					if(arCoefBy != 0) vBp1.y *= arCoefBy[ip1];
-					//if(arCoefBz != 0) vBp1.z *= arCoefBz[ip1]; //to add?
-
-					if(ordInterp > 1)
-					{
-						vBm1.x = vBm1.y = vBm1.z = 0.;
-						magCont.compB_i(vP, vBm1, im1);
-						vBm1 = mTrans.TrVectField_inv(vBm1); //OC170615??
-						if(arCoefBx != 0) vBm1.x *= arCoefBx[im1];
-						if(arCoefBy != 0) vBm1.y *= arCoefBy[im1];
-						//if(arCoefBz != 0) vBm1.z *= arCoefBz[im1]; //to add?
-
-						if(ordInterp > 2)
-						{
-							vBp2.x = vBp2.y = vBp2.z = 0.;
-							magCont.compB_i(vP, vBp2, ip2);
-							vBp2 = mTrans.TrVectField_inv(vBp2); //OC170615??
-							if(arCoefBx != 0) vBp2.x *= arCoefBx[ip2];
-							if(arCoefBy != 0) vBp2.y *= arCoefBy[ip2];
-							//if(arCoefBz != 0) vBp2.z *= arCoefBz[ip2]; //to add?
-						}
-					}
+					const double *pResB = arResB[i] + ofstNode*3;
+					vAuxB.x = pResB[0]; vAuxB.y = pResB[1]; vAuxB.z = pResB[2];
+				}
+				else
+				{
+					vAuxB.x = vAuxB.y = vAuxB.z = 0.;
+					magCont.compB_i(vP, vAuxB, iMag);
+				}
+				if(dimInterp < 2) vAuxB = mTrans.TrVectField_inv(vAuxB); //OC170615??
+				if(arCoefBx != 0) vAuxB.x *= arCoefBx[iMag];
+				if(arCoefBy != 0) vAuxB.y *= arCoefBy[iMag];
+				//if(arCoefBz != 0) vAuxB.z *= arCoefBz[iMag]; //to add?
+			}
 
-					if(ordInterp == 1)
-					{
-						if(BxArr != 0) vB.x = CGenMathInterp::Interp1dLinRel(relPar1, vB0.x, vBp1.x);
-						if(ByArr != 0) vB.y = CGenMathInterp::Interp1dLinRel(relPar1, vB0.y, vBp1.y);
-						if(BzArr != 0) vB.z = CGenMathInterp::Interp1dLinRel(relPar1, vB0.z, vBp1.z);
-					}
-					else if(ordInterp == 2)
+			if(dimInterp == 0) vB = arB[0];
+			else if(dimInterp == 1)
+			{
+				TVector3d &vB0 = arB[0], &vBp1 = arB[1], &vBm1 = arB[2], &vBp2 = arB[3];
+				if(ordInterp == 1)
+				{
+					if(BxArr != 0) vB.x = CGenMathInterp::Interp1dLinRel(relPar1, vB0.x, vBp1.x);
+					if(ByArr != 0) vB.y = CGenMathInterp::Interp1dLinRel(relPar1, vB0.y, vBp1.y);
+					if(BzArr != 0) vB.z = CGenMathInterp::Interp1dLinRel(relPar1, vB0.z, vBp1.z);
+				}
+				else if(ordInterp == 2)
+				{
+					if(BxArr != 0) vB.x = CGenMathInterp::Interp1dQuadVarRel(relPar1, relPar1_hmdhp1, vBm1.x, vB0.x, vBp1.x);
+					if(ByArr != 0) vB.y = CGenMathInterp::Interp1dQuadVarRel(relPar1, relPar1_hmdhp1, vBm1.y, vB0.y, vBp1.y);
+					if(BzArr != 0) vB.z = CGenMathInterp::Interp1dQuadVarRel(relPar1, relPar1_hmdhp1, vBm1.z, vB0.z, vBp1.z);
+				}
+				else if(ordInterp == 3)
+				{
+					if(BxArr != 0) vB.x = CGenMathInterp::Interp1dCubVarRel(relPar1, relPar1_hmdhp1, relPar1_hp2dhp1, vBm1.x, vB0.x, vBp1.x, vBp2.x);
+					if(ByArr != 0) vB.y = CGenMathInterp::Interp1dCubVarRel(relPar1, relPar1_hmdhp1, relPar1_hp2dhp1, vBm1.y, vB0.y, vBp1.y, vBp2.y);
+					if(BzArr != 0) vB.z = CGenMathInterp::Interp1dCubVarRel(relPar1, relPar1_hmdhp1, relPar1_hp2dhp1, vBm1.z, vB0.z, vBp1.z, vBp2.z);
+				}
+			}
+			else if(dimInterp == 2)
+			{
+				for(int i=0; i<nIndMag; i++)
+				{
+					arInterpBx[i] = arB[i].x; arInterpBy[i] = arB[i].y; arInterpBz[i] = arB[i].z;
+				}
+
+				if(ordInterp == 1)
+				{
+					if(meshIsRect)
 					{
-						if(BxArr != 0) vB.x = CGenMathInterp::Interp1dQuadVarRel(relPar1, relPar1_hmdhp1, vBm1.x, vB0.x, vBp1.x);
-						if(ByArr != 0) vB.y = CGenMathInterp::Interp1dQuadVarRel(relPar1, relPar1_hmdhp1, vBm1.y, vB0.y, vBp1.y);
-						if(BzArr != 0) vB.z = CGenMathInterp::Interp1dQuadVarRel(relPar1, relPar1_hmdhp1, vBm1.z, vB0.z, vBp1.z);
+						if(BxArr != 0) vB.x = CGenMathInterp::Interp2dBiLinRec(relPar1, relPar2, arInterpBx);
+						if(ByArr != 0) vB.y = CGenMathInterp::Interp2dBiLinRec(relPar1, relPar2, arInterpBy);
+						if(BzArr != 0) vB.z = CGenMathInterp::Interp2dBiLinRec(relPar1, relPar2, arInterpBz);
 					}
-					else if(ordInterp == 3)
+					else
 					{
-						if(BxArr != 0) vB.x = CGenMathInterp::Interp1dCubVarRel(relPar1, relPar1_hmdhp1, relPar1_hp2dhp1, vBm1.x, vB0.x, vBp1.x, vBp2.x);
-						if(ByArr != 0) vB.y = CGenMathInterp::Interp1dCubVarRel(relPar1, relPar1_hmdhp1, relPar1_hp2dhp1, vBm1.y, vB0.y, vBp1.y, vBp2.y);
-						if(BzArr != 0) vB.z = CGenMathInterp::Interp1dCubVarRel(relPar1, relPar1_hmdhp1, relPar1_hp2dhp1, vBm1.z, vB0.z, vBp1.z, vBp2.z);
+						if(BxArr != 0) vB.x = CGenMathInterp::Interp2dBiLinVar(difPar1, difPar2, arDifPar1Par2, arInterpBx);
+						if(ByArr != 0) vB.y = CGenMathInterp::Interp2dBiLinVar(difPar1, difPar2, arDifPar1Par2, arInterpBy);
+						if(BzArr != 0) vB.z = CGenMathInterp::Interp2dBiLinVar(difPar1, difPar2, arDifPar1Par2, arInterpBz);
 					}
 				}
-				else if(dimInterp == 2)
+				else if(ordInterp == 2)
 				{
-					double *t_arInterpBx = arInterpBx, *t_arInterpBy = arInterpBy, *t_arInterpBz = arInterpBz;
-					int *pIndInterp = arIndForInterp2d;
-					for(int i=0; i<nIndForInterp2d; i++)
-					{
-						TVector3d vAuxB(0.,0.,0.);
-						magCont.compB_i(vP, vAuxB, *pIndInterp);
-						if(arCoefBx != 0) vAuxB.x *= arCoefBx[*pIndInterp];
-						if(arCoefBy != 0) vAuxB.y *= arCoefBy[*pIndInterp];
-						*(t_arInterpBx++) = vAuxB.x;
-						*(t_arInterpBy++) = vAuxB.y;
-						*(t_arInterpBz++) = vAuxB.z;
-						pIndInterp++;
-					}
-
-					if(ordInterp == 1)
-					{
-						if(meshIsRect)
-						{
-							if(BxArr != 0) vB.x = CGenMathInterp::Interp2dBiLinRec(relPar1, relPar2, arInterpBx);
-							if(ByArr != 0) vB.y = CGenMathInterp::Interp2dBiLinRec(relPar1, relPar2, arInterpBy);
-							if(BzArr != 0) vB.z = CGenMathInterp::Interp2dBiLinRec(relPar1, relPar2, arInterpBz);
-						}
-						else
-						{
-							if(BxArr != 0) vB.x = CGenMathInterp::Interp2dBiLinVar(difPar1, difPar2, arDifPar1Par2, arInterpBx);
-							if(ByArr != 0) vB.y = CGenMathInterp::Interp2dBiLinVar(difPar1, difPar2, arDifPar1Par2, arInterpBy);
-							if(BzArr != 0) vB.z = CGenMathInterp::Interp2dBiLinVar(difPar1, difPar2, arDifPar1Par2, arInterpBz);
-						}
+					if(meshIsRect)
+					{//Args for CGenMathInterp::Interp2dBiQuad5RecVar(double x, double y, double* arXY, double* arF)
+						if(BxArr != 0) vB.x = CGenMathInterp::Interp2dBiQuad5RecVar(difPar1, difPar2, arDifPar1Par2, arInterpBx);
+						if(ByArr != 0) vB.y = CGenMathInterp::Interp2dBiQuad5RecVar(difPar1, difPar2, arDifPar1Par2, arInterpBy);
+						if(BzArr != 0) vB.z = CGenMathInterp::Interp2dBiQuad5RecVar(difPar1, difPar2, arDifPar1Par2, arInterpBz);
 					}
-					else if(ordInterp == 2)
-					{
-						if(meshIsRect)
-						{//Args for CGenMathInterp::Interp2dBiQuad5RecVar(double x, double y, double* arXY, double* arF)
-							if(BxArr != 0) vB.x = CGenMathInterp::Interp2dBiQuad5RecVar(difPar1, difPar2, arDifPar1Par2, arInterpBx);
-							if(ByArr != 0) vB.y = CGenMathInterp::Interp2dBiQuad5RecVar(difPar1, difPar2, arDifPar1Par2, arInterpBy);
-							if(BzArr != 0) vB.z = CGenMathInterp::Interp2dBiQuad5RecVar(difPar1, difPar2, arDifPar1Par2, arInterpBz);
-						}
-						else
-						{//Args for CGenMathInterp::Interp2dBiQuad5Var(double x, double y, double* arXY, double* arF)
-							if(BxArr != 0) vB.x = CGenMathInterp::Interp2dBiQuad5Var(difPar1, difPar2, arDifPar1Par2, arInterpBx);
-							if(ByArr != 0) vB.y = CGenMathInterp::Interp2dBiQuad5Var(difPar1, difPar2, arDifPar1Par2, arInterpBy);
-							if(BzArr != 0) vB.z = CGenMathInterp::Interp2dBiQuad5Var(difPar1, difPar2, arDifPar1Par2, arInterpBz);
-						}
+					else
+					{//Args for CGenMathInterp::Interp2dBiQuad5Var(double x, double y, double* arXY, double* arF)
+						if(BxArr != 0) vB.x = CGenMathInterp::Interp2dBiQuad5Var(difPar1, difPar2, arDifPar1Par2, arInterpBx);
+						if(ByArr != 0) vB.y = CGenMathInterp::Interp2dBiQuad5Var(difPar1, difPar2, arDifPar1Par2, arInterpBy);
+						if(BzArr != 0) vB.z = CGenMathInterp::Interp2dBiQuad5Var(difPar1, difPar2, arDifPar1Par2, arInterpBz);
 					}
-					else if(ordInterp == 3)
-					{
-						if(meshIsRect)
-						{//Args for CGenMathInterp::Interp2dBiCubic12pRecVar(double x, double y, double* arXY, double* arF)
-							if(BxArr != 0) vB.x = CGenMathInterp::Interp2dBiCubic12pRecVar(difPar1, difPar2, arDifPar1Par2, arInterpBx);
-							if(ByArr != 0) vB.y = CGenMathInterp::Interp2dBiCubic12pRecVar(difPar1, difPar2, arDifPar1Par2, arInterpBy);
-							if(BzArr != 0) vB.z = CGenMathInterp::Interp2dBiCubic12pRecVar(difPar1, difPar2, arDifPar1Par2, arInterpBz);
-						}
+				}
+				else if(ordInterp == 3)
+				{
+					if(meshIsRect)
+					{//Args for CGenMathInterp::Interp2dBiCubic12pRecVar(double x, double y, double* arXY, double* arF)
+						if(BxArr != 0) vB.x = CGenMathInterp::Interp2dBiCubic12pRecVar(difPar1, difPar2, arDifPar1Par2, arInterpBx);
+						if(ByArr != 0) vB.y = CGenMathInterp::Interp2dBiCubic12pRecVar(difPar1, difPar2, arDifPar1Par2, arInterpBy);
+						if(BzArr != 0) vB.z = CGenMathInterp::Interp2dBiCubic12pRecVar(difPar1, difPar2, arDifPar1Par2, arInterpBz);
 					}
 				}
+			}
 
-				if(BxArr != 0) *(tBx++) = vB.x;
-				if(ByArr != 0) *(tBy++) = vB.y;
-				if(BzArr != 0) *(tBz++) = vB.z;
+			if(BxArr != 0) BxArr[ofstNode] = vB.x;
+			if(ByArr != 0) ByArr[ofstNode] = vB.y;
+			if(BzArr != 0) BzArr[ofstNode] = vB.z;
+		}
+	}
+	delete[] arX; delete[] arY; delete[] arZ;
+}
 
-				x += xStep;
-			}
-			y += yStep;
+//*************************************************************************
+
+void srTMagFld3d::tabB_i(srTMagFldCont& magCont, int iMag, double* arB)
+{//Field of one container member on the mesh, without any transformation (Bx, By, Bz at each node)
+	double *arX = new double[nx], *arY = new double[ny], *arZ = new double[nz];
+	compMeshCoord(arX, arY, arZ);
+
+	long long nRows = ((long long)ny)*((long long)nz);
+#ifdef _WITH_OMP
+	#pragma omp parallel for schedule(dynamic, 16) if(nRows > 1)
+#endif
+	for(long long iRow=0; iRow<nRows; iRow++)
+	{
+		int iz = (int)(iRow/ny);
+		int iy = (int)(iRow - ((long long)iz)*ny);
+		double *t_arB = arB + iRow*nx*3;
+		for(int ix=0; ix<nx; ix++)
+		{
+			TVector3d vP(arX[ix], arY[iy], arZ[iz]), vB(0.,0.,0.);
+			vP = mTrans.TrPoint(vP);
+			magCont.compB_i(vP, vB, iMag);
+			*(t_arB++) = vB.x; *(t_arB++) = vB.y; *(t_arB++) = vB.z;
 		}
-		z += zStep;
 	}
+	delete[] arX; delete[] arY; delete[] arZ;
+}
+
+//*************************************************************************
+
+std::vector<CSmartPtr<srTMagFldInterpPrep> > srTMagFldInterpPrep::m_vReg;
+std::mutex srTMagFldInterpPrep::m_mtxReg;
+
+//*************************************************************************
+
+const double* srTMagFldInterpPrep::GetResB(srTMagFld3d& fld, srTMagFldCont& magCont, int iMag)
+{//Resamples the field of a member when it is used for the first time; the data is not modified afterwards, so it can be read without locking
+	if((iMag < 0) || (iMag >= (int)m_vResB.size())) return 0;
+
+	std::lock_guard<std::mutex> lock(m_mtx);
+	std::vector<double> &vResB = m_vResB[iMag];
+	if(vResB.empty())
+	{
+		long long np = fld.GetNumMeshNodes();
+		std::vector<double> vAuxB;
+		try { vAuxB.resize(np*3);}
+		catch(std::bad_alloc&) { throw MEMORY_ALLOCATION_FAILURE;}
+		fld.tabB_i(magCont, iMag, &(vAuxB[0]));
+		vResB.swap(vAuxB);
+	}
+	return &(vResB[0]);
+}
+
+//*************************************************************************
+
+void srTMagFldInterpPrep::Register(const CSmartPtr<srTMagFldInterpPrep>& hPrep)
+{
+	std::lock_guard<std::mutex> lock(m_mtxReg);
+	m_vReg.push_back(hPrep);
+}
+
+//*************************************************************************
+
+void srTMagFldInterpPrep::Unregister(srTMagFldInterpPrep* pPrep)
+{//The state itself is deleted when it is not used by any calculation any more
+	std::lock_guard<std::mutex> lock(m_mtxReg);
+	for(std::vector<CSmartPtr<srTMagFldInterpPrep> >::iterator it = m_vReg.begin(); it != m_vReg.end(); ++it)
+	{
+		if(it->ptr() == pPrep) { m_vReg.erase(it); return;}
+	}
+}
+
+//*************************************************************************
+
+void srTMagFldInterpPrep::Clear()
+{//Prepared states are no longer found; each one is deleted with the last handle (or calculation) using it
+	std::lock_guard<std::mutex> lock(m_mtxReg);
+	m_vReg.clear();
+}
+
+//*************************************************************************
+
+CSmartPtr<srTMagFldInterpPrep> srTMagFldInterpPrep::Find(const std::vector<double>& vKeyPar, const std::vector<const void*>& vKeyPtr)
+{
+	std::lock_guard<std::mutex> lock(m_mtxReg);
+	for(std::vector<CSmartPtr<srTMagFldInterpPrep> >::iterator it = m_vReg.begin(); it != m_vReg.end(); ++it)
+	{
+		srTMagFldInterpPrep *pPrep = it->ptr();
+		if((pPrep->m_vKeyPar == vKeyPar) && (pPrep->m_vKeyPtr == vKeyPtr)) return *it;
+	}
+	return CSmartPtr<srTMagFldInterpPrep>();
 }
 
 //*************************************************************************
@@ -35,6 +35,7 @@ class srTTrjDat;
 class srTTrjDat3d;
 class srTMagFieldPeriodic;
 class srTMagFldCont;
+class srTMagFldInterpPrep;
 struct srTWigComSASE;
 
 struct SRWLStructMagneticFieldUndulator;
@@ -1166,40 +1167,45 @@ public:
 				long long ofst0 = pCurPairInd->first + (pCurPairInd->second)*perY;
 
 				CGenMathInterp *curSplineDataB = 0;
-				it = mAuxSplineDataB.find(*pCurPairInd);
-				if(it == mAuxSplineDataB.end())
+#ifdef _WITH_OMP
+				#pragma omp critical(srTMagFld3d_AuxSplineDataB) //spline data is set up on demand, while compB may be called from several threads (e.g. by tabulateB)
+#endif
 				{
-					curSplineDataB = new CGenMathInterp[3];
-					if(BxArr != 0)
+					it = mAuxSplineDataB.find(*pCurPairInd);
+					if(it == mAuxSplineDataB.end())
 					{
-						if(arAuxBx_vs_Z == 0) arAuxBx_vs_Z = new double[nz];
-						double *tBx = arAuxBx_vs_Z, *tBxOrig = BxArr + ofst0;
-						for(int iz=0; iz<nz; iz++) { *(tBx++) = *tBxOrig; tBxOrig += perZ;}
+						curSplineDataB = new CGenMathInterp[3];
+						if(BxArr != 0)
+						{
+							if(arAuxBx_vs_Z == 0) arAuxBx_vs_Z = new double[nz];
+							double *tBx = arAuxBx_vs_Z, *tBxOrig = BxArr + ofst0;
+							for(int iz=0; iz<nz; iz++) { *(tBx++) = *tBxOrig; tBxOrig += perZ;}
 
-						if(zArr == 0) curSplineDataB->InitCubicSplineU(zStart, zStep, arAuxBx_vs_Z, nz);
-						else curSplineDataB->InitCubicSpline(zArr, arAuxBx_vs_Z, nz);
-					}
-					if(ByArr != 0)
-					{
-						if(arAuxBy_vs_Z == 0) arAuxBy_vs_Z = new double[nz];
-						double *tBy = arAuxBy_vs_Z, *tByOrig = ByArr + ofst0;
-						for(int iz=0; iz<nz; iz++) { *(tBy++) = *tByOrig; tByOrig += perZ;}
+							if(zArr == 0) curSplineDataB->InitCubicSplineU(zStart, zStep, arAuxBx_vs_Z, nz);
+							else curSplineDataB->InitCubicSpline(zArr, arAuxBx_vs_Z, nz);
+						}
+						if(ByArr != 0)
+						{
+							if(arAuxBy_vs_Z == 0) arAuxBy_vs_Z = new double[nz];
+							double *tBy = arAuxBy_vs_Z, *tByOrig = ByArr + ofst0;
+							for(int iz=0; iz<nz; iz++) { *(tBy++) = *tByOrig; tByOrig += perZ;}
 
-						if(zArr == 0) (curSplineDataB + 1)->InitCubicSplineU(zStart, zStep, arAuxBy_vs_Z, nz);
-						else (curSplineDataB + 1)->InitCubicSpline(zArr, arAuxBy_vs_Z, nz);
-					}
-					if(BzArr != 0)
-					{
-						if(arAuxBz_vs_Z == 0) arAuxBz_vs_Z = new double[nz];
-						double *tBz = arAuxBz_vs_Z, *tBzOrig = BzArr + ofst0;
-						for(int iz=0; iz<nz; iz++) { *(tBz++) = *tBzOrig; tBzOrig += perZ;}
+							if(zArr == 0) (curSplineDataB + 1)->InitCubicSplineU(zStart, zStep, arAuxBy_vs_Z, nz);
+							else (curSplineDataB + 1)->InitCubicSpline(zArr, arAuxBy_vs_Z, nz);
+						}
+						if(BzArr != 0)
+						{
+							if(arAuxBz_vs_Z == 0) arAuxBz_vs_Z = new double[nz];
+							double *tBz = arAuxBz_vs_Z, *tBzOrig = BzArr + ofst0;
+							for(int iz=0; iz<nz; iz++) { *(tBz++) = *tBzOrig; tBzOrig += perZ;}
 
-						if(zArr == 0) (curSplineDataB + 2)->InitCubicSplineU(zStart, zStep, arAuxBz_vs_Z, nz);
-						else (curSplineDataB + 2)->InitCubicSpline(zArr, arAuxBy_vs_Z, nz);
+							if(zArr == 0) (curSplineDataB + 2)->InitCubicSplineU(zStart, zStep, arAuxBz_vs_Z, nz);
+							else (curSplineDataB + 2)->InitCubicSpline(zArr, arAuxBy_vs_Z, nz);
+						}
+						mAuxSplineDataB[*pCurPairInd] = curSplineDataB;
 					}
-					mAuxSplineDataB[*pCurPairInd] = curSplineDataB;
+					else curSplineDataB = it->second;
 				}
-				else curSplineDataB = it->second;
 
 				if(BxArr != 0)
 				{
@@ -1231,45 +1237,53 @@ public:
 	}
 
 	void tabulateB(srTMagElem* pMagElem)
-	{
+	{//Rows of the mesh (vs x) are computed in parallel; each node only depends on its coordinates, so the result does not depend on number of threads
 		if(pMagElem == 0) return;
 
-		TVector3d vP, vB;
-		double *tBx = BxArr, *tBy = ByArr, *tBz = BzArr;
-		double z = zStart; //+ mCenP.z; //OC160615
-		for(int iz=0; iz<nz; iz++)
+		double *arX = new double[nx], *arY = new double[ny], *arZ = new double[nz];
+		compMeshCoord(arX, arY, arZ);
+
+		long long nRows = ((long long)ny)*((long long)nz);
+#ifdef _WITH_OMP
+		#pragma omp parallel for schedule(dynamic, 16)
+#endif
+		for(long long iRow=0; iRow<nRows; iRow++)
 		{
-			if(zArr != 0) z = zArr[iz]; //+ mCenP.z; //OC160615
-			//vP.z = z;
-			double y = yStart; //+ mCenP.y; //OC160615
-			for(int iy=0; iy<ny; iy++)
+			long long iz = iRow/ny, iy = iRow - iz*ny;
+			long long ofst = iRow*nx;
+			double *tBx = (BxArr != 0)? (BxArr + ofst) : 0;
+			double *tBy = (ByArr != 0)? (ByArr + ofst) : 0;
+			double *tBz = (BzArr != 0)? (BzArr + ofst) : 0;
+
+			TVector3d vP, vB;
+			for(int ix=0; ix<nx; ix++)
 			{
-				if(yArr != 0) y = yArr[iy]; //+ mCenP.y; //OC160615
-				//vP.y = y;
-				double x = xStart; //+ mCenP.x; //OC160615
-				for(int ix=0; ix<nx; ix++)
-				{
-					if(xArr != 0) x = xArr[ix]; //+ mCenP.x; //OC160615
-					
-					vP.x = x; vP.y = y; vP.z = z; //OC160615
-					vP = mTrans.TrPoint(vP);
-					vB.x = vB.y = vB.z = 0.;
-					pMagElem->compB(vP, vB);
-					vB = mTrans.TrVectField_inv(vB); //OC170615??
-
-					if(BxArr != 0) *(tBx++) = vB.x;
-					if(ByArr != 0) *(tBy++) = vB.y;
-					if(BzArr != 0) *(tBz++) = vB.z;
-
-					x += xStep;
-				}
-				y += yStep;
+				vP.x = arX[ix]; vP.y = arY[iy]; vP.z = arZ[iz]; //OC160615
+				vP = mTrans.TrPoint(vP);
+				vB.x = vB.y = vB.z = 0.;
+				pMagElem->compB(vP, vB);
+				vB = mTrans.TrVectField_inv(vB); //OC170615??
+
+				if(tBx != 0) *(tBx++) = vB.x;
+				if(tBy != 0) *(tBy++) = vB.y;
+				if(tBz != 0) *(tBz++) = vB.z;
 			}
-			z += zStep;
 		}
+		delete[] arX; delete[] arY; delete[] arZ;
 	}
 
-	void tabInterpB(srTMagFldCont& magCont, double arPrecPar[6], double* arPar1, double* arPar2, double* arCoefBx, double* arCoefBy); //OC02112017
+	long long GetNumMeshNodes() { return ((long long)nx)*((long long)ny)*((long long)nz);}
+
+	void compMeshCoord(double* arX, double* arY, double* arZ)
+	{//Node coordinates are set up the same way as they used to be incremented over the mesh
+		double x = xStart, y = yStart, z = zStart; //+ mCenP; //OC160615
+		for(int ix=0; ix<nx; ix++) { arX[ix] = (xArr != 0)? xArr[ix] : x; x += xStep;}
+		for(int iy=0; iy<ny; iy++) { arY[iy] = (yArr != 0)? yArr[iy] : y; y += yStep;}
+		for(int iz=0; iz<nz; iz++) { arZ[iz] = (zArr != 0)? zArr[iz] : z; z += zStep;}
+	}
+
+	void tabB_i(srTMagFldCont& magCont, int iMag, double* arB);
+	void tabInterpB(srTMagFldCont& magCont, double arPrecPar[6], double* arPar1, double* arPar2, double* arCoefBx, double* arCoefBy, srTMagFldInterpPrep* pPrep =0); //OC02112017
 	//void tabInterpB(srTMagFldCont& magCont, double* arPrecPar, double* arPar1, double* arPar2, double* arCoefBx, double* arCoefBy);
 
 	//void DeallocAuxData() //virtual in srTMagElem
@@ -1734,4 +1748,40 @@ public:
 
 //*************************************************************************
 
+class srTMagFldInterpPrep {
+//Prepared state for interpolation of tabulated fields vs gap / phase (srTMagFld3d::tabInterpB):
+//fields of the container members, resampled on the mesh of the resulting field when they are first used.
+//The state is registered process-wide and found by its key (data pointers, data checksums and mesh parameters of the source fields and of the resulting field).
+
+	std::vector<std::vector<double> > m_vResB; //resampled fields (Bx, By, Bz at each node) of each container member
+	std::mutex m_mtx;
+
+	static std::vector<CSmartPtr<srTMagFldInterpPrep> > m_vReg;
+	static std::mutex m_mtxReg;
+
+public:
+
+	std::vector<double> m_vKeyPar;
+	std::vector<const void*> m_vKeyPtr;
+
+	srTMagFldInterpPrep(const std::vector<double>& vKeyPar, const std::vector<const void*>& vKeyPtr, int nMag)
+	{
+		m_vKeyPar = vKeyPar; m_vKeyPtr = vKeyPtr;
+		m_vResB.resize(nMag);
+	}
+
+	const double* GetResB(srTMagFld3d& fld, srTMagFldCont& magCont, int iMag);
+
+	static void Register(const CSmartPtr<srTMagFldInterpPrep>& hPrep);
+	static void Unregister(srTMagFldInterpPrep* pPrep);
+	static void Clear();
+	static CSmartPtr<srTMagFldInterpPrep> Find(const std::vector<double>& vKeyPar, const std::vector<const void*>& vKeyPtr);
+};
+
+struct SRWLStructMagFldInterpPrep { //prepared field interpolation (opaque in C API)
+	CSmartPtr<srTMagFldInterpPrep> hPrep;
+};
+
+//*************************************************************************
+
 #endif
@@ -14,6 +14,8 @@
 #include "srmatsta.h"
 #include "srradmnp.h"
 
+#include <vector>
+
 //*************************************************************************
 
 int srTAuxMatStat::FindSimplestStat(srTWaveAccessData& InWaveData, srTWaveAccessData& OutSpotInfo, double* arPar, int nPar) //OC29122018
@@ -187,6 +189,286 @@ int srTAuxMatStat::FindSimplestStat(srTWaveAccessData& InWaveData, srTWaveAccess
 //	return 0;
 //};
 
+//*************************************************************************
+//Basic statistics of a number of 1D or 2D distributions ("slices" interleaved in memory with period nSlices, e.g. vs photon energy, 
+//and "frames" stored one after another); nResFused values per distribution are placed to arRes (see FindStatFused)
+int srTAuxMatStat::FindStatMult(srTWaveAccessData& InWaveData, long long nSlices, long long nFrames, double* arRes, double* arPar, int nPar)
+{
+	int result;
+	if(result = ValidateSpotData(InWaveData)) return result;
+	if((arRes == 0) || (nSlices <= 0) || (nFrames <= 0)) return INCORRECT_ARGUMENTS;
+
+	double xStart = (InWaveData.DimStartValues)[0], xStep = (InWaveData.DimSteps)[0];
+	long long nx = (InWaveData.DimSizes)[0];
+	double yStart = 0., yStep = 0.;
+	long long ny = 1;
+	if(InWaveData.AmOfDims == 2)
+	{
+		yStart = (InWaveData.DimStartValues)[1]; yStep = (InWaveData.DimSteps)[1];
+		ny = (InWaveData.DimSizes)[1];
+	}
+	if((nx <= 0) || (ny <= 0)) return INCORRECT_ARGUMENTS;
+
+	long long nTotFrame = nx*ny*nSlices, nRec = nSlices*nFrames;
+	char cType = *(InWaveData.WaveType);
+	char *pData = InWaveData.pWaveData;
+	bool parRecs = (nRec > 1); //distributions are processed in parallel if there are several, otherwise rows of one distribution
+
+#ifdef _WITH_OMP
+	#pragma omp parallel for if(parRecs)
+#endif
+	for(long long iRec=0; iRec<nRec; iRec++)
+	{
+		long long iFr = iRec/nSlices, iSl = iRec - iFr*nSlices;
+		long long ofst = iFr*nTotFrame + iSl;
+		double *tRes = arRes + iRec*nResFused;
+		if(cType == 'f') FindStatFused((float*)pData + ofst, nSlices, xStart, xStep, nx, yStart, yStep, ny, tRes, arPar, nPar, !parRecs);
+		else FindStatFused((double*)pData + ofst, nSlices, xStart, xStep, nx, yStart, yStep, ny, tRes, arPar, nPar, !parRecs);
+	}
+	return 0;
+}
+
+//*************************************************************************
+//Peak, FWHM, FWFM, integral, centroid, RMS sizes and power limits of one 1D (ny = 1) or 2D distribution (values separated by per in memory), 
+//derived from sums and max. values of rows and columns accumulated in one sweep over the data:
+//arRes[0]: peak value, [1],[2]: x, y of peak, [3],[4]: x, y FWHM, [5],[6]: x, y FWFM (at fractions arPar[1], arPar[2] of peak),
+//arRes[7]: integral, [8],[9]: x, y centroid, [10],[11]: x, y RMS sizes, [12],[13]: x limits, [14],[15]: y limits (containing fraction arPar[3] of power);
+//arPar[0] = 1 means search of FWHM from peak (as in FindSimplestStat), otherwise from extremities
+template <class T> void srTAuxMatStat::FindStatFused(T* p0, long long per, double xStart, double xStep, long long nx, double yStart, double yStep, long long ny, double* arRes, double* arPar, int nPar, bool parRows)
+{
+	for(int i=0; i<nResFused; i++) arRes[i] = 0.;
+	if((p0 == 0) || (nx <= 0) || (ny <= 0)) return;
+	if(per < 1) per = 1;
+
+	//Column profiles are accumulated in blocks of rows, which are summed up in fixed order, so that the result does not depend on number of threads
+	long long nRowsPerBlock = (ny + 63)/64;
+	if(nRowsPerBlock < 16) nRowsPerBlock = 16;
+	long long nBlocks = (ny + nRowsPerBlock - 1)/nRowsPerBlock;
+
+	vector<double> vRowSum(ny), vColSum(nBlocks*nx);
+	vector<T> vRowMax(ny), vColMax(nBlocks*nx);
+	vector<long long> vRowArgMax(ny), vColArgMax(nBlocks*nx);
+
+#ifdef _WITH_OMP
+	#pragma omp parallel for if(parRows && (nBlocks > 1))
+#endif
+	for(long long ib=0; ib<nBlocks; ib++)
+	{
+		long long iyStart = ib*nRowsPerBlock, iyEnd = iyStart + nRowsPerBlock;
+		if(iyEnd > ny) iyEnd = ny;
+
+		double *arColSum = &vColSum[ib*nx];
+		T *arColMax = &vColMax[ib*nx];
+		long long *arColArgMax = &vColArgMax[ib*nx];
+		T *t = p0 + iyStart*nx*per;
+		for(long long ix=0; ix<nx; ix++)
+		{
+			arColSum[ix] = 0.; arColMax[ix] = *t; arColArgMax[ix] = iyStart;
+			t += per;
+		}
+
+		for(long long iy=iyStart; iy<iyEnd; iy++)
+		{
+			t = p0 + iy*nx*per;
+			double sumRow = 0.;
+			T vMaxRow = *t;
+			long long ixMaxRow = 0;
+			for(long long ix=0; ix<nx; ix++)
+			{
+				T v = *t; t += per;
+				sumRow += v;
+				arColSum[ix] += v;
+				if(vMaxRow < v) { vMaxRow = v; ixMaxRow = ix;}
+				if(arColMax[ix] < v) { arColMax[ix] = v; arColArgMax[ix] = iy;}
+			}
+			vRowSum[iy] = sumRow; vRowMax[iy] = vMaxRow; vRowArgMax[iy] = ixMaxRow;
+		}
+	}
+
+	double *arColSum = &vColSum[0];
+	T *arColMax = &vColMax[0];
+	long long *arColArgMax = &vColArgMax[0];
+	for(long long ib=1; ib<nBlocks; ib++)
+	{
+		long long ofstBl = ib*nx;
+		for(long long ix=0; ix<nx; ix++)
+		{
+			arColSum[ix] += vColSum[ofstBl + ix];
+			if(arColMax[ix] < vColMax[ofstBl + ix]) { arColMax[ix] = vColMax[ofstBl + ix]; arColArgMax[ix] = vColArgMax[ofstBl + ix];}
+		}
+	}
+
+	//Peak (first occurrence of max. value, as in FindMax1D)
+	long long iyMax = 0;
+	for(long long iy=1; iy<ny; iy++) if(vRowMax[iyMax] < vRowMax[iy]) iyMax = iy;
+	long long ixMax = vRowArgMax[iyMax];
+	double MaxVal = (double)vRowMax[iyMax];
+	arRes[0] = MaxVal;
+	arRes[1] = xStart + ixMax*xStep;
+	if(ny > 1) arRes[2] = yStart + iyMax*yStep;
+
+	//FWHM and FWFM
+	bool fromPeak = false;
+	if((arPar != 0) && (nPar > 0)) { if(arPar[0] == 1) fromPeak = true;}
+	double xFract = (nPar > 1)? arPar[1] : 0., yFract = (nPar > 2)? arPar[2] : 0.;
+	if(ny == 1)
+	{
+		arRes[3] = AuxCalcWidthFused1D(p0, per, nx, xStart, xStep, 0.5*MaxVal, ixMax, fromPeak);
+		if(xFract > 0.) arRes[5] = AuxCalcWidthFused1D(p0, per, nx, xStart, xStep, xFract*MaxVal, ixMax, fromPeak);
+	}
+	else
+	{
+		T *arRowMax = &vRowMax[0];
+		long long *arRowArgMax = &vRowArgMax[0];
+		double xAuxWidth, yAuxWidth;
+		AuxCalcWidthFused2D(p0, per, nx, ny, arColMax, arColArgMax, arRowMax, arRowArgMax, ixMax, iyMax, xStart, xStep, yStart, yStep, 0.5*MaxVal, fromPeak, arRes[3], arRes[4]);
+		if(xFract > 0.) AuxCalcWidthFused2D(p0, per, nx, ny, arColMax, arColArgMax, arRowMax, arRowArgMax, ixMax, iyMax, xStart, xStep, yStart, yStep, xFract*MaxVal, fromPeak, arRes[5], yAuxWidth);
+		if(yFract > 0.) AuxCalcWidthFused2D(p0, per, nx, ny, arColMax, arColArgMax, arRowMax, arRowArgMax, ixMax, iyMax, xStart, xStep, yStart, yStep, yFract*MaxVal, fromPeak, xAuxWidth, arRes[6]);
+	}
+
+	//Integral, centroid and RMS sizes from the projections
+	double sumTot = 0.;
+	for(long long iy=0; iy<ny; iy++) sumTot += vRowSum[iy];
+	arRes[7] = (ny > 1)? sumTot*xStep*yStep : sumTot*xStep;
+	if(sumTot == 0.) return;
+
+	double sumX = 0., sumY = 0.;
+	for(long long ix=0; ix<nx; ix++) sumX += arColSum[ix]*ix;
+	for(long long iy=0; iy<ny; iy++) sumY += vRowSum[iy]*iy;
+	double ixCen = sumX/sumTot, iyCen = sumY/sumTot;
+	double sumX2 = 0., sumY2 = 0.;
+	for(long long ix=0; ix<nx; ix++) { double dix = ix - ixCen; sumX2 += arColSum[ix]*dix*dix;}
+	for(long long iy=0; iy<ny; iy++) { double diy = iy - iyCen; sumY2 += vRowSum[iy]*diy*diy;}
+	double ix2 = sumX2/sumTot, iy2 = sumY2/sumTot;
+	arRes[8] = xStart + ixCen*xStep;
+	arRes[10] = (ix2 > 0.)? sqrt(ix2)*fabs(xStep) : 0.;
+	if(ny > 1)
+	{
+		arRes[9] = yStart + iyCen*yStep;
+		arRes[11] = (iy2 > 0.)? sqrt(iy2)*fabs(yStep) : 0.;
+	}
+
+	//Limits containing given fraction of power (the rest is shared equally between the sides, as in FindIntensityLimits1D/2D)
+	double RelPowLevel = (nPar > 3)? arPar[3] : 0.;
+	if(RelPowLevel <= 0.) return;
+	double AbsPowerToStopOn = sumTot*(1. - RelPowLevel)*((ny > 1)? 0.25 : 0.5);
+	arRes[12] = xStart + xStep*FindLimit1DLeft(arColSum, nx, AbsPowerToStopOn);
+	arRes[13] = xStart + xStep*FindLimit1DRight(arColSum, nx, AbsPowerToStopOn);
+	if(ny > 1)
+	{
+		arRes[14] = yStart + yStep*FindLimit1DLeft(&vRowSum[0], ny, AbsPowerToStopOn);
+		arRes[15] = yStart + yStep*FindLimit1DRight(&vRowSum[0], ny, AbsPowerToStopOn);
+	}
+}
+
+//*************************************************************************
+//Full width of 1D distribution at level levVal (same as in FindSimplestStat1D, values outside the distribution are treated as 0)
+template <class T> double srTAuxMatStat::AuxCalcWidthFused1D(T* p0, long long per, long long n, double xStart, double xStep, double levVal, long long iMax, bool fromPeak)
+{
+	long long iLeft, iRight;
+	if(fromPeak) FindIndHalfMaxLeftRightFromPeak1D(p0, n, levVal, iMax, iLeft, iRight, per);
+	else FindIndHalfMaxLeftRight1D(p0, n, levVal, iLeft, iRight, per);
+
+	double yLeft1 = (double)p0[iLeft*per], yLeft2 = (iLeft + 1 < n)? (double)p0[(iLeft + 1)*per] : 0.;
+	double yRight1 = (double)p0[iRight*per], yRight2 = (iRight + 1 < n)? (double)p0[(iRight + 1)*per] : 0.;
+	double xLeft = xStart + iLeft*xStep + ((yLeft1 - levVal)/(yLeft1 - yLeft2))*xStep;
+	double xRight = xStart + iRight*xStep + ((yRight1 - levVal)/(yRight1 - yRight2))*xStep;
+	return xRight - xLeft;
+}
+
+//*************************************************************************
+//Full widths of 2D distribution at level levVal, using max. profiles vs x (max. over y for each x) and vs y;
+//equivalent to FindIndHalfMaxLeftRight2D + AuxCalcWidth2D, which scan columns / rows of the data for each side
+template <class T> void srTAuxMatStat::AuxCalcWidthFused2D(T* p0, long long per, long long nx, long long ny, T* arColMax, long long* arColArgMax, T* arRowMax, long long* arRowArgMax, long long ixMax, long long iyMax, double xStart, double xStep, double yStart, double yStep, double levVal, bool fromPeak, double& xWidth, double& yWidth)
+{
+	long long nTot = nx*ny;
+	long long arResInd[4];
+	double arResVxVy[8];
+	long long iAux, ofst;
+
+	arResInd[0] = FindIndLevelLeftProf(arColMax, arColArgMax, ixMax, iyMax, levVal, fromPeak, iAux);
+	ofst = arResInd[0] + iAux*nx;
+	arResVxVy[0] = (double)p0[ofst*per];
+	arResVxVy[1] = (ofst + 1 < nTot)? (double)p0[(ofst + 1)*per] : 0.;
+
+	arResInd[1] = FindIndLevelRightProf(arColMax, arColArgMax, nx, ixMax, iyMax, levVal, fromPeak, iAux);
+	ofst = arResInd[1] + iAux*nx;
+	arResVxVy[2] = (double)p0[ofst*per];
+	arResVxVy[3] = (ofst + 1 < nTot)? (double)p0[(ofst + 1)*per] : 0.;
+
+	arResInd[2] = FindIndLevelLeftProf(arRowMax, arRowArgMax, iyMax, ixMax, levVal, fromPeak, iAux);
+	ofst = iAux + arResInd[2]*nx;
+	arResVxVy[4] = (double)p0[ofst*per];
+	arResVxVy[5] = (ofst + nx < nTot)? (double)p0[(ofst + nx)*per] : 0.;
+
+	arResInd[3] = FindIndLevelRightProf(arRowMax, arRowArgMax, ny, iyMax, ixMax, levVal, fromPeak, iAux);
+	ofst = iAux + arResInd[3]*nx;
+	arResVxVy[6] = (double)p0[ofst*per];
+	arResVxVy[7] = (ofst + nx < nTot)? (double)p0[(ofst + nx)*per] : 0.;
+
+	AuxCalcWidth2D(xStart, xStep, yStart, yStep, levVal, arResInd, arResVxVy, xWidth, yWidth);
+}
+
+//*************************************************************************
+//Index of left crossing of level levVal by max. profile; iOtherAux is the position of max. in the last profile point tested (as in FindIndHalfMaxLeftRight2D)
+template <class T> long long srTAuxMatStat::FindIndLevelLeftProf(T* arProfMax, long long* arProfArgMax, long long iMax, long long iOtherMax, double levVal, bool fromPeak, long long& iOtherAux)
+{
+	long long iRes = -1;
+	iOtherAux = iOtherMax;
+	if(fromPeak)
+	{
+		for(long long i=(iMax-1); i>=0; i--)
+		{
+			iOtherAux = arProfArgMax[i];
+			if((double)arProfMax[i] <= levVal) { iRes = i; break;}
+		}
+	}
+	else
+	{
+		for(long long i=0; i<iMax; i++)
+		{
+			iOtherAux = arProfArgMax[i];
+			if((double)arProfMax[i] > levVal) { iRes = i - 1; break;}
+		}
+	}
+	if(iRes < 0)
+	{
+		iRes = iMax - 1;
+		if(iRes < 0) iRes = 0;
+	}
+	return iRes;
+}
+
+//*************************************************************************
+//Index of right crossing of level levVal by max. profile (see FindIndLevelLeftProf)
+template <class T> long long srTAuxMatStat::FindIndLevelRightProf(T* arProfMax, long long* arProfArgMax, long long n, long long iMax, long long iOtherMax, double levVal, bool fromPeak, long long& iOtherAux)
+{
+	long long iRes = -1;
+	iOtherAux = iOtherMax;
+	if(fromPeak)
+	{
+		for(long long i=(iMax+1); i<n; i++)
+		{
+			iOtherAux = arProfArgMax[i];
+			if((double)arProfMax[i] < levVal) { iRes = i - 1; break;}
+		}
+	}
+	else
+	{
+		for(long long i=(n-1); i>=iMax; i--)
+		{
+			iOtherAux = arProfArgMax[i];
+			if((double)arProfMax[i] >= levVal) { iRes = i; break;}
+		}
+	}
+	if(iRes < 0)
+	{
+		iRes = iMax + 1;
+		if(iRes >= n) iRes = n - 1;
+	}
+	return iRes;
+}
+
 //*************************************************************************
 //Searches for intensity limits: returns a rectangle within which the power is located
 int srTAuxMatStat::FindIntensityLimits(srTWaveAccessData& InWaveData, double RelPowLevel, srTWaveAccessData& OutSpotInfo)
@@ -598,33 +880,9 @@ int srTAuxMatStat::FindIntensityLimitsInds(CHGenObj& hRad, int ie, double RelPow
 			delete[] RadExtract.pExtractedData; return res;
 		}
 
-		float AuxArrF[5];
-		srTWaveAccessData OutInfoData;
-		//char InfoSuf[] = "_inf"; // To steer //OC030110
-		(OutInfoData.WaveType)[0] = 'f';
-		OutInfoData.AmOfDims = 1;
-		(OutInfoData.DimSizes)[0] = 5;
-		(OutInfoData.DimSizes)[1] = 0;
-		(OutInfoData.DimStartValues)[0] = 0;
-		(OutInfoData.DimSteps)[0] = 1;
-		OutInfoData.pWaveData = (char*)AuxArrF;
-		for(int i=0; i<5; i++) AuxArrF[i] = 0.;
-		AuxArrF[0] = (float)IntegrateSimple(ExtractedWaveData);
-		if(res = FindIntensityLimits2D(ExtractedWaveData, RelPow, OutInfoData))
-		{
-			delete[] RadExtract.pExtractedData; return res;
-		}
-
-		IndLims[0] = (int)((AuxArrF[1] - Rad.xStart)*1.0000001/Rad.xStep);
-		if(IndLims[0] < 0) IndLims[0] = 0;
-		IndLims[1] = (int)((AuxArrF[2] - Rad.xStart)*1.0000001/Rad.xStep);
-		if(IndLims[1] >= Rad.nx) IndLims[1] = Rad.nx - 1;
-		IndLims[2] = (int)((AuxArrF[3] - Rad.zStart)*1.0000001/Rad.zStep);
-		if(IndLims[2] < 0) IndLims[2] = 0;
-		IndLims[3] = (int)((AuxArrF[4] - Rad.zStart)*1.0000001/Rad.zStep);
-		if(IndLims[3] >= Rad.nz) IndLims[3] = Rad.nz - 1;
-
+		res = FindIntensityLimitsInds(ExtractedWaveData, RelPow, IndLims);
 		delete[] RadExtract.pExtractedData;
+		if(res) return res;
 	}
 	catch(...)
 	{ }
@@ -632,3 +890,42 @@ int srTAuxMatStat::FindIntensityLimitsInds(CHGenObj& hRad, int ie, double RelPow
 }
 
 //*************************************************************************
+
+int srTAuxMatStat::FindIntensityLimitsInds(srTWaveAccessData& InIntData, double RelPow, int* IndLims)
+{//Finds indexes of limits of 2D intensity distribution (x fastest) containing RelPow part of total power
+	long Nx = (long)((InIntData.DimSizes)[0]), Nz = (long)((InIntData.DimSizes)[1]);
+	double xStart = (InIntData.DimStartValues)[0], xStep = (InIntData.DimSteps)[0];
+	double zStart = (InIntData.DimStartValues)[1], zStep = (InIntData.DimSteps)[1];
+
+	IndLims[0] = 0;
+	IndLims[1] = Nx - 1;
+	IndLims[2] = 0;
+	IndLims[3] = Nz - 1;
+
+	float AuxArrF[5];
+	srTWaveAccessData OutInfoData;
+	(OutInfoData.WaveType)[0] = 'f';
+	OutInfoData.AmOfDims = 1;
+	(OutInfoData.DimSizes)[0] = 5;
+	(OutInfoData.DimSizes)[1] = 0;
+	(OutInfoData.DimStartValues)[0] = 0;
+	(OutInfoData.DimSteps)[0] = 1;
+	OutInfoData.pWaveData = (char*)AuxArrF;
+	for(int i=0; i<5; i++) AuxArrF[i] = 0.;
+	AuxArrF[0] = (float)IntegrateSimple(InIntData);
+
+	int res = 0;
+	if(res = FindIntensityLimits2D(InIntData, RelPow, OutInfoData)) return res;
+
+	IndLims[0] = (int)((AuxArrF[1] - xStart)*1.0000001/xStep);
+	if(IndLims[0] < 0) IndLims[0] = 0;
+	IndLims[1] = (int)((AuxArrF[2] - xStart)*1.0000001/xStep);
+	if(IndLims[1] >= Nx) IndLims[1] = Nx - 1;
+	IndLims[2] = (int)((AuxArrF[3] - zStart)*1.0000001/zStep);
+	if(IndLims[2] < 0) IndLims[2] = 0;
+	IndLims[3] = (int)((AuxArrF[4] - zStart)*1.0000001/zStep);
+	if(IndLims[3] >= Nz) IndLims[3] = Nz - 1;
+	return 0;
+}
+
+//*************************************************************************
@@ -37,6 +37,8 @@
 class srTAuxMatStat {
 public:
 
+	static const int nResFused = 16; //number of values per distribution calculated by FindStatFused / FindStatMult
+
 	int FindSimplestStat(srTWaveAccessData& InWaveData, srTWaveAccessData& OutSpotInfo, double* arPar=0, int nPar=0); //OC29122018
 	//int FindSimplestStat1D(srTWaveAccessData& InWaveData, srTWaveAccessData& OutSpotInfo, double* arPar=0);
 	//int FindSimplestStat2D(srTWaveAccessData& InWaveData, srTWaveAccessData& OutSpotInfo, double* arPar=0);
@@ -47,11 +49,19 @@ public:
 	//void FindMax2D(srTWaveAccessData& InWaveData, double& MaxVal, long& iMax, long& jMax);
 	//void FindMax2D(srTWaveAccessData& InWaveData, double& MaxVal, long long& iMax, long long& jMax);
 	
+	int FindStatMult(srTWaveAccessData& InWaveData, long long nSlices, long long nFrames, double* arRes, double* arPar=0, int nPar=0);
+	template <class T> void FindStatFused(T* p0, long long per, double xStart, double xStep, long long nx, double yStart, double yStep, long long ny, double* arRes, double* arPar, int nPar, bool parRows);
+	template <class T> double AuxCalcWidthFused1D(T* p0, long long per, long long n, double xStart, double xStep, double levVal, long long iMax, bool fromPeak);
+	template <class T> void AuxCalcWidthFused2D(T* p0, long long per, long long nx, long long ny, T* arColMax, long long* arColArgMax, T* arRowMax, long long* arRowArgMax, long long ixMax, long long iyMax, double xStart, double xStep, double yStart, double yStep, double levVal, bool fromPeak, double& xWidth, double& yWidth);
+	template <class T> long long FindIndLevelLeftProf(T* arProfMax, long long* arProfArgMax, long long iMax, long long iOtherMax, double levVal, bool fromPeak, long long& iOtherAux);
+	template <class T> long long FindIndLevelRightProf(T* arProfMax, long long* arProfArgMax, long long n, long long iMax, long long iOtherMax, double levVal, bool fromPeak, long long& iOtherAux);
+
 	int FindIntensityLimits(srTWaveAccessData& InWaveData, double PowLevel, srTWaveAccessData& OutSpotInfoData);
 	int FindIntensityLimits1D(srTWaveAccessData& InWaveData, double RelPowLevel, srTWaveAccessData& OutSpotInfo);
 	int FindIntensityLimits2D(srTWaveAccessData& InWaveData, double RelPowLevel, srTWaveAccessData& OutSpotInfo);
 	//int FindIntensityLimitsInds(srTSRWRadStructAccessData&, int ie, double RelPow, int* IndLims);
 	int FindIntensityLimitsInds(CHGenObj&, int ie, double RelPow, int* IndLims);
+	int FindIntensityLimitsInds(srTWaveAccessData& InIntData, double RelPow, int* IndLims);
 
 	//void FindMax1D(float* p0, long LenArr, double& MaxVal, long& iMax);
 	//void FindMax1D(DOUBLE* p0, long LenArr, double& MaxVal, long& iMax);
@@ -73,7 +83,7 @@ public:
 	template <class T> int IntegrateOverX(T* p0, long long ixStart, long long ixEnd, double xStep, long long Nx, long long Ny, double* AuxArrIntOverX);
 	template <class T> int IntegrateOverY(T* p0, long long iyStart, long long iyEnd, double yStep, long long Nx, double* AuxArrIntOverY);
 
-	template <class T> void FindIndHalfMaxLeftRightFromPeak1D(T* ar, long long lenArr, double halfMaxVal, long long iMax, long long& iHalfMaxLeft, long long& iHalfMaxRight)
+	template <class T> void FindIndHalfMaxLeftRightFromPeak1D(T* ar, long long lenArr, double halfMaxVal, long long iMax, long long& iHalfMaxLeft, long long& iHalfMaxRight, long long per=1)
 	{//OC02012019
 		iHalfMaxLeft = 0; iHalfMaxRight = lenArr - 1;
 
@@ -83,17 +93,17 @@ public:
 		for(long long i=(iMax-1); i>=0; i--)
 		{
 			//if(*(t--) <= halfMax) { iHalfMaxLeft = i; break;}
-			if(ar[i] <= halfMax) { iHalfMaxLeft = i; break;}
+			if(ar[i*per] <= halfMax) { iHalfMaxLeft = i; break;}
 		}
 		//t = t0;
 		for(long long i=(iMax+1); i<lenArr; i++)
 		{
 			//if(*(t++) < halfMax) { iHalfMaxRight = i - 1; break;}
-			if(ar[i] < halfMax) { iHalfMaxRight = i - 1; break;}
+			if(ar[i*per] < halfMax) { iHalfMaxRight = i - 1; break;}
 		}
 	}
 
-	template <class T> void FindIndHalfMaxLeftRight1D(T* p0, long long lenArr, double halfMaxVal, long long& iHalfMaxLeft, long long& iHalfMaxRight)
+	template <class T> void FindIndHalfMaxLeftRight1D(T* p0, long long lenArr, double halfMaxVal, long long& iHalfMaxLeft, long long& iHalfMaxRight, long long per=1)
 	{
 		iHalfMaxLeft = 0; iHalfMaxRight = lenArr - 1;
 
@@ -101,15 +111,17 @@ public:
 		T halfMax = (T)halfMaxVal;
 		for(long long i=0; i<lenArr; i++)
 		{
-			if(*(t++) < halfMax) iHalfMaxLeft = i;
+			if(*t < halfMax) iHalfMaxLeft = i;
 			else break;
+			t += per;
 		}
 		long long lenArr_mi_1 = lenArr - 1;
-		t = p0 + lenArr_mi_1;
+		t = p0 + lenArr_mi_1*per;
 		for(long long j=lenArr_mi_1; j>=0; j--)
 		{
 			iHalfMaxRight = j;
-			if(*(t--) >= halfMax) break;
+			if(*t >= halfMax) break;
+			t -= per;
 		}
 	}
 
@@ -350,87 +362,13 @@ public:
 	}
 
 	template <class T> void FindSimplestStat2D(T* p0, double xStart, double xStep, long long xLenArr, double yStart, double yStep, long long yLenArr, srTWaveAccessData& OutSpotInfo, double* arPar=0, int nPar=0) //OC02012019
-	{
-		double MaxVal;
-		long long iMaxTot, lenArrTot = xLenArr*yLenArr;
-		//FindMax2D(InWaveData, MaxVal, iMax, jMax);
-		FindMax1D(p0, lenArrTot, MaxVal, iMaxTot);
-		long long iyMax = (long long)(iMaxTot/xLenArr);
-		long long ixMax = iMaxTot - iyMax*xLenArr;
-
-		double xMax = xStart + ixMax*xStep;
-		double yMax = yStart + iyMax*yStep;
-
-		double HalfMaxVal = 0.5*MaxVal;
-
-		bool calcSizeFromPeak = false;
-		if(arPar != 0) { if(arPar[0] == 1) calcSizeFromPeak = true;}
-
-		long long arResInd[4];
-		double arResVxVy[8]; 
-		FindIndHalfMaxLeftRight2D(p0, xLenArr, yLenArr, HalfMaxVal, ixMax, iyMax, calcSizeFromPeak, arResInd, arResVxVy);
-
-		double xFWHM = 0., yFWHM = 0.;
-		AuxCalcWidth2D(xStart, xStep, yStart, yStep, HalfMaxVal, arResInd, arResVxVy, xFWHM, yFWHM);
-		//long long ixHalfMaxLeft = arResInd[0], ixHalfMaxRight = arResInd[1], iyHalfMaxLeft = arResInd[2], iyHalfMaxRight = arResInd[3];
-		//double VxLeft1 = arResVxVy[0], VxLeft2 = arResVxVy[1], VxRight1 = arResVxVy[2], VxRight2 = arResVxVy[3];
-		//double VyLeft1 = arResVxVy[4], VyLeft2 = arResVxVy[5], VyRight1 = arResVxVy[6], VyRight2 = arResVxVy[7];
-
-		//double xLeft1 = xStart + ixHalfMaxLeft*xStep;
-		//double xLeft = xLeft1 + ((VxLeft1 - HalfMaxVal)/(VxLeft1 - VxLeft2))*xStep;
-		//double xRight1 = xStart + ixHalfMaxRight*xStep;
-		//double xRight = xRight1 + ((VxRight1 - HalfMaxVal)/(VxRight1 - VxRight2))*xStep;
-		//double xFWHM = xRight - xLeft;
-		//double yLeft1 = yStart + iyHalfMaxLeft*yStep;
-		//double yLeft = yLeft1 + ((VyLeft1 - HalfMaxVal)/(VyLeft1 - VyLeft2))*yStep;
-		//double yRight1 = yStart + iyHalfMaxRight*yStep;
-		//double yRight = yRight1 + ((VyRight1 - HalfMaxVal)/(VyRight1 - VyRight2))*yStep;
-		//double yFWHM = yRight - yLeft;
-
-		double xFWFM = 0., yFWFM = 0.;
-		int nRes = 5;
-		if(nPar > 2)
-		{//OC03012019
-			double xFract = arPar[1], yFract = arPar[2];
-			if((xFract == yFract) && (xFract > 0.))
-			{
-				HalfMaxVal = xFract*MaxVal;
-				FindIndHalfMaxLeftRight2D(p0, xLenArr, yLenArr, HalfMaxVal, ixMax, iyMax, calcSizeFromPeak, arResInd, arResVxVy);
-				AuxCalcWidth2D(xStart, xStep, yStart, yStep, HalfMaxVal, arResInd, arResVxVy, xFWFM, yFWFM);
-			}
-			else 
-			{
-				if(xFract > 0.)
-				{
-					HalfMaxVal = xFract*MaxVal;
-					FindIndHalfMaxLeftRight2D(p0, xLenArr, yLenArr, HalfMaxVal, ixMax, iyMax, calcSizeFromPeak, arResInd, arResVxVy);
-					double yAuxFWFM;
-					AuxCalcWidth2D(xStart, xStep, yStart, yStep, HalfMaxVal, arResInd, arResVxVy, xFWFM, yAuxFWFM);
-				}
-				if(yFract > 0.)
-				{
-					HalfMaxVal = yFract*MaxVal;
-					FindIndHalfMaxLeftRight2D(p0, xLenArr, yLenArr, HalfMaxVal, ixMax, iyMax, calcSizeFromPeak, arResInd, arResVxVy);
-					double xAuxFWFM;
-					AuxCalcWidth2D(xStart, xStep, yStart, yStep, HalfMaxVal, arResInd, arResVxVy, xAuxFWFM, yFWFM);
-				}
-			}
-			nRes = 7;
-		}
+	{//peak and FWHM / FWFM are taken from max. profiles vs x and y obtained in one sweep over the data (same results as repeated scans by FindIndHalfMaxLeftRight2D)
+		double arRes[nResFused];
+		FindStatFused(p0, 1, xStart, xStep, xLenArr, yStart, yStep, yLenArr, arRes, arPar, nPar, true);
 
-		//float* pOut = (float*)(OutSpotInfo.pWaveData); //make it more general (allow double and float)
-		//*(pOut++) = (float)MaxVal;
-		//*(pOut++) = (float)xMax;
-		//*(pOut++) = (float)yMax;
-		//*(pOut++) = (float)(xRight - xLeft);
-		//*pOut = (float)(yRight - yLeft);
-
-		double arRes[] = {MaxVal, xMax, yMax, xFWHM, yFWHM, xFWFM, yFWFM};
-		if(*(OutSpotInfo.WaveType) == 'f') FillOutResData((float*)(OutSpotInfo.pWaveData), arRes, nRes); //OC03012019
+		int nRes = (nPar > 2)? 7 : 5; //OC03012019
+		if(*(OutSpotInfo.WaveType) == 'f') FillOutResData((float*)(OutSpotInfo.pWaveData), arRes, nRes);
 		else FillOutResData((double*)(OutSpotInfo.pWaveData), arRes, nRes);
-
-		//if(*(OutSpotInfo.WaveType) == 'f') FillOutResData((float*)(OutSpotInfo.pWaveData), MaxVal, xMax, yMax, xRight - xLeft, yRight - yLeft);
-		//else FillOutResData((double*)(OutSpotInfo.pWaveData), MaxVal, xMax, yMax, xRight - xLeft, yRight - yLeft);
 	}
 
 	//template <class T> double SumUpArray(T* p0, long iStart, long iEnd, long iStep)
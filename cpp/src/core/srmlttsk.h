@@ -26,6 +26,8 @@
 
 #include <time.h>
 
+#include "srprgind.h"
+
 //*************************************************************************
 
 extern int gCallSpinProcess;
@@ -47,6 +49,7 @@ public:
 
 inline int srTYield::Check() 
 {
+	if(srTCompProgressIndicator::AbortIsRequested(srTCompProgressIndicator::m_pThreadCtrl)) return SR_COMP_PROC_ABORTED;
 	if(delta <= 0) return 0;
 	if((clock() > oldtime) && gCallSpinProcess) 
 	{
@@ -15,6 +15,7 @@
 #include "srsysuti.h"
 #include "srmlttsk.h"
 #include "srerror.h"
+#include "gmfft.h"
 
 //OC31102018: added by SY at parallelizing SRW via OpenMP
 //#include "srwlib.h"
@@ -241,12 +242,16 @@ int srTGenOptElem::PropagateRadiationMeth_0(srTSRWRadStructAccessData* pRadAcces
 
 #ifndef _FFTW3 //OC28082019
 	//It looks like with FFTW2, this plan has to be shared among all threads:
-	m_frwPlan2DFFT = fftw2d_create_plan(pRadAccessData->nz, pRadAccessData->nx, FFTW_FORWARD, FFTW_IN_PLACE | FFTW_THREADSAFE);
-	m_bckwPlan2DFFT = fftw2d_create_plan(pRadAccessData->nz, pRadAccessData->nx, FFTW_BACKWARD, FFTW_IN_PLACE | FFTW_THREADSAFE);
+	{
+		std::lock_guard<std::mutex> lck(CGenMathFFT::MutexPlan()); //other threads (contexts) may create plans at the same time
+		m_frwPlan2DFFT = fftw2d_create_plan(pRadAccessData->nz, pRadAccessData->nx, FFTW_FORWARD, FFTW_IN_PLACE | FFTW_THREADSAFE);
+		m_bckwPlan2DFFT = fftw2d_create_plan(pRadAccessData->nz, pRadAccessData->nx, FFTW_BACKWARD, FFTW_IN_PLACE | FFTW_THREADSAFE);
+	}
 #endif
 
+	CErrWarnBind WarnBind(&gVectWarnNos); //warnings of worker threads go to the list of calling thread
 	//SY: we cannot do it in parallel if previous field is needed (which is not the case in the current version of SRW)
-	#pragma omp parallel if (pPrevRadDataSingleE == 0)
+	#pragma omp parallel if (pPrevRadDataSingleE == 0) firstprivate(WarnBind)
 	{
 		int threadNum = omp_get_thread_num();
 		srTSRWRadStructAccessData *pRadDataSingleE = 0;
@@ -372,8 +377,11 @@ int srTGenOptElem::PropagateRadiationMeth_0(srTSRWRadStructAccessData* pRadAcces
 
 #ifndef _FFTW3 //OC28082019
 	//It looks like with FFTW2, this plan has to be shared among all threads:
-	if(m_frwPlan2DFFT != 0) { fftwnd_destroy_plan(m_frwPlan2DFFT); m_frwPlan2DFFT = 0;}
-	if(m_bckwPlan2DFFT != 0) { fftwnd_destroy_plan(m_bckwPlan2DFFT); m_bckwPlan2DFFT = 0;}
+	{
+		std::lock_guard<std::mutex> lck(CGenMathFFT::MutexPlan());
+		if(m_frwPlan2DFFT != 0) { fftwnd_destroy_plan(m_frwPlan2DFFT); m_frwPlan2DFFT = 0;}
+		if(m_bckwPlan2DFFT != 0) { fftwnd_destroy_plan(m_bckwPlan2DFFT); m_bckwPlan2DFFT = 0;}
+	}
 #endif
 
 #endif
@@ -12,6 +12,7 @@
  ***************************************************************************/
 
 #include "sroptelm.h"
+#include "srwlprof.h"
 #include "srsend.h"
 
 #include "sroptapt.h"
@@ -154,6 +155,8 @@ int srTGenOptElem::ExtraDataExpected(const char* sElemID) //OC01062020
 int srTGenOptElem::TraverseRadZXE(srTSRWRadStructAccessData* pRadAccessData, void* pBufVars, long pBufVarsSz, void* pvGPU) //OC29082019 //HG01122023
 //int srTGenOptElem::TraverseRadZXE(srTSRWRadStructAccessData* pRadAccessData)
 {
+	CSRWLProfScope profScope(srwlProfPointModif, ((long long)pRadAccessData->ne)*((long long)pRadAccessData->nx)*((long long)pRadAccessData->nz)*4*sizeof(float));
+
 	float *pEx0 = pRadAccessData->pBaseRadX;
 	float *pEz0 = pRadAccessData->pBaseRadZ;
 	//long PerX = pRadAccessData->ne << 1;
@@ -1416,8 +1419,11 @@ int srTGenOptElem::SetRadRepres(srTSRWRadStructAccessData* pRadAccessData, char
 		//SY: creation (and deletion) of FFTW plans is not thread-safe. Have to do this outside of threads.
 		//(and we don't need to recreate plans for same dimensions anyway)
 		fftwnd_plan Plan2DFFT;
-		if(FFT2DInfo.Dir > 0) Plan2DFFT = fftw2d_create_plan(FFT2DInfo.Ny, FFT2DInfo.Nx, FFTW_FORWARD, FFTW_IN_PLACE|FFTW_THREADSAFE);
-		else Plan2DFFT = fftw2d_create_plan(FFT2DInfo.Ny, FFT2DInfo.Nx, FFTW_BACKWARD, FFTW_IN_PLACE|FFTW_THREADSAFE);
+		{
+			std::lock_guard<std::mutex> lck(CGenMathFFT::MutexPlan()); //other threads (contexts) may create plans at the same time
+			if(FFT2DInfo.Dir > 0) Plan2DFFT = fftw2d_create_plan(FFT2DInfo.Ny, FFT2DInfo.Nx, FFTW_FORWARD, FFTW_IN_PLACE|FFTW_THREADSAFE);
+			else Plan2DFFT = fftw2d_create_plan(FFT2DInfo.Ny, FFT2DInfo.Nx, FFTW_BACKWARD, FFTW_IN_PLACE|FFTW_THREADSAFE);
+		}
 
 		#pragma omp parallel
 		{
@@ -1494,7 +1500,7 @@ int srTGenOptElem::SetRadRepres(srTSRWRadStructAccessData* pRadAccessData, char
 
 		} // end omp parallel
 
-		fftwnd_destroy_plan(Plan2DFFT);
+		{ std::lock_guard<std::mutex> lck(CGenMathFFT::MutexPlan()); fftwnd_destroy_plan(Plan2DFFT);}
 
 		//for(long ie = 0; ie < pRadAccessData->ne; ie++) if(results[ie]) return results[ie];
 		//delete[] results;
@@ -1621,16 +1627,29 @@ int srTGenOptElem::ComputeRadMoments(srTSRWRadStructAccessData* pSRWRadStructAcc
 	const double Inv_eV_In_m = 1.239842E-06;
 
 	srTAuxMatStat AuxMatStat; //OC13112010 (uncommented)
-	//int IndLims[4]; //OC28102018
 	const double RelPowForLimits = 0.9; //to steer
-	
-#ifndef _WITH_OMP //OC28102018
-	CHGenObj hRad(pSRWRadStructAccessData, true); //OC13112010
-	double SumsX[22], SumsZ[22], ff[22]; //OC28102018
-	int IndLims[4]; //OC28102018
-#endif
+	const int AmOfSums = 22;
+	double SumsZ[22];
+	int IndLims[4];
 	int result = 0;
 
+	//Auxiliary arrays: intensity of one slice (for finding limits) and sums over each row
+	long long nxnz = ((long long)pSRWRadStructAccessData->nx)*((long long)pSRWRadStructAccessData->nz);
+	std::vector<float> vIntSlice;
+	std::vector<double> vSumsRows;
+	try { vIntSlice.resize(nxnz); vSumsRows.resize(AmOfSums*((long long)pSRWRadStructAccessData->nz));}
+	catch(std::bad_alloc&) { return MEMORY_ALLOCATION_FAILURE;}
+	float *arIntSlice = &(vIntSlice[0]);
+	double *arSumsRows = &(vSumsRows[0]);
+
+	srTWaveAccessData IntSliceData;
+	IntSliceData.pWaveData = (char*)arIntSlice;
+	(IntSliceData.WaveType)[0] = 'f';
+	IntSliceData.AmOfDims = 2;
+	(IntSliceData.DimSizes)[0] = pSRWRadStructAccessData->nx; (IntSliceData.DimSizes)[1] = pSRWRadStructAccessData->nz;
+	(IntSliceData.DimStartValues)[0] = pSRWRadStructAccessData->xStart; (IntSliceData.DimStartValues)[1] = pSRWRadStructAccessData->zStart;
+	(IntSliceData.DimSteps)[0] = pSRWRadStructAccessData->xStep; (IntSliceData.DimSteps)[1] = pSRWRadStructAccessData->zStep;
+
 	//if(pSRWRadStructAccessData->Pres != 0)
 	//	if(result = SetRadRepres(pSRWRadStructAccessData, 0)) return result;
 	bool IsCoordRepres = (pSRWRadStructAccessData->Pres == 0);
@@ -1685,17 +1704,9 @@ int srTGenOptElem::ComputeRadMoments(srTSRWRadStructAccessData* pSRWRadStructAcc
 	//Added by SY (for profiling?) at parallelizing SRW via OpenMP:
 	//srwlPrintTime(":ComputeRadMoments : setup",&start);
 
-#ifdef _WITH_OMP //OC28102018: added by SY
-	#pragma omp parallel for
-#endif
-
+	//Slices are treated one by one; rows of each slice are treated in parallel (with OpenMP)
 	for(int ie=0; ie<pSRWRadStructAccessData->ne; ie++)
 	{
-#ifdef _WITH_OMP //OC28102018: modified by SY
-		CHGenObj hRad(pSRWRadStructAccessData, true); //OC13112010
-		double SumsX[22], SumsZ[22], ff[22];
-		int IndLims[4];
-#endif
 		//If wavefront is in Time-domain representation, average photon energy should be used
 		double *fpMomX = pSRWRadStructAccessData->pMomX + ie*AmOfMom;
 		double *fpMomZ = pSRWRadStructAccessData->pMomZ + ie*AmOfMom; //OC130311
@@ -1738,11 +1749,36 @@ int srTGenOptElem::ComputeRadMoments(srTSRWRadStructAccessData* pSRWRadStructAcc
 
 		srTMomentsPtrs MomXPtrs(fpMomX), MomZPtrs(fpMomZ);
 
-		AuxMatStat.FindIntensityLimitsInds(hRad, ie, RelPowForLimits, IndLims);
+		//Total intensity of the slice, to find limits containing RelPowForLimits part of power
+#ifdef _WITH_OMP
+		#pragma omp parallel for
+#endif
+		for(int iz=0; iz<pSRWRadStructAccessData->nz; iz++)
+		{
+			float *fpX = fpX0 + iz*PerZ + Two_ie;
+			float *fpZ = fpZ0 + iz*PerZ + Two_ie;
+			float *tInt = arIntSlice + iz*((long long)pSRWRadStructAccessData->nx);
+			for(int ix=0; ix<pSRWRadStructAccessData->nx; ix++)
+			{
+				float ExRe = 0., ExIm = 0., EzRe = 0., EzIm = 0.;
+				if(ExIsOK) { ExRe = *fpX; ExIm = *(fpX+1);}
+				if(EzIsOK) { EzRe = *fpZ; EzIm = *(fpZ+1);}
+				*(tInt++) = ExRe*ExRe + ExIm*ExIm + EzRe*EzRe + EzIm*EzIm;
+				fpX += PerX; fpZ += PerX;
+			}
+		}
+		if(result = AuxMatStat.FindIntensityLimitsInds(IntSliceData, RelPowForLimits, IndLims))
+		{
+			if(WaveFrontTermWasTreated) TreatStronglyOscillatingTerm(*pSRWRadStructAccessData, 'a');
+			return result;
+		}
 
 		//AuxMatStat.FindIntensityLimitsInds(*pSRWRadStructAccessData, ie, RelPowForLimits, IndLims);
 		//not good for computing precisely intensity
 		//make decision
+#ifdef _WITH_OMP
+		#pragma omp parallel for
+#endif
 		for(int iz=0; iz<pSRWRadStructAccessData->nz; iz++)
 		//for(int iz=IndLims[2]; iz<=IndLims[3]; iz++)
 		{
@@ -1750,6 +1786,7 @@ int srTGenOptElem::ComputeRadMoments(srTSRWRadStructAccessData* pSRWRadStructAcc
 
 			bool vertCoordInsidePowLim = ((iz >= IndLims[2]) && (iz <= IndLims[3]));
 
+			double *SumsX = arSumsRows + iz*AmOfSums, ff[22];
 			for(int k=0; k<22; k++) SumsX[k] = 0.;
 
 			//long izPerZ = iz*PerZ;
@@ -1939,8 +1976,14 @@ int srTGenOptElem::ComputeRadMoments(srTSRWRadStructAccessData* pSRWRadStructAcc
 				SumsX[20] *= 0.5; // <zz'>
 				SumsX[21] *= 0.5; // <z'z'>
 			}
+		}
 
-			for(int kk=0; kk<22; kk++) SumsZ[kk] += SumsX[kk];
+		//Summation of row sums in fixed order (as in serial calculation, so that result doesn't depend on number of threads)
+		double *tSumsRow = arSumsRows;
+		for(int iz=0; iz<pSRWRadStructAccessData->nz; iz++)
+		{
+			for(int kk=0; kk<22; kk++) SumsZ[kk] += tSumsRow[kk];
+			tSumsRow += AmOfSums;
 		}
 
 		double xStep_zStep_mm2 = (pSRWRadStructAccessData->xStep)*(pSRWRadStructAccessData->zStep)*1.E+06;
@@ -2241,6 +2284,8 @@ void srTGenOptElem::FindMinMaxRatio(double* Arr1, double* Arr2, int n, double& M
 //int srTGenOptElem::RadResizeGen(srTSRWRadStructAccessData& SRWRadStructAccessData, srTRadResize& RadResizeStruct)
 int srTGenOptElem::RadResizeGen(srTSRWRadStructAccessData& SRWRadStructAccessData, srTRadResize& RadResizeStruct, void* pvGPU) //HG01122023
 {
+	CSRWLProfScope profScope(srwlProfResize, ((long long)SRWRadStructAccessData.ne)*((long long)SRWRadStructAccessData.nx)*((long long)SRWRadStructAccessData.nz)*4*sizeof(float));
+
 	//Added by SY (for profiling?) at parallelizing SRW via OpenMP:
 	//double start;
 	//get_walltime(&start);
@@ -3339,6 +3384,7 @@ int srTGenOptElem::RadResizeCore(srTSRWRadStructAccessData& OldRadAccessData, sr
 int srTGenOptElem::RadResizeGenE(srTSRWRadStructAccessData& SRWRadStructAccessData, srTRadResize& RadResizeStruct)
 {
 	if((RadResizeStruct.pem == 1.) && (RadResizeStruct.ped == 1.)) return 0;
+	CSRWLProfScope profScope(srwlProfResize, ((long long)SRWRadStructAccessData.ne)*((long long)SRWRadStructAccessData.nx)*((long long)SRWRadStructAccessData.nz)*4*sizeof(float));
 	int result = 0;
 
 	bool ExIsOK = SRWRadStructAccessData.pBaseRadX != 0;
@@ -5227,7 +5273,7 @@ void srTGenOptElem::TreatStronglyOscillatingTermIrregMeshTrf(srTSRWRadStructAcce
 		double ConstRxE, ConstRzE;
 		double xOld, zOld, x, z; //, zE2;
 
-		double ePh = RadAccessData.eStart + RadAccessData.eStep*(ie - ieStart);
+		double ePh = RadAccessData.eStart + RadAccessData.eStep*ie;
 
 		if(RadAccessData.PresT == 1)
 		{
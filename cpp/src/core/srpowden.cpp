@@ -34,6 +34,9 @@ void srTRadIntPowerDensity::Initialize()
 	MaxFluxDensValG = CurrentAbsPrecG = 0.;
 
 	pWarningsGen = &gVectWarnNos;
+
+	IntPowDenPrec.AdaptRelTol = 0.;
+	NpCompG = 0; NumLevCompG = 0;
 }
 
 //*************************************************************************
@@ -81,6 +84,7 @@ void srTRadIntPowerDensity::SetPrecParams(srTParPrecPowDens* pPrecPowDens)
     IntPowDenPrec.UseSpecIntLim = pPrecPowDens->UseSpecIntLim;
     IntPowDenPrec.sStart = pPrecPowDens->sIntStart;
     IntPowDenPrec.sFin = pPrecPowDens->sIntFin;
+	IntPowDenPrec.AdaptRelTol = pPrecPowDens->AdaptRelTol;
 }
 
 //*************************************************************************
@@ -104,6 +108,7 @@ void srTRadIntPowerDensity::ComputePowerDensity(srTEbmDat* pElecBeam, srTMagElem
 
 	SetPrecParams(pPrecPowDens);
 	if(res = ComputeTotalPowerDensityDistr(*pPow)) throw res;
+	if(pPrecPowDens != 0) { pPrecPowDens->NpComp = NpCompG; pPrecPowDens->NumLevComp = NumLevCompG;}
 }
 
 //*************************************************************************
@@ -125,6 +130,7 @@ void srTRadIntPowerDensity::ComputePowerDensity(srTTrjDat* pTrjDat, srTWfrSmp* p
 
 	SetPrecParams(pPrecPowDens);
 	if(res = ComputeTotalPowerDensityDistr(*pPow)) throw res;
+	if(pPrecPowDens != 0) { pPrecPowDens->NpComp = NpCompG; pPrecPowDens->NumLevComp = NumLevCompG;}
 }
 
 //*************************************************************************
@@ -199,6 +205,14 @@ int srTRadIntPowerDensity::ComputeTotalPowerDensityDistr(srTPowDensStructAccessD
 
 	TVector3d &vExP = DistrInfoDat.vHor, &vEyP = DistrInfoDat.vLong, vEzP, vEyP0, vExP0;
 
+	double UpdateTimeInt_s = 0.5;
+	if((IntPowDenPrec.AdaptRelTol > 0.) && (!trfObsPlaneIsDefined) && (!obSurfIsDefined))
+	{//adaptive refinement of observation mesh (symmetry is not exploited in this case)
+		srTCompProgressIndicator CompProgressInd(DistrInfoDat.nz*DistrInfoDat.nx, UpdateTimeInt_s);
+		if(result = ComputeTotalPowerDensityDistrAdapt(PowDensAccessData, CompProgressInd)) return result;
+		return TreatFiniteElecBeamEmittance(PowDensAccessData, &trfObsPl);
+	}
+
 	char FinalResAreSymOverX = 0, FinalResAreSymOverZ = 0;
 	if((!trfObsPlaneIsDefined) && (!obSurfIsDefined)) AnalizeFinalResultsSymmetry(FinalResAreSymOverX, FinalResAreSymOverZ); //to make more general
 
@@ -235,7 +249,6 @@ int srTRadIntPowerDensity::ComputeTotalPowerDensityDistr(srTPowDensStructAccessD
 
 	//long PointCount = 0;
 	long long PointCount = 0;
-	double UpdateTimeInt_s = 0.5;
 	srTCompProgressIndicator CompProgressInd(TotalAmOfOutPoints, UpdateTimeInt_s);
 
 	TVector3d vRlab(0, 0, 0), vRloc(0, 0, 0);
@@ -305,6 +318,8 @@ int srTRadIntPowerDensity::ComputeTotalPowerDensityDistr(srTPowDensStructAccessD
 		}
 	}
 
+	NpCompG = PointCount;
+
 	if(FinalResAreSymOverZ || FinalResAreSymOverX) 
 		FillInSymPartsOfResults(FinalResAreSymOverX, FinalResAreSymOverZ, PowDensAccessData);
 
@@ -315,6 +330,160 @@ int srTRadIntPowerDensity::ComputeTotalPowerDensityDistr(srTPowDensStructAccessD
 
 //*************************************************************************
 
+int srTRadIntPowerDensity::ComputeTotalPowerDensityDistrAdapt(srTPowDensStructAccessData& PowDensAccessData, srTCompProgressIndicator& CompProgressInd)
+{//Hierarchical refinement of observation mesh: power density is computed on a coarse grid, then each cell is checked at its edge middles and center
+ //and is subdivided only where bilinear interpolation from the cell corners deviates from the computed values by more than AdaptRelTol*(max. power density);
+ //remaining points of accepted cells are interpolated (biquadratically, from the 9 computed points of a cell).
+	const long long MinAmOfCoarseInterv = 8; // To steer
+	const int MaxAmOfLevels = 30;
+
+	int result = 0;
+	long long nx = DistrInfoDat.nx, nz = DistrInfoDat.nz;
+	float *pPow = PowDensAccessData.pBasePowDens;
+	NpCompG = 0; NumLevCompG = 0; AdaptMaxValG = 0.; NpFinG = 0;
+
+	std::vector<char> vIsComp((size_t)(nx*nz), 0); //0- not processed, 1- computed, 2- interpolated
+	char *arIsComp = &vIsComp[0];
+
+	//Coarse grid: steps are largest powers of 2 giving at least MinAmOfCoarseInterv intervals (last interval may be shorter)
+	long long ixStep = 1, izStep = 1;
+	while((nx - 1) >= 2*ixStep*MinAmOfCoarseInterv) ixStep <<= 1;
+	while((nz - 1) >= 2*izStep*MinAmOfCoarseInterv) izStep <<= 1;
+
+	std::vector<srTPowDensMeshCell> vCells;
+	for(long long iz0=0;; iz0+=izStep)
+	{
+		long long iz1 = iz0 + izStep; if(iz1 >= nz) iz1 = nz - 1;
+		for(long long ix0=0;; ix0+=ixStep)
+		{
+			long long ix1 = ix0 + ixStep; if(ix1 >= nx) ix1 = nx - 1;
+			srTPowDensMeshCell Cell = {ix0, ix1, iz0, iz1, 0};
+			vCells.push_back(Cell);
+
+			const long long arIx[] = {ix0, ix1, ix0, ix1}, arIz[] = {iz0, iz0, iz1, iz1};
+			for(int i=0; i<4; i++) if(result = ComputePowerDensityAtMeshPoint(arIx[i], arIz[i], PowDensAccessData, arIsComp, CompProgressInd)) return result;
+			if(ix1 >= nx - 1) break;
+		}
+		if(iz1 >= nz - 1) break;
+	}
+
+	while(!vCells.empty())
+	{
+		srTPowDensMeshCell Cell = vCells.back();
+		vCells.pop_back();
+		if(NumLevCompG < Cell.Lev) NumLevCompG = Cell.Lev;
+
+		long long ix0 = Cell.ix0, ix1 = Cell.ix1, iz0 = Cell.iz0, iz1 = Cell.iz1;
+		long long ixm = ((ix1 - ix0) >= 2)? ((ix0 + ix1) >> 1) : -1;
+		long long izm = ((iz1 - iz0) >= 2)? ((iz0 + iz1) >> 1) : -1;
+		if((ixm < 0) && (izm < 0)) continue; //all points of the cell are its corners
+
+		//Checking the cell at edge middles and center
+		const long long arIx[] = {ixm, ixm, ix0, ix1, ixm}, arIz[] = {iz0, iz1, izm, izm, izm};
+		double f00 = pPow[iz0*nx + ix0], f10 = pPow[iz0*nx + ix1], f01 = pPow[iz1*nx + ix0], f11 = pPow[iz1*nx + ix1];
+		double MaxDev = 0.;
+		for(int i=0; i<5; i++)
+		{
+			long long ix = arIx[i], iz = arIz[i];
+			if((ix < 0) || (iz < 0)) continue;
+			if(result = ComputePowerDensityAtMeshPoint(ix, iz, PowDensAccessData, arIsComp, CompProgressInd)) return result;
+
+			double tx = (ix1 > ix0)? ((double)(ix - ix0))/((double)(ix1 - ix0)) : 0.;
+			double tz = (iz1 > iz0)? ((double)(iz - iz0))/((double)(iz1 - iz0)) : 0.;
+			double fInterp = (1. - tz)*((1. - tx)*f00 + tx*f10) + tz*((1. - tx)*f01 + tx*f11);
+			double Dev = ::fabs(pPow[iz*nx + ix] - fInterp);
+			if(MaxDev < Dev) MaxDev = Dev;
+		}
+
+		//Nodes of the cell in each direction: ends and middle (if any)
+		long long arNodX[] = {ix0, (ixm >= 0)? ixm : ix1, ix1}, arNodZ[] = {iz0, (izm >= 0)? izm : iz1, iz1};
+		int nNodX = (ixm >= 0)? 3 : ((ix1 > ix0)? 2 : 1), nNodZ = (izm >= 0)? 3 : ((iz1 > iz0)? 2 : 1);
+
+		if((MaxDev > IntPowDenPrec.AdaptRelTol*AdaptMaxValG) && (Cell.Lev < MaxAmOfLevels))
+		{//subdividing the cell
+			int nSubX = (nNodX > 1)? (nNodX - 1) : 1, nSubZ = (nNodZ > 1)? (nNodZ - 1) : 1;
+			for(int jz=0; jz<nSubZ; jz++)
+			{
+				for(int jx=0; jx<nSubX; jx++)
+				{
+					srTPowDensMeshCell SubCell = {arNodX[jx], arNodX[jx + nNodX - nSubX], arNodZ[jz], arNodZ[jz + nNodZ - nSubZ], Cell.Lev + 1};
+					vCells.push_back(SubCell);
+				}
+			}
+			continue;
+		}
+
+		//Interpolating the remaining points of the cell (Lagrange, over 2 or 3 nodes in each direction)
+
+		for(long long iz=iz0; iz<=iz1; iz++)
+		{
+			double arCz[3];
+			for(int j=0; j<nNodZ; j++)
+			{
+				double c = 1.;
+				for(int k=0; k<nNodZ; k++) if(k != j) c *= ((double)(iz - arNodZ[k]))/((double)(arNodZ[j] - arNodZ[k]));
+				arCz[j] = c;
+			}
+			for(long long ix=ix0; ix<=ix1; ix++)
+			{
+				long long ofst = iz*nx + ix;
+				if(arIsComp[ofst] == 1) continue;
+
+				double arCx[3];
+				for(int j=0; j<nNodX; j++)
+				{
+					double c = 1.;
+					for(int k=0; k<nNodX; k++) if(k != j) c *= ((double)(ix - arNodX[k]))/((double)(arNodX[j] - arNodX[k]));
+					arCx[j] = c;
+				}
+				double f = 0.;
+				for(int jz=0; jz<nNodZ; jz++)
+				{
+					float *tPow = pPow + arNodZ[jz]*nx;
+					double fz = 0.;
+					for(int jx=0; jx<nNodX; jx++) fz += arCx[jx]*tPow[arNodX[jx]];
+					f += arCz[jz]*fz;
+				}
+				pPow[ofst] = (float)((f > 0.)? f : 0.); //power density can't be negative
+				if(!arIsComp[ofst]) { arIsComp[ofst] = 2; NpFinG++;}
+			}
+		}
+		if(result = CompProgressInd.UpdateIndicator(NpFinG)) return result;
+	}
+	return 0;
+}
+
+//*************************************************************************
+
+int srTRadIntPowerDensity::ComputePowerDensityAtMeshPoint(long long ix, long long iz, srTPowDensStructAccessData& PowDensAccessData, char* arIsComp, srTCompProgressIndicator& CompProgressInd)
+{//Computes power density at point of observation mesh (without transformation of observation plane), if it was not computed yet
+	long long ofst = iz*DistrInfoDat.nx + ix;
+	if(arIsComp[ofst] == 1) return 0;
+
+	double xStep = (DistrInfoDat.nx > 1)? (DistrInfoDat.xEnd - DistrInfoDat.xStart)/(DistrInfoDat.nx - 1) : 0.;
+	double zStep = (DistrInfoDat.nz > 1)? (DistrInfoDat.zEnd - DistrInfoDat.zStart)/(DistrInfoDat.nz - 1) : 0.;
+	EXZ.x = DistrInfoDat.xStart + ix*xStep;
+	EXZ.z = DistrInfoDat.zStart + iz*zStep;
+	if(MagFieldIsConstG)
+	{
+		PobsLocG.x = EXZ.x; PobsLocG.y = 0.; PobsLocG.z = EXZ.z;
+		PobsLocG = TrLab2Loc.TrPoint(PobsLocG);
+	}
+
+	int result = 0;
+	float* pPowDens = PowDensAccessData.pBasePowDens + ofst;
+	if(result = ComputePowerDensityAtPoint(pPowDens)) return result;
+	if(!arIsComp[ofst]) NpFinG++; //point may have been interpolated in a neighboring cell before
+	arIsComp[ofst] = 1;
+	NpCompG++;
+	if(AdaptMaxValG < *pPowDens) AdaptMaxValG = *pPowDens;
+
+	if(result = srYield.Check()) return result;
+	return CompProgressInd.UpdateIndicator(NpFinG);
+}
+
+//*************************************************************************
+
 int srTRadIntPowerDensity::TryToReduceIntegLimits()
 {// call only if defined MagFieldIsConstG, LongIntTypeG, sIntegStartG, sIntegFinG
 	if(LongIntTypeG == 2) return 0;
@@ -24,6 +24,7 @@
 
 extern srTYield srYield;
 struct srTParPrecPowDens;
+class srTCompProgressIndicator;
 
 //*************************************************************************
 
@@ -32,6 +33,12 @@ struct srTRadIntPowDenPrec {
 	char Method; // 1- near-field, 2- far-field
 	char UseSpecIntLim; // 0- don't use; 1- use
 	double sStart, sFin;
+	double AdaptRelTol; // >0: observation mesh is refined adaptively with this relative tolerance
+};
+
+struct srTPowDensMeshCell { //cell of observation mesh (in terms of point indexes) for adaptive refinement
+	long long ix0, ix1, iz0, iz1;
+	int Lev;
 };
 
 //*************************************************************************
@@ -72,6 +79,11 @@ class srTRadIntPowerDensity {
 	TVector3d PobsLocG;
 	double BconG, RmaG;
 
+	long long NpCompG; // number of observation points at which power density was computed
+	int NumLevCompG; // number of mesh refinement levels used in adaptive mode
+	long long NpFinG; // number of observation points with final values (computed or interpolated), for progress indication in adaptive mode
+	double AdaptMaxValG;
+
 public:
 
 	srTGenTrjHndl TrjHndl;
@@ -97,6 +109,8 @@ public:
 
 	int ComputeTotalPowerDensityDistr(srTPowDensStructAccessData&);
 	int ComputePowerDensityAtPoint(float* pPowDens);
+	int ComputeTotalPowerDensityDistrAdapt(srTPowDensStructAccessData& PowDensAccessData, srTCompProgressIndicator& CompProgressInd);
+	int ComputePowerDensityAtMeshPoint(long long ix, long long iz, srTPowDensStructAccessData& PowDensAccessData, char* arIsComp, srTCompProgressIndicator& CompProgressInd);
 	int SetUpFieldBasedArrays();
 	void AnalizeFinalResultsSymmetry(char& FinalResAreSymOverX, char& FinalResAreSymOverZ);
 	void FillInSymPartsOfResults(char FinalResAreSymOverX, char FinalResAreSymOverZ, srTPowDensStructAccessData& PowDensAccessData);
@@ -15,6 +15,11 @@
 
 //*************************************************************************
 
+srTCompCtrl srTCompProgressIndicator::m_GlobCtrl;
+thread_local srTCompCtrl* srTCompProgressIndicator::m_pThreadCtrl = 0;
+
+//*************************************************************************
+
 int srTCompProgressIndicator::InitializeIndicator(long long InTotalAmOfOutPoints, double InUpdateTimeInt_s, char CountCallsInside)
 //int srTCompProgressIndicator::InitializeIndicator(long InTotalAmOfOutPoints, double InUpdateTimeInt_s, char CountCallsInside)
 {
@@ -36,14 +41,12 @@ int srTCompProgressIndicator::InitializeIndicator(long long InTotalAmOfOutPoints
 #endif
 #endif
 
-#ifdef _SRWDLL
-	if(pgCompProgressIndicFunc != 0) (*pgCompProgressIndicFunc)(0.);
-#endif
+	CallExtFunc(0.);
 
-	UpdateTimeInt = (clock_t)(CLOCKS_PER_SEC*InUpdateTimeInt_s);
+	UpdateTimeInt_ns = (long long)(1.e+09*InUpdateTimeInt_s);
 
-	StartCompClock = clock();
-	PrevUpdateClock = StartCompClock;
+	StartCompTime_ns = TimeNow_ns();
+	PrevUpdateTime_ns = StartCompTime_ns;
 
 	ProgressIndicatorIsUsed = 1;
 	PrevAmOfPoints = PrevAmOfPointsShown = 0;
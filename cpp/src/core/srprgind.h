@@ -15,18 +15,38 @@
 #define __SRPRGIND_H
 
 #include <time.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
 
 #ifdef __IGOR_PRO__
 #include "srigintr.h"
 #endif
 
+#include "srercode.h"
+
 #ifdef _SRWDLL
 extern int (*pgCompProgressIndicFunc)(double CurVal);
 #endif
 
 //*************************************************************************
 
+struct srTCompCtrl {
+//Control of long computations, shared by all threads working on them
+	std::atomic<int> AbortReq; //if nonzero, computations controlled by this structure return SR_COMP_PROC_ABORTED as soon as possible
+	int (*pProgrIndFunc)(double CurVal); //external progress indicator function
+
+	srTCompCtrl()
+	{
+		AbortReq = 0; pProgrIndFunc = 0;
+	}
+};
+
+//*************************************************************************
+
 class srTCompProgressIndicator {
+//Can be shared by threads of a parallel computation: abort requests can be checked and points can be counted (see srTCompProgressCounter) from any thread,
+//whereas the indicator itself (external function, IGOR Pro panel) is only updated from the thread which has created the object.
 
 #ifdef __IGOR_PRO__
 	char ProgressIndicatorWinName[256];
@@ -35,16 +55,39 @@ class srTCompProgressIndicator {
 	char ProgressIndicatorIsUsed, CallsAreCountedInside;
 	//long TotalAmOfOutPoints, PrevAmOfPoints, PrevAmOfPointsShown, CallsCount; //OC26042019
 	long long TotalAmOfOutPoints, PrevAmOfPoints, PrevAmOfPointsShown, CallsCount;
-	clock_t UpdateTimeInt, PrevUpdateClock, StartCompClock;
+	long long UpdateTimeInt_ns, PrevUpdateTime_ns, StartCompTime_ns; //steady clock is used instead of clock(), which counts CPU time of all threads
+
+	std::atomic<long long> m_AmOfPointsDone; //points counted by srTCompProgressCounter objects of all threads
+	srTCompCtrl* m_pCtrl; //control of the calling thread at construction (0 if it uses only the process-wide one)
+	std::thread::id m_OwnerThreadId;
+
+	void SetupControl()
+	{
+		m_pCtrl = m_pThreadCtrl; m_OwnerThreadId = std::this_thread::get_id();
+		m_AmOfPointsDone = 0;
+	}
+	void CallExtFunc(double NormIndVal)
+	{
+#ifdef _SRWDLL
+		if(pgCompProgressIndicFunc != 0) (*pgCompProgressIndicFunc)(NormIndVal);
+#else
+		int (*pFunc)(double) = ((m_pCtrl != 0) && (m_pCtrl->pProgrIndFunc != 0))? m_pCtrl->pProgrIndFunc : m_GlobCtrl.pProgrIndFunc;
+		if(pFunc != 0) (*pFunc)(NormIndVal);
+#endif
+	}
 
 public:
 
+	static srTCompCtrl m_GlobCtrl; //process-wide control
+	static thread_local srTCompCtrl* m_pThreadCtrl; //if set (see srwlUtiCtxSetCurrent), control of computations started by the calling thread
+
 	char ErrorCode;
 
 	//srTCompProgressIndicator(long InTotalAmOfOutPoints, double UpdateTimeInt_s, char CountCallsInside=0)
 	srTCompProgressIndicator(long long InTotalAmOfOutPoints, double UpdateTimeInt_s, char CountCallsInside=0)
 	{
 		ProgressIndicatorIsUsed = 0; ErrorCode = 0;
+		SetupControl();
 		if(InTotalAmOfOutPoints <= 0) return;
 
 		//ErrorCode = InitializeIndicator(InTotalAmOfOutPoints, UpdateTimeInt_s, CountCallsInside);
@@ -53,29 +96,43 @@ public:
 	srTCompProgressIndicator()
 	{
 		ProgressIndicatorIsUsed = 0; ErrorCode = 0;
+		SetupControl();
 	}
 	~srTCompProgressIndicator()
 	{
 		DestroyIndicator();
 	}
 
+	static long long TimeNow_ns()
+	{
+		return (long long)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	static bool AbortIsRequested(const srTCompCtrl* pCtrl)
+	{
+		if(m_GlobCtrl.AbortReq.load(std::memory_order_relaxed) != 0) return true;
+		return (pCtrl != 0) && (pCtrl->AbortReq.load(std::memory_order_relaxed) != 0);
+	}
+	bool AbortIsRequested() const { return AbortIsRequested(m_pCtrl);}
+
 	//int InitializeIndicator(long InTotalAmOfOutPoints, double UpdateTimeInt_s, char CountCallsInside=0);
 	int InitializeIndicator(long long InTotalAmOfOutPoints, double UpdateTimeInt_s, char CountCallsInside=0);
 
 	//int UpdateIndicator(long CurPoint=0)
 	int UpdateIndicator(long long CurPoint=0)
-	{
+	{//to be called from the thread which has created the object
 		int result = 0;
+		if(AbortIsRequested()) return SR_COMP_PROC_ABORTED;
 		if((!ProgressIndicatorIsUsed) || (ErrorCode != 0)) return 0;
 
 		if(CallsAreCountedInside) CurPoint = CallsCount;
 		
-		clock_t CurrentClock = clock();
-		if(CurrentClock < (UpdateTimeInt + PrevUpdateClock)) return 0;
+		long long CurrentTime_ns = TimeNow_ns();
+		if(CurrentTime_ns < (UpdateTimeInt_ns + PrevUpdateTime_ns)) return 0;
 
-		//CurPoint = EstimateCurrentPosition(CurrentClock, CurPoint);
+		//CurPoint = EstimateCurrentPosition(CurrentTime_ns, CurPoint);
 		//PrevAmOfPoints = CurPoint;
-		PrevUpdateClock = CurrentClock;
+		PrevUpdateTime_ns = CurrentTime_ns;
 		
 #ifdef __IGOR_PRO__
 #ifdef __VC__
@@ -93,17 +150,18 @@ public:
 		if(result = SpinProcess()) return result;
 #endif
 
-#ifdef _SRWDLL
-		if(pgCompProgressIndicFunc != 0) 
-		{
-			double NormIndVal = ((double)CurPoint)/((double)TotalAmOfOutPoints);
-			(*pgCompProgressIndicFunc)(NormIndVal);
-		}
-#endif
+		CallExtFunc(((double)CurPoint)/((double)TotalAmOfOutPoints));
 
 		if(CallsAreCountedInside) CallsCount++;
 		return result;
 	}
+
+	int AddPoints(long long AmOfPoints)
+	{//can be called from any thread, but is normally called via srTCompProgressCounter
+		long long CurPoint = m_AmOfPointsDone.fetch_add(AmOfPoints, std::memory_order_relaxed) + AmOfPoints;
+		if(std::this_thread::get_id() == m_OwnerThreadId) return UpdateIndicator(CurPoint);
+		return AbortIsRequested()? SR_COMP_PROC_ABORTED : 0;
+	}
 	
 	void DestroyIndicator()
 	{
@@ -118,26 +176,24 @@ public:
 #endif
 #endif
 
-#ifdef _SRWDLL
-		if(pgCompProgressIndicFunc != 0) (*pgCompProgressIndicFunc)(1.);
-#endif
+		CallExtFunc(1.);
 	}
 
 	//long EstimateCurrentPosition(clock_t CurrentClock, long CurPoint)
-	long long EstimateCurrentPosition(clock_t CurrentClock, long long CurPoint)
+	long long EstimateCurrentPosition(long long CurrentTime_ns, long long CurPoint)
 	{
-		clock_t TimePassed = CurrentClock - StartCompClock;
+		long long TimePassed_ns = CurrentTime_ns - StartCompTime_ns;
 
 		//double InvSpeed = double(CurrentClock - PrevUpdateClock)/double(CurPoint - PrevAmOfPoints);
-		double InvSpeed = double(TimePassed)/double(CurPoint);
+		double InvSpeed = double(TimePassed_ns)/double(CurPoint);
 
-		clock_t EstTimeLeft = (clock_t)(InvSpeed*double(TotalAmOfOutPoints - CurPoint));
+		long long EstTimeLeft_ns = (long long)(InvSpeed*double(TotalAmOfOutPoints - CurPoint));
 
 		//long EstCurPoint = long(TotalAmOfOutPoints*double(TimePassed)/double(EstTimeLeft + TimePassed));
-		long long EstCurPoint = (long long)(TotalAmOfOutPoints*double(TimePassed)/double(EstTimeLeft + TimePassed));
+		long long EstCurPoint = (long long)(TotalAmOfOutPoints*double(TimePassed_ns)/double(EstTimeLeft_ns + TimePassed_ns));
 		
 		PrevAmOfPoints = CurPoint;
-		PrevUpdateClock = CurrentClock;
+		PrevUpdateTime_ns = CurrentTime_ns;
 
 		if(PrevAmOfPointsShown < EstCurPoint) PrevAmOfPointsShown = EstCurPoint;
 		return PrevAmOfPointsShown;
@@ -146,4 +202,40 @@ public:
 
 //*************************************************************************
 
+class srTCompProgressCounter {
+//Counter of points processed by one thread of a parallel computation (to be declared in each thread, e.g. inside "omp parallel" region):
+//each call only checks abort request and increments the local count, which is passed to the shared indicator not more often than once per FlushTimeInt_ns.
+	srTCompProgressIndicator& m_Ind;
+	long long m_AmOfPoints, m_NextFlushTime_ns;
+
+public:
+
+	static const long long FlushTimeInt_ns = 10000000;
+
+	srTCompProgressCounter(srTCompProgressIndicator& Ind) : m_Ind(Ind)
+	{
+		m_AmOfPoints = 0;
+		m_NextFlushTime_ns = srTCompProgressIndicator::TimeNow_ns() + FlushTimeInt_ns;
+	}
+	~srTCompProgressCounter()
+	{
+		if(m_AmOfPoints > 0) m_Ind.AddPoints(m_AmOfPoints);
+	}
+
+	int Add(long long AmOfPoints=1)
+	{
+		if(m_Ind.AbortIsRequested()) return SR_COMP_PROC_ABORTED;
+		m_AmOfPoints += AmOfPoints;
+
+		long long CurrentTime_ns = srTCompProgressIndicator::TimeNow_ns();
+		if(CurrentTime_ns < m_NextFlushTime_ns) return 0;
+		m_NextFlushTime_ns = CurrentTime_ns + FlushTimeInt_ns;
+
+		AmOfPoints = m_AmOfPoints; m_AmOfPoints = 0;
+		return m_Ind.AddPoints(AmOfPoints);
+	}
+};
+
+//*************************************************************************
+
 #endif
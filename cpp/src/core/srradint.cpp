@@ -21,6 +21,7 @@
 #include "srmlttsk.h"
 #include "sroptelm.h"
 #include "srerror.h"
+#include "srwlprof.h"
 
 //*************************************************************************
 
@@ -85,6 +86,8 @@ void srTRadInt::Initialize()
 	DistrInfoDat.CoordUnits = 1; // To ensure mm for coord.
 
 	m_CalcResidTerminTerms = 1; // Do calculate residual terminating terms by default
+
+	m_PerLen = m_sPerStart = 0.; m_nPer = 0; m_nPerSamp = 5; m_NpCachedTrj = 0;
 }
 
 //*************************************************************************
@@ -2799,6 +2802,213 @@ int srTRadInt::RadIntegrationAuto2(double& OutIntXRe, double& OutIntXIm, double&
 
 //*************************************************************************
 
+int srTRadInt::RadIntegrationPeriodic(double& OutIntXRe, double& OutIntXIm, double& OutIntZRe, double& OutIntZIm)
+{//Integration over periodic part of the field: single-period integrals F_k are computed directly for some periods only;
+ //their envelopes G_k = F_k*exp(-i*Ph_k) (Ph_k is phase at the period start) vary slowly with k, so they are interpolated,
+ //while the phases Ph_k, which include effects of taper and phase errors, are evaluated for every period.
+ //The set of sample periods is refined (by halving intervals between them) until the interpolation is accurate enough.
+	if(m_vPerSegm.empty()) SetupPeriodicIntegr();
+
+	double LocRelPrec = 0.1*sIntegRelPrec;
+	double ActNormConst = (DistrInfoDat.TreatLambdaAsEnergyIn_eV)? NormalizingConst*ObsCoor.Lamb*0.80654658E-03 : NormalizingConst/ObsCoor.Lamb;
+	double PIm10e9_d_Lamb = (DistrInfoDat.TreatLambdaAsEnergyIn_eV)? PIm10e6dEnCon*ObsCoor.Lamb : PIm10e6*1000./ObsCoor.Lamb;
+
+	complex<double> IntX(0.,0.), IntZ(0.,0.), F[2];
+	int nEnd = (m_nPer > 0)? 2 : 1;
+	for(int i=0; i<nEnd; i++)
+	{
+		RadIntegrationSegm(m_vPerSegm[i], LocRelPrec, F);
+		IntX += F[0]; IntZ += F[1];
+	}
+
+	if(m_nPer > 0)
+	{
+		int nSamp = m_nPerSamp;
+		if(nSamp > m_nPer) nSamp = (int)m_nPer;
+		if(nSamp < 1) nSamp = 1;
+
+		vector<long> vK, vNewK;
+		vector<complex<double> > vG, vNewG;
+		vector<char> vStat, vNewStat; //state of interval after each sample period: 0- to refine, 1- interpolation check passed once, 2- passed twice (no refinement needed)
+		double AbsG, MaxAbsG = 0.;
+		for(int j=0; j<nSamp; j++)
+		{
+			long k = (nSamp > 1)? (long)(((double)j)*(m_nPer - 1)/(nSamp - 1) + 0.5) : (m_nPer >> 1);
+			PeriodEnvelope(k, LocRelPrec, PIm10e9_d_Lamb, F);
+			vK.push_back(k); vG.push_back(F[0]); vG.push_back(F[1]); vStat.push_back(0);
+			if(MaxAbsG < (AbsG = abs(F[0]) + abs(F[1]))) MaxAbsG = AbsG;
+		}
+
+		complex<double> GInt[2];
+		bool SampWereAdded = true;
+		while(SampWereAdded)
+		{
+			SampWereAdded = false;
+			int nK = (int)vK.size();
+			vNewK.clear(); vNewG.clear(); vNewStat.clear();
+			for(int i=0; i<nK; i++)
+			{
+				vNewK.push_back(vK[i]); vNewG.push_back(vG[2*i]); vNewG.push_back(vG[2*i + 1]); vNewStat.push_back(2);
+				if((i == nK - 1) || (vStat[i] == 2) || (vK[i + 1] - vK[i] < 2)) continue;
+
+				long km = (vK[i] + vK[i + 1]) >> 1;
+				PeriodEnvelope(km, LocRelPrec, PIm10e9_d_Lamb, F);
+				InterpPeriodEnvelope(km, i, vK, vG, GInt);
+				if(MaxAbsG < (AbsG = abs(F[0]) + abs(F[1]))) MaxAbsG = AbsG;
+				char IntervStat = 0;
+				if(abs(F[0] - GInt[0]) + abs(F[1] - GInt[1]) <= sIntegRelPrec*MaxAbsG) IntervStat = vStat[i] + 1; //requiring two successive passes, to avoid accidental matches on coarse sampling
+
+				vNewStat.back() = IntervStat;
+				vNewK.push_back(km); vNewG.push_back(F[0]); vNewG.push_back(F[1]); vNewStat.push_back(IntervStat);
+				SampWereAdded = true;
+			}
+			vK.swap(vNewK); vG.swap(vNewG); vStat.swap(vNewStat);
+		}
+
+		double CosPh, SinPh;
+		const double *pTrj = &(m_vPerStartTrj[0]);
+		int nK = (int)vK.size(), i = 0;
+		for(long k=0; k<m_nPer; k++)
+		{
+			while((i < nK - 2) && (k > vK[i + 1])) i++;
+			InterpPeriodEnvelope(k, i, vK, vG, GInt);
+
+			CosAndSin(PhaseFromTrj(m_sPerStart + k*m_PerLen, pTrj, PIm10e9_d_Lamb), CosPh, SinPh); pTrj += 6;
+			complex<double> ExpPh(CosPh, SinPh);
+			IntX += GInt[0]*ExpPh; IntZ += GInt[1]*ExpPh;
+		}
+	}
+
+	OutIntXRe += ActNormConst*IntX.real(); OutIntXIm += ActNormConst*IntX.imag();
+	OutIntZRe += ActNormConst*IntZ.real(); OutIntZIm += ActNormConst*IntZ.imag();
+	return 0;
+}
+
+//*************************************************************************
+
+void srTRadInt::SetupPeriodicIntegr()
+{//Sets up end segments and trajectory data at period starts; done once per trajectory
+	m_vPerSegm.clear(); m_vPerStartTrj.clear(); m_vPerSegmInd.clear(); m_NpCachedTrj = 0;
+	if((m_nPer <= 0) || (m_PerLen <= 0.))
+	{//no periodic part: integrating over the whole interval
+		long long NpInit = (m_PerLen > 0.)? NpPerPeriodInit*((long long)((sIntegFin - sIntegStart)/m_PerLen) + 1) : 64;
+		m_vPerSegm.push_back(srTRadIntPerSegm(sIntegStart, sIntegFin, NpInit));
+		m_nPer = 0; return;
+	}
+
+	double sPerFin = m_sPerStart + m_nPer*m_PerLen;
+	m_vPerSegm.push_back(srTRadIntPerSegm(sIntegStart, m_sPerStart, NpPerPeriodInit*((long long)((m_sPerStart - sIntegStart)/m_PerLen) + 1)));
+	m_vPerSegm.push_back(srTRadIntPerSegm(sPerFin, sIntegFin, NpPerPeriodInit*((long long)((sIntegFin - sPerFin)/m_PerLen) + 1)));
+
+	m_vPerSegmInd.assign(m_nPer, -1);
+	m_vPerStartTrj.resize(6*m_nPer);
+	double *pTrj = &(m_vPerStartTrj[0]);
+	for(long k=0; k<m_nPer; k++)
+	{
+		TrjDatPtr->CompTrjDataDerivedAtPoint(m_sPerStart + k*m_PerLen, pTrj[0], pTrj[1], pTrj[2], pTrj[3], pTrj[4], pTrj[5]); pTrj += 6;
+	}
+}
+
+//*************************************************************************
+
+void srTRadInt::PeriodEnvelope(long k, double RelPrec, double PIm10e9_d_Lamb, complex<double>* G)
+{//Single-period integral multiplied by exp(-i*Ph_k); integration segment (with cached trajectory data) is created at first call for a given period
+	double sk = m_sPerStart + k*m_PerLen;
+	if(m_vPerSegmInd[k] < 0)
+	{
+		m_vPerSegmInd[k] = (int)m_vPerSegm.size();
+		m_vPerSegm.push_back(srTRadIntPerSegm(sk, sk + m_PerLen, NpPerPeriodInit));
+	}
+	RadIntegrationSegm(m_vPerSegm[m_vPerSegmInd[k]], RelPrec, G);
+
+	double CosPh, SinPh;
+	CosAndSin(PhaseFromTrj(sk, &(m_vPerStartTrj[6*k]), PIm10e9_d_Lamb), CosPh, SinPh);
+	complex<double> ExpMiPh(CosPh, -SinPh);
+	G[0] *= ExpMiPh; G[1] *= ExpMiPh;
+}
+
+//*************************************************************************
+
+void srTRadInt::RadIntegrationSegm(srTRadIntPerSegm& Segm, double RelPrec, complex<double>* Int)
+{//Simpson integration (not normalized) of the radiation integrand over a segment with successive step halving;
+ //convergence is checked with respect to the integral itself, or (if it is small) to integral of the integrand modulus;
+ //trajectory data is computed only once for each level, as long as the total amount of cached data does not exceed MaxNpCachedTrj points
+	const int MaxHalvings = 16; //to steer
+	Int[0] = Int[1] = 0.;
+	double sSt = Segm.sSt, sFi = Segm.sFi;
+	if(sFi <= sSt) return;
+	long long Np = Segm.NpInit;
+	if(Np < 2) Np = Segm.NpInit = 2;
+
+	double PIm10e9_d_Lamb = (DistrInfoDat.TreatLambdaAsEnergyIn_eV)? PIm10e6dEnCon*ObsCoor.Lamb : PIm10e6*1000./ObsCoor.Lamb;
+	complex<double> F[2];
+	double h = (sFi - sSt)/Np;
+
+	if(Segm.vLevTrj.empty())
+	{
+		Segm.vLevTrj.push_back(vector<double>(6*(Np + 1)));
+		double *pTrj = &(Segm.vLevTrj[0][0]);
+		for(long long i=0; i<=Np; i++) { TrjDatPtr->CompTrjDataDerivedAtPoint(sSt + i*h, pTrj[0], pTrj[1], pTrj[2], pTrj[3], pTrj[4], pTrj[5]); pTrj += 6;}
+		m_NpCachedTrj += Np + 1;
+	}
+	const double *pTrj = &(Segm.vLevTrj[0][0]);
+
+	FunForRadIntFromTrj(sSt, pTrj, PIm10e9_d_Lamb, F);
+	complex<double> EdgeX = 0.5*F[0], EdgeZ = 0.5*F[1];
+	double EdgeAbs = 0.5*(abs(F[0]) + abs(F[1]));
+	FunForRadIntFromTrj(sFi, pTrj + 6*Np, PIm10e9_d_Lamb, F);
+	EdgeX += 0.5*F[0]; EdgeZ += 0.5*F[1]; EdgeAbs += 0.5*(abs(F[0]) + abs(F[1]));
+
+	complex<double> InnerX(0.,0.), InnerZ(0.,0.);
+	double InnerAbs = 0.;
+	for(long long i=1; i<Np; i++)
+	{
+		FunForRadIntFromTrj(sSt + i*h, pTrj + 6*i, PIm10e9_d_Lamb, F);
+		InnerX += F[0]; InnerZ += F[1]; InnerAbs += abs(F[0]) + abs(F[1]);
+	}
+	complex<double> TrapX = h*(EdgeX + InnerX), TrapZ = h*(EdgeZ + InnerZ);
+	complex<double> SimpX(0.,0.), SimpZ(0.,0.), PrevSimpX, PrevSimpZ;
+
+	for(int iLev=1; iLev<=MaxHalvings; iLev++)
+	{
+		double sMid = sSt + 0.5*h;
+		if(((int)Segm.vLevTrj.size() == iLev) && (m_NpCachedTrj + Np <= MaxNpCachedTrj))
+		{
+			Segm.vLevTrj.push_back(vector<double>(6*Np));
+			double *pNewTrj = &(Segm.vLevTrj[iLev][0]);
+			for(long long i=0; i<Np; i++) { TrjDatPtr->CompTrjDataDerivedAtPoint(sMid + i*h, pNewTrj[0], pNewTrj[1], pNewTrj[2], pNewTrj[3], pNewTrj[4], pNewTrj[5]); pNewTrj += 6;}
+			m_NpCachedTrj += Np;
+		}
+		pTrj = ((int)Segm.vLevTrj.size() > iLev)? &(Segm.vLevTrj[iLev][0]) : 0; //0 if the level is not cached
+
+		complex<double> MidX(0.,0.), MidZ(0.,0.);
+		double MidAbs = 0., arTrj[6];
+		for(long long i=0; i<Np; i++)
+		{
+			double s = sMid + i*h;
+			if(pTrj == 0) TrjDatPtr->CompTrjDataDerivedAtPoint(s, arTrj[0], arTrj[1], arTrj[2], arTrj[3], arTrj[4], arTrj[5]);
+			FunForRadIntFromTrj(s, (pTrj != 0)? (pTrj + 6*i) : arTrj, PIm10e9_d_Lamb, F);
+			MidX += F[0]; MidZ += F[1]; MidAbs += abs(F[0]) + abs(F[1]);
+		}
+		h *= 0.5; Np <<= 1;
+		InnerX += MidX; InnerZ += MidZ; InnerAbs += MidAbs;
+
+		complex<double> NewTrapX = h*(EdgeX + InnerX), NewTrapZ = h*(EdgeZ + InnerZ);
+		PrevSimpX = SimpX; PrevSimpZ = SimpZ;
+		SimpX = (4.*NewTrapX - TrapX)/3.; SimpZ = (4.*NewTrapZ - TrapZ)/3.;
+		TrapX = NewTrapX; TrapZ = NewTrapZ;
+
+		if(iLev > 1)
+		{
+			double IntAbs = h*(EdgeAbs + InnerAbs);
+			if(abs(SimpX - PrevSimpX) + abs(SimpZ - PrevSimpZ) <= RelPrec*(abs(SimpX) + abs(SimpZ) + RelPrec*IntAbs)) break;
+		}
+	}
+	Int[0] = SimpX; Int[1] = SimpZ;
+}
+
+//*************************************************************************
+
 //int srTRadInt::FillNextLevelPart(int LevelNo, double sStart, double sEnd, long Np, double*** TrjPtrs)
 int srTRadInt::FillNextLevelPart(int LevelNo, double sStart, double sEnd, long long Np, double*** TrjPtrs)
 {
@@ -3551,6 +3761,7 @@ int srTRadInt::RadInterpolationOnePointXZ(srTEFourierVect* pEwVect, int ixOffset
 void srTRadInt::ComputeElectricFieldFreqDomain(srTTrjDat* pTrjDat, srTWfrSmp* pWfrSmp, srTParPrecElecFld* pPrecElecFld, srTSRWRadStructAccessData* pWfr, char showProgressInd)
 {
 	if((pTrjDat == 0) || (pWfrSmp == 0) || (pPrecElecFld == 0) || (pWfr == 0)) throw INCORRECT_PARAMS_SR_COMP;
+	CSRWLProfScope profScope(srwlProfRadInteg);
 	int res = 0;
 
 	Initialize();
@@ -3558,6 +3769,7 @@ void srTRadInt::ComputeElectricFieldFreqDomain(srTTrjDat* pTrjDat, srTWfrSmp* pW
 	DistrInfoDat = *pWfrSmp;
 	DistrInfoDat.EnsureZeroTransverseRangesForSinglePoints();
 	pWfr->SetRadSamplingFromObs(DistrInfoDat);
+	profScope.AddBytes(((long long)pWfr->ne)*((long long)pWfr->nx)*((long long)pWfr->nz)*4*sizeof(float));
 
 	TrjDataContShouldBeRebuild = 1;
 	SetInputTrjData(pTrjDat);
@@ -3596,6 +3808,11 @@ void srTRadInt::SetPrecParams(srTParPrecElecFld* pPrecElecFld)
         sIntegMethod = 11;
         sIntegRelPrec = pPrecElecFld->RelPrecOrStep;
 	}
+	else if(MethNo == 3)
+	{
+        sIntegMethod = 20;
+        sIntegRelPrec = pPrecElecFld->RelPrecOrStep;
+	}
 
 	sIntegStart = TrjDatPtr->sStart;
 	sIntegFin = TrjDatPtr->sStart + TrjDatPtr->sStep*(TrjDatPtr->LenFieldData - 1);
@@ -3611,6 +3828,23 @@ void srTRadInt::SetPrecParams(srTParPrecElecFld* pPrecElecFld)
 	TryToApplyNearFieldResidual_AtRight = 0; // because it's buggy
 
 	m_CalcResidTerminTerms = pPrecElecFld->CalcTerminTerms;
+
+	if(sIntegMethod == 20)
+	{//keeping only the periods which are entirely within the integration limits
+		m_PerLen = pPrecElecFld->PerLen; m_sPerStart = pPrecElecFld->sPerStart; m_nPer = pPrecElecFld->nPer;
+		m_vPerSegm.clear(); //trajectory data cached for previous trajectory is not valid any more
+		if(pPrecElecFld->nPerSamp > 0) m_nPerSamp = pPrecElecFld->nPerSamp;
+		if((m_PerLen > 0.) && (m_nPer > 0))
+		{
+			if(m_sPerStart < sIntegStart)
+			{
+				long nSkip = (long)ceil((sIntegStart - m_sPerStart)/m_PerLen - 1.e-09);
+				m_sPerStart += nSkip*m_PerLen; m_nPer -= nSkip;
+			}
+			if(m_sPerStart + m_nPer*m_PerLen > sIntegFin) m_nPer = (long)floor((sIntegFin - m_sPerStart)/m_PerLen + 1.e-09);
+		}
+		if(m_nPer < 0) m_nPer = 0;
+	}
 }
 
 //*************************************************************************
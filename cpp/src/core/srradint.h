@@ -41,6 +41,16 @@ struct srTParPrecElecFld;
 
 //*************************************************************************
 
+struct srTRadIntPerSegm { //integration segment of the "periodic" method, with trajectory data cached at all levels of step halving
+	double sSt, sFi;
+	long long NpInit;
+	vector<vector<double> > vLevTrj; //Btx, x, IntBtxE2, Btz, z, IntBtzE2 at points added on each level
+
+	srTRadIntPerSegm(double In_sSt=0., double In_sFi=0., long long In_NpInit=2) { sSt = In_sSt; sFi = In_sFi; NpInit = In_NpInit;}
+};
+
+//*************************************************************************
+
 class srTRadInt {
 
 	double* IntegSubdArray;
@@ -90,6 +100,16 @@ class srTRadInt {
 	double EstimatedAbsoluteTolerance;
 	char m_CalcResidTerminTerms;
 
+	double m_PerLen, m_sPerStart; //periodic part of the field, for sIntegMethod == 20
+	long m_nPer;
+	int m_nPerSamp;
+	static const long long NpPerPeriodInit = 8; //initial number of integration intervals per period; to steer
+	vector<srTRadIntPerSegm> m_vPerSegm; //end segments and sample periods
+	vector<double> m_vPerStartTrj; //trajectory data at starts of all periods
+	vector<int> m_vPerSegmInd; //indexes of segments in m_vPerSegm for periods at which single-period integrals were computed (-1 if not computed)
+	long long m_NpCachedTrj; //total number of points with trajectory data cached in m_vPerSegm
+	static const long long MaxNpCachedTrj = 1 << 20; //max. number of cached trajectory points (6 doubles each); finer levels are computed on the fly; to steer
+
 public:
 
 	srTSend* pSend;
@@ -179,6 +199,13 @@ public:
 	//int RadIntegrationAuto1M(double sStart, double sEnd, double* FunArr, double* EdgeDerArr, int AmOfInitPo, int NextLevNo, double& OutIntXRe, double& OutIntXIm, double& OutIntZRe, double& OutIntZIm);
 	int RadIntegrationAuto1M(double sStart, double sEnd, double* FunArr, double* EdgeDerArr, long long AmOfInitPo, int NextLevNo, double& OutIntXRe, double& OutIntXIm, double& OutIntZRe, double& OutIntZIm);
 	int RadIntegrationAuto2(double&, double&, double&, double&, srTEFourier*);
+	int RadIntegrationPeriodic(double&, double&, double&, double&);
+	void SetupPeriodicIntegr();
+	void PeriodEnvelope(long k, double RelPrec, double PIm10e9_d_Lamb, complex<double>* G);
+	inline void InterpPeriodEnvelope(long k, int i, vector<long>& vK, vector<complex<double> >& vG, complex<double>* G);
+	void RadIntegrationSegm(srTRadIntPerSegm& Segm, double RelPrec, complex<double>* Int);
+	inline void FunForRadIntFromTrj(double s, const double* pTrj, double PIm10e9_d_Lamb, complex<double>* F);
+	inline double PhaseFromTrj(double s, const double* pTrj, double PIm10e9_d_Lamb);
 
 	inline void CosAndSin(double x, double& Cos, double& Sin);
 
@@ -379,6 +406,7 @@ inline int srTRadInt::GenRadIntegration(complex<double>* RadIntegValues, srTEFou
 	}
 	else if(sIntegMethod == 10) { if(result = RadIntegrationAuto1(IntXRe, IntXIm, IntZRe, IntZIm, &EwNormDer)) return result;}
 	else if(sIntegMethod == 11) { if(result = RadIntegrationAuto2(IntXRe, IntXIm, IntZRe, IntZIm, &EwNormDer)) return result;}
+	else if(sIntegMethod == 20) { if(result = RadIntegrationPeriodic(IntXRe, IntXIm, IntZRe, IntZIm)) return result;}
 
 	complex<double> IntX(IntXRe, IntXIm), IntZ(IntZRe, IntZIm);
 	*(RadIntegValues++) = IntX;
@@ -920,6 +948,68 @@ inline void srTRadInt::FunForRadInt(double sArg, complex<double>* FunPtr)
 
 //*************************************************************************
 
+inline double srTRadInt::PhaseFromTrj(double sArg, const double* pTrj, double PIm10e9_d_Lamb)
+{// Phase of the radiation integrand, with trajectory data (Btx, x, IntBtxE2, Btz, z, IntBtzE2) supplied
+	double xObs = ObsCoor.x, zObs = ObsCoor.z;
+	if(DistrInfoDat.CoordOrAngPresentation == CoordPres)
+	{
+		double xObs_mi_x = xObs - pTrj[1], zObs_mi_z = zObs - pTrj[4];
+		return PIm10e9_d_Lamb*(sArg*TrjDatPtr->EbmDat.GammaEm2 + pTrj[2] + pTrj[5] + (xObs_mi_x*xObs_mi_x + zObs_mi_z*zObs_mi_z)/(ObsCoor.y - sArg));
+	}
+	else return PIm10e9_d_Lamb*(sArg*(TrjDatPtr->EbmDat.GammaEm2 + xObs*xObs + zObs*zObs) + pTrj[2] + pTrj[5] - 2.*(xObs*pTrj[1] + zObs*pTrj[4]));
+}
+
+//*************************************************************************
+
+inline void srTRadInt::FunForRadIntFromTrj(double sArg, const double* pTrj, double PIm10e9_d_Lamb, complex<double>* FunPtr)
+{// Same as FunForRadInt, but with trajectory data (Btx, x, IntBtxE2, Btz, z, IntBtzE2) supplied
+	double Phase, Btx = pTrj[0], Crdx = pTrj[1], IntBtE2x = pTrj[2], Btz = pTrj[3], Crdz = pTrj[4], IntBtE2z = pTrj[5];
+	double xObs = ObsCoor.x, zObs = ObsCoor.z;
+	double CosPhase, SinPhase;
+
+	if(DistrInfoDat.CoordOrAngPresentation == CoordPres)
+	{
+		double One_d_ymis = 1./(ObsCoor.y - sArg);
+		double xObs_mi_x = xObs - Crdx, zObs_mi_z = zObs - Crdz;
+		Phase = PIm10e9_d_Lamb*(sArg*TrjDatPtr->EbmDat.GammaEm2 + IntBtE2x + IntBtE2z + (xObs_mi_x*xObs_mi_x + zObs_mi_z*zObs_mi_z)*One_d_ymis);
+		CosAndSin(Phase, CosPhase, SinPhase);
+
+		double BufPreExpReX = One_d_ymis*(Btx - xObs_mi_x*One_d_ymis);
+		double BufPreExpReZ = One_d_ymis*(Btz - zObs_mi_z*One_d_ymis);
+		FunPtr[0] = complex<double>(BufPreExpReX*CosPhase, BufPreExpReX*SinPhase);
+		FunPtr[1] = complex<double>(BufPreExpReZ*CosPhase, BufPreExpReZ*SinPhase);
+	}
+	else
+	{
+		Phase = PIm10e9_d_Lamb*(sArg*(TrjDatPtr->EbmDat.GammaEm2 + xObs*xObs + zObs*zObs) + IntBtE2x + IntBtE2z - 2.*(xObs*Crdx + zObs*Crdz));
+		CosAndSin(Phase, CosPhase, SinPhase);
+
+		double Btx_mi_HorAng = Btx - xObs, Btz_mi_HorAng = Btz - zObs;
+		FunPtr[0] = complex<double>(Btx_mi_HorAng*CosPhase, Btx_mi_HorAng*SinPhase);
+		FunPtr[1] = complex<double>(Btz_mi_HorAng*CosPhase, Btz_mi_HorAng*SinPhase);
+	}
+}
+
+//*************************************************************************
+
+inline void srTRadInt::InterpPeriodEnvelope(long k, int i, vector<long>& vK, vector<complex<double> >& vG, complex<double>* G)
+{// Local (up to 3rd order) Lagrange interpolation of period envelopes vG (x and z interleaved) known at periods vK; vK[i] <= k <= vK[i+1]
+	int nK = (int)vK.size();
+	int iSt = i - 1, iFi = i + 2;
+	if(iSt < 0) iSt = 0;
+	if(iFi > nK - 1) iFi = nK - 1;
+	G[0] = G[1] = 0.;
+	double dk = (double)k;
+	for(int j=iSt; j<=iFi; j++)
+	{
+		double w = 1., dkj = (double)vK[j];
+		for(int jj=iSt; jj<=iFi; jj++) if(jj != j) w *= (dk - vK[jj])/(dkj - vK[jj]);
+		G[0] += w*vG[2*j]; G[1] += w*vG[2*j + 1];
+	}
+}
+
+//*************************************************************************
+
 inline void srTRadInt::AxAzPhNearField(double sArg, double& Ax, double& Az, double& Ph)
 {
 	double Btx=0., Btz=0., Crdx=0., Crdz=0., IntBtE2x=0., IntBtE2z=0.;
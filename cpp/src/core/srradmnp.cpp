@@ -20,6 +20,8 @@
 #include "srradint.h"
 #include "srerror.h"
 
+#include <algorithm>
+
 #ifdef _WITH_OMPH //Pre-processor definition for compiling with OpenMP library
 #include "omp.h"
 #endif
@@ -779,6 +781,49 @@ int srTRadGenManip::ExtractSingleElecIntensity2DvsXZ(srTRadExtract& RadExtract,
 	}
 	else
 #endif
+	if((!intOverEnIsRequired) && ((Int_or_ReE == 0) || (Int_or_ReE == 1)) && EhOK && EvOK)
+	{//Specialized kernels: polarization component is selected once per call, rows are treated in parallel
+		long long ie0PerE = ie0 << 1, ie1PerE = ie1 << 1;
+
+#ifdef _WITH_OMP
+		#pragma omp parallel for
+#endif
+		for(long long iz=0; iz<nz; iz++)
+		{
+			long long izPerZ = iz*PerZ;
+			float *pEx_St = pEx0 + izPerZ + ie0PerE, *pEx_Fi = pEx0 + izPerZ + ie1PerE;
+			float *pEz_St = pEz0 + izPerZ + ie0PerE, *pEz_Fi = pEz0 + izPerZ + ie1PerE;
+			long long ofstI = iz*nx;
+
+			if(allStokesReq)
+			{
+				float *arPtrI[] = {0,0,0,0};
+				double *arPtrId[] = {0,0,0,0};
+				if(pI != 0) { arPtrI[0] = pI + ofstI; arPtrI[1] = pI1 + ofstI; arPtrI[2] = pI2 + ofstI; arPtrI[3] = pI3 + ofstI;}
+				if(pId != 0) { arPtrId[0] = pId + ofstI; arPtrId[1] = pI1d + ofstI; arPtrId[2] = pI2d + ofstI; arPtrId[3] = pI3d + ofstI;}
+				ExtractSingleElecStokesRowXZ(pEx_St, pEx_Fi, pEz_St, pEz_Fi, PerX, nx, InvStepRelArg, iter, inv_iter_p_1, arPtrI, arPtrId);
+			}
+			else
+			{
+				float *pIrow = (pI != 0)? (pI + ofstI) : 0;
+				double *pIdRow = (pId != 0)? (pId + ofstI) : 0;
+				switch(PolCom)
+				{
+					case 0: ExtractSingleElecIntensityRowXZ<0>(pEx_St, pEx_Fi, pEz_St, pEz_Fi, PerX, nx, InvStepRelArg, iter, inv_iter_p_1, pIrow, pIdRow); break;
+					case 1: ExtractSingleElecIntensityRowXZ<1>(pEx_St, pEx_Fi, pEz_St, pEz_Fi, PerX, nx, InvStepRelArg, iter, inv_iter_p_1, pIrow, pIdRow); break;
+					case 2: ExtractSingleElecIntensityRowXZ<2>(pEx_St, pEx_Fi, pEz_St, pEz_Fi, PerX, nx, InvStepRelArg, iter, inv_iter_p_1, pIrow, pIdRow); break;
+					case 3: ExtractSingleElecIntensityRowXZ<3>(pEx_St, pEx_Fi, pEz_St, pEz_Fi, PerX, nx, InvStepRelArg, iter, inv_iter_p_1, pIrow, pIdRow); break;
+					case 4: ExtractSingleElecIntensityRowXZ<4>(pEx_St, pEx_Fi, pEz_St, pEz_Fi, PerX, nx, InvStepRelArg, iter, inv_iter_p_1, pIrow, pIdRow); break;
+					case 5: ExtractSingleElecIntensityRowXZ<5>(pEx_St, pEx_Fi, pEz_St, pEz_Fi, PerX, nx, InvStepRelArg, iter, inv_iter_p_1, pIrow, pIdRow); break;
+					case -2: ExtractSingleElecIntensityRowXZ<-2>(pEx_St, pEx_Fi, pEz_St, pEz_Fi, PerX, nx, InvStepRelArg, iter, inv_iter_p_1, pIrow, pIdRow); break;
+					case -3: ExtractSingleElecIntensityRowXZ<-3>(pEx_St, pEx_Fi, pEz_St, pEz_Fi, PerX, nx, InvStepRelArg, iter, inv_iter_p_1, pIrow, pIdRow); break;
+					case -4: ExtractSingleElecIntensityRowXZ<-4>(pEx_St, pEx_Fi, pEz_St, pEz_Fi, PerX, nx, InvStepRelArg, iter, inv_iter_p_1, pIrow, pIdRow); break;
+					default: ExtractSingleElecIntensityRowXZ<6>(pEx_St, pEx_Fi, pEz_St, pEz_Fi, PerX, nx, InvStepRelArg, iter, inv_iter_p_1, pIrow, pIdRow); //total, s0
+				}
+			}
+		}
+	}
+	else
 	{
 		long long izPerZ = 0;
 		for(long long iz=0; iz<nz; iz++) //OC18042020
@@ -2484,15 +2529,11 @@ int srTRadGenManip::ComputeMultiElecMutualIntensityVsXZ(srTRadExtract& RadExtrac
 
 int srTRadGenManip::ComputeConvolutedIntensity(srTRadExtract& RadExtract)
 {
-	int result;
 	srTSRWRadStructAccessData& RadAccessData = *((srTSRWRadStructAccessData*)(hRadAccessData.ptr()));
 
 	if((RadAccessData.nx == 1) || (RadAccessData.nz == 1)) return NEEDS_MORE_THAN_ONE_HOR_AND_VERT_OBS_POINT;
 	int PT = RadExtract.PlotType;
 
-	srTRadExtract OwnRadExtract = RadExtract;
-	float* pTempStorage = 0;
-
 	long Nx = RadAccessData.nx;
 	long Nz = RadAccessData.nz;
 	//long long Nx = RadAccessData.nx; //OC26042019
@@ -2504,102 +2545,212 @@ int srTRadGenManip::ComputeConvolutedIntensity(srTRadExtract& RadExtract)
 
 	//long TotAmOfNewData = (Nx*Nz) << 1;
 	long long TotAmOfNewData = (((long long)Nx)*((long long)Nz)) << 1;
-
-	pTempStorage = new float[TotAmOfNewData];
-	if(pTempStorage == 0) return MEMORY_ALLOCATION_FAILURE;
-
-	OwnRadExtract.pExtractedData = pTempStorage;
-	OwnRadExtract.PlotType = 3; // vs x&z
+	long long NxNzOld = ((long long)(RadAccessData.nx))*((long long)(RadAccessData.nz));
 
 	//long Ne = RadAccessData.ne;
 	long long Ne = RadAccessData.ne; //OC26042019
-	OwnRadExtract.ePh = RadAccessData.eStart;
-
 	char SinglePhotonEnergy = ((PT == 1) || (PT == 2) || (PT == 3));
-	if(SinglePhotonEnergy) 
-	{
-		Ne = 1; OwnRadExtract.ePh = RadExtract.ePh;
-	}
+	if(SinglePhotonEnergy) Ne = 1;
 
 	int nComp = 1; //OC29122023
 	long long ofstCmp = 0; //OC29122023
-	float *pDataOrig = RadExtract.pExtractedData; //OC29122023
-	double *pdDataOrig = RadExtract.pExtractedDataD; //OC29122023
-	if(OwnRadExtract.PolarizCompon == -5) //OC29122023 //Proc. all Stokes components
+	if(RadExtract.PolarizCompon == -5) //OC29122023 //Proc. all Stokes components
 	{
-		nComp = 4;
-		OwnRadExtract.PolarizCompon = -1; //Proc. each Stokes component separately
-		ofstCmp = ((long long)(RadAccessData.nx))*((long long)(RadAccessData.nz));
+		nComp = 4; //Proc. each Stokes component separately
+		ofstCmp = NxNzOld;
 	}
 
-	for(long long ie=0; ie<Ne; ie++) //OC26042019
-	//for(long ie=0; ie<Ne; ie++)
+	//The e-beam kernel does not depend on photon energy / component: it is computed once
+	std::vector<float> vKernX, vKernZ;
+	float *arKernX = 0, *arKernZ = 0;
+	if(RadAccessData.pElecBeam != 0)
 	{
-		if(pDataOrig != 0) RadExtract.pExtractedData = pDataOrig; //OC29122023
-		else if(pdDataOrig != 0) RadExtract.pExtractedDataD = pdDataOrig; //OC29122023
+		vKernX.resize(Nx); vKernZ.resize(Nz);
+		arKernX = &vKernX[0]; arKernZ = &vKernZ[0];
+		SetupElecBeamConvKernel(Nx, Nz, arKernX, arKernZ);
+	}
+	else CErrWarn::AddWarningMessage(&gVectWarnNos, SINGLE_E_EXTRACTED_INSTEAD_OF_MULTI);
+
+	//Real intensity distributions (for different photon energies / Stokes components) are convolved with a real and even kernel,
+	//therefore two of them are packed into Re and Im parts of one complex array, and transformed by one complex FFT
+	long long nSlices = Ne*nComp;
+	long long nPairs = (nSlices + 1) >> 1;
+	int result = 0;
+
+#ifndef _WITH_OMP
+	float *pCmplData = new float[TotAmOfNewData];
+	float *pRealSlice = new float[NxNzOld];
+	if((pCmplData == 0) || (pRealSlice == 0)) result = MEMORY_ALLOCATION_FAILURE;
 
-		for(int polComp=0; polComp<nComp; polComp++) //OC29122023
+	for(long long iPair=0; iPair<nPairs; iPair++)
+	{
+		if(result) break;
+		result = ConvolutePairOfIntensSlices(iPair, nSlices, nComp, ofstCmp, Nx, Nz, pCmplData, pRealSlice, arKernX, arKernZ, RadExtract);
+	}
+	if(pCmplData != 0) delete[] pCmplData;
+	if(pRealSlice != 0) delete[] pRealSlice;
+#else
+	//Creation of FFTW plans is not thread-safe: this is done outside of threads, under the planner lock (other contexts may create plans at the same time);
+	//the plans are destroyed on any exit
+	struct TPlans2DFFT {
+		fftwnd_plan Frw, Bckw;
+		TPlans2DFFT(long Nz, long Nx)
 		{
-			if(result = ExtractSingleElecIntensity2DvsXZ(OwnRadExtract)) return result;
-			if(result = ConvoluteWithElecBeamOverTransvCoord(OwnRadExtract.pExtractedData, Nx, Nz)) return result;
+			std::lock_guard<std::mutex> lck(CGenMathFFT::MutexPlan());
+			Frw = fftw2d_create_plan(Nz, Nx, FFTW_FORWARD, FFTW_IN_PLACE|FFTW_THREADSAFE);
+			Bckw = fftw2d_create_plan(Nz, Nx, FFTW_BACKWARD, FFTW_IN_PLACE|FFTW_THREADSAFE);
+		}
+		~TPlans2DFFT()
+		{
+			std::lock_guard<std::mutex> lck(CGenMathFFT::MutexPlan());
+			if(Frw != 0) fftwnd_destroy_plan(Frw);
+			if(Bckw != 0) fftwnd_destroy_plan(Bckw);
+		}
+	} Plans2DFFT(Nz, Nx);
+
+	std::vector<int> pair_results(nPairs, 0);
 
-			//long ie0 = ie;
-			long long ie0 = ie; //OC26042019
-			if(SinglePhotonEnergy && (RadAccessData.ne > 1))
+	#pragma omp parallel
+	{
+		float *pCmplData = new float[TotAmOfNewData];
+		float *pRealSlice = new float[NxNzOld];
+		if((pCmplData != 0) && (pRealSlice != 0))
+		{
+			#pragma omp for schedule(dynamic)
+			for(long long iPair=0; iPair<nPairs; iPair++)
 			{
-				//long ie1;
-				long long ie1; //OC26042019
-				double RelArgE_Dummy;
-				SetupIntCoord('e', OwnRadExtract.ePh, ie0, ie1, RelArgE_Dummy);
+				pair_results[iPair] = ConvolutePairOfIntensSlices(iPair, nSlices, nComp, ofstCmp, Nx, Nz, pCmplData, pRealSlice, arKernX, arKernZ, RadExtract, &(Plans2DFFT.Frw), &(Plans2DFFT.Bckw));
 			}
+		}
+		else
+		{
+			#pragma omp critical
+			result = MEMORY_ALLOCATION_FAILURE;
+		}
+		if(pCmplData != 0) delete[] pCmplData;
+		if(pRealSlice != 0) delete[] pRealSlice;
+	}
+
+	for(long long iPair=0; iPair<nPairs; iPair++)
+	{
+		if(result) break;
+		result = pair_results[iPair];
+	}
+#endif
+	return result;
+}
+
+//*************************************************************************
+
+int srTRadGenManip::ConvolutePairOfIntensSlices(long long iPair, long long nSlices, int nComp, long long ofstCmp, long Nx, long Nz, float* pCmplData, float* pRealSlice, float* arKernX, float* arKernZ, srTRadExtract& RadExtract, void* pvFrwPlan, void* pvBckwPlan)
+{//Slice index is: is = ie*nComp + iComp; slices 2*iPair and 2*iPair+1 go to Re and Im parts of pCmplData
+	int result;
+	srTSRWRadStructAccessData& RadAccessData = *((srTSRWRadStructAccessData*)(hRadAccessData.ptr()));
+
+	char SinglePhotonEnergy = ((RadExtract.PlotType == 1) || (RadExtract.PlotType == 2) || (RadExtract.PlotType == 3));
 
-			PutConstPhotEnergySliceInExtractPlace(ie0, Nx, Nz, OwnRadExtract, RadExtract);
+	srTRadExtract OwnRadExtract = RadExtract;
+	OwnRadExtract.pExtractedData = pRealSlice;
+	OwnRadExtract.PlotType = 3; // vs x&z
 
-			if(pDataOrig != 0) RadExtract.pExtractedData += ofstCmp; //OC29122023
-			else if(pdDataOrig != 0) RadExtract.pExtractedDataD += ofstCmp; //OC29122023
-			//OwnRadExtract.ePh += RadAccessData.eStep; //OC29122023 (moved outside of this loop)
+	long long is0 = iPair << 1;
+	float arNorm[] = {1.f, 1.f};
+	for(int iReIm=0; iReIm<2; iReIm++)
+	{
+		long long is = is0 + iReIm;
+		if(is < nSlices)
+		{
+			long long ie = is/nComp;
+			int iComp = (int)(is - ie*nComp);
+			OwnRadExtract.ePh = SinglePhotonEnergy? RadExtract.ePh : (RadAccessData.eStart + ie*RadAccessData.eStep);
+			if(nComp > 1) OwnRadExtract.PolarizCompon = -1 - iComp;
 
-			OwnRadExtract.PolarizCompon--; //OC29122023 (all lines below were just moved into this loop)
+			if(result = ExtractSingleElecIntensity2DvsXZ(OwnRadExtract)) return result;
+			arNorm[iReIm] = PackRealSliceToCmplData(pCmplData, pRealSlice, Nx, Nz, iReIm);
 		}
-		OwnRadExtract.ePh += RadAccessData.eStep; //OC29122023
+		else PackRealSliceToCmplData(pCmplData, 0, Nx, Nz, iReIm);
 	}
 
-	if(pTempStorage != 0) delete[] pTempStorage;
+	if((arKernX != 0) && (arKernZ != 0))
+	{
+		if(result = ConvoluteWithElecBeamKernel(pCmplData, Nx, Nz, arKernX, arKernZ, pvFrwPlan, pvBckwPlan)) return result;
+	}
+
+	float *tData = pCmplData;
+	long long NxNz = ((long long)Nx)*((long long)Nz);
+	for(long long i=0; i<NxNz; i++)
+	{
+		*(tData++) *= arNorm[0]; *(tData++) *= arNorm[1];
+	}
+
+	for(int iReIm=0; iReIm<2; iReIm++)
+	{
+		long long is = is0 + iReIm;
+		if(is >= nSlices) break;
+
+		long long ie = is/nComp;
+		int iComp = (int)(is - ie*nComp);
+
+		//long ie0 = ie;
+		long long ie0 = ie; //OC26042019
+		if(SinglePhotonEnergy && (RadAccessData.ne > 1))
+		{
+			//long ie1;
+			long long ie1; //OC26042019
+			double RelArgE_Dummy;
+			SetupIntCoord('e', RadExtract.ePh, ie0, ie1, RelArgE_Dummy);
+		}
+
+		srTRadExtract LocRadExtract = RadExtract;
+		if(LocRadExtract.pExtractedData != 0) LocRadExtract.pExtractedData += iComp*ofstCmp; //OC29122023
+		else if(LocRadExtract.pExtractedDataD != 0) LocRadExtract.pExtractedDataD += iComp*ofstCmp;
+
+		OwnRadExtract.pExtractedData = pCmplData + iReIm; //Re or Im part, with the same period
+		PutConstPhotEnergySliceInExtractPlace(ie0, Nx, Nz, OwnRadExtract, LocRadExtract);
+	}
 	return 0;
 }
 
 //*************************************************************************
 
-int srTRadGenManip::ConvoluteWithElecBeamOverTransvCoord(float* DataToConv, long Nx, long Nz)
-//int srTRadGenManip::ConvoluteWithElecBeamOverTransvCoord(float* DataToConv, long long Nx, long long Nz)
-{
-	PadImZerosToRealData(DataToConv, Nx, Nz);
-
-			//srTFFT2D testFFT;
-			//testFFT.AuxDebug_TestFFT_Plans();
-
+float srTRadGenManip::PackRealSliceToCmplData(float* pCmplData, float* pRealSlice, long Nx, long Nz, int iReIm)
+{//Puts real slice (nx x nz) to Re (iReIm = 0) or Im (iReIm = 1) part of complex array (Nx x Nz), padding it with zeros;
+ //the slice is normalized by its max. abs. value (which is returned), so that FFT round-off errors from the other part stay relative to this slice
 	srTSRWRadStructAccessData& RadAccessData = *((srTSRWRadStructAccessData*)(hRadAccessData.ptr()));
+	long nxOld = RadAccessData.nx, nzOld = RadAccessData.nz;
 
-	if(RadAccessData.pElecBeam == 0) 
+	float MaxAbs = 0.f;
+	if(pRealSlice != 0)
 	{
-		//srTSend Send; Send.AddWarningMessage(&gVectWarnNos, SINGLE_E_EXTRACTED_INSTEAD_OF_MULTI);
-		CErrWarn::AddWarningMessage(&gVectWarnNos, SINGLE_E_EXTRACTED_INSTEAD_OF_MULTI);
-		return 0;
+		long long NxNzOld = ((long long)nxOld)*((long long)nzOld);
+		for(long long i=0; i<NxNzOld; i++)
+		{
+			float AbsVal = (float)fabs(pRealSlice[i]);
+			if(MaxAbs < AbsVal) MaxAbs = AbsVal;
+		}
 	}
+	float Norm = (MaxAbs > 0.f)? MaxAbs : 1.f;
+	float InvNorm = 1.f/Norm;
 
-	CGenMathFFT2DInfo FFT2DInfo;
-	FFT2DInfo.pData = DataToConv;
-	FFT2DInfo.Dir = 1;
-	FFT2DInfo.xStep = RadAccessData.xStep;
-	FFT2DInfo.yStep = RadAccessData.zStep;
-	FFT2DInfo.xStart = -(Nx >> 1)*RadAccessData.xStep;
-	FFT2DInfo.yStart = -(Nz >> 1)*RadAccessData.zStep;
-	FFT2DInfo.Nx = Nx;
-	FFT2DInfo.Ny = Nz;
-	FFT2DInfo.UseGivenStartTrValues = 0;
+	float *tCmpl = pCmplData + iReIm;
+	float *tReal = pRealSlice;
+	for(long iz=0; iz<Nz; iz++)
+	{
+		bool rowIsIn = (tReal != 0) && (iz < nzOld);
+		for(long ix=0; ix<Nx; ix++)
+		{
+			*tCmpl = (rowIsIn && (ix < nxOld))? InvNorm*(*(tReal++)) : 0.f;
+			tCmpl += 2;
+		}
+	}
+	return Norm;
+}
 
-	CGenMathFFT2D FFT2D;
-	FFT2D.Make2DFFT(FFT2DInfo);
+//*************************************************************************
+
+void srTRadGenManip::SetupElecBeamConvKernel(long Nx, long Nz, float* arKernX, float* arKernZ)
+{//Separable multiplier exp(-C2x*qx^2)*exp(-C2z*qz^2) to be applied to the intensity after 2D FFT (on the mesh of the FFT in ConvoluteWithElecBeamKernel)
+	srTSRWRadStructAccessData& RadAccessData = *((srTSRWRadStructAccessData*)(hRadAccessData.ptr()));
 
 	srTElecBeamMoments ElecBeamMom(RadAccessData.pElecBeam);
 	PropagateElecBeamMoments(ElecBeamMom);
@@ -2613,24 +2764,64 @@ int srTRadGenManip::ConvoluteWithElecBeamOverTransvCoord(float* DataToConv, long
 	//double C1x = TwoPi*(ElecBeamMom.Mx);
 	//double C1z = TwoPi*(ElecBeamMom.Mz);
 
-	float* tData = DataToConv;
-	double qz = FFT2DInfo.yStartTr;
+	CGenMathFFT2DInfo FFT2DInfo;
+	FFT2DInfo.xStep = RadAccessData.xStep;
+	FFT2DInfo.yStep = RadAccessData.zStep;
+	FFT2DInfo.Nx = Nx;
+	FFT2DInfo.Ny = Nz;
+	FFT2DInfo.UseGivenStartTrValues = 0;
+	CGenMathFFT2D FFT2D;
+	FFT2D.SetupLimitsTr(FFT2DInfo);
 
+	double qx = FFT2DInfo.xStartTr;
+	for(long ix=0; ix<Nx; ix++)
+	{
+		arKernX[ix] = (float)exp(-C2x*qx*qx);
+		qx += FFT2DInfo.xStepTr;
+	}
+	double qz = FFT2DInfo.yStartTr;
 	for(long iz=0; iz<Nz; iz++)
 	{
-		double C2zqzE2 = C2z*qz*qz;
-		double qx = FFT2DInfo.xStartTr;
+		arKernZ[iz] = (float)exp(-C2z*qz*qz);
+		qz += FFT2DInfo.yStepTr;
+	}
+}
 
-		for(long ix=0; ix<Nx; ix++)
-		{
-			double Magn = exp(-C2x*qx*qx - C2zqzE2);
+//*************************************************************************
 
-			*(tData++) *= (float)Magn; // Re
-			*(tData++) *= (float)Magn; // Im
+int srTRadGenManip::ConvoluteWithElecBeamKernel(float* DataToConv, long Nx, long Nz, float* arKernX, float* arKernZ, void* pvFrwPlan, void* pvBckwPlan)
+{//DataToConv is complex array (Nx x Nz); pvFrwPlan, pvBckwPlan are pointers to precreated FFTW plans (used with _WITH_OMP only)
+	srTSRWRadStructAccessData& RadAccessData = *((srTSRWRadStructAccessData*)(hRadAccessData.ptr()));
+	int result;
 
-			qx += FFT2DInfo.xStepTr;
+	CGenMathFFT2DInfo FFT2DInfo;
+	FFT2DInfo.pData = DataToConv;
+	FFT2DInfo.Dir = 1;
+	FFT2DInfo.xStep = RadAccessData.xStep;
+	FFT2DInfo.yStep = RadAccessData.zStep;
+	FFT2DInfo.xStart = -(Nx >> 1)*RadAccessData.xStep;
+	FFT2DInfo.yStart = -(Nz >> 1)*RadAccessData.zStep;
+	FFT2DInfo.Nx = Nx;
+	FFT2DInfo.Ny = Nz;
+	FFT2DInfo.UseGivenStartTrValues = 0;
+
+	CGenMathFFT2D FFT2D;
+#if defined(_WITH_OMP) && !defined(_FFTW3)
+	if(result = FFT2D.Make2DFFT(FFT2DInfo, (fftwnd_plan*)pvFrwPlan)) return result;
+#else
+	if(result = FFT2D.Make2DFFT(FFT2DInfo)) return result;
+#endif
+
+	float* tData = DataToConv;
+	for(long iz=0; iz<Nz; iz++)
+	{
+		float KernZ = arKernZ[iz];
+		for(long ix=0; ix<Nx; ix++)
+		{
+			float Magn = KernZ*arKernX[ix];
+			*(tData++) *= Magn; // Re
+			*(tData++) *= Magn; // Im
 		}
-		qz += FFT2DInfo.yStepTr;
 	}
 
 	FFT2DInfo.pData = DataToConv;
@@ -2642,9 +2833,42 @@ int srTRadGenManip::ConvoluteWithElecBeamOverTransvCoord(float* DataToConv, long
 	FFT2DInfo.yStart = FFT2DInfo.yStartTr; //FFT2DInfo.yStartTr = RadAccessData.zStart;
 	FFT2DInfo.UseGivenStartTrValues = 0;
 
-	FFT2D.Make2DFFT(FFT2DInfo);
+#if defined(_WITH_OMP) && !defined(_FFTW3)
+	return FFT2D.Make2DFFT(FFT2DInfo, (fftwnd_plan*)pvBckwPlan);
+#else
+	return FFT2D.Make2DFFT(FFT2DInfo);
+#endif
+}
 
-	return 0;
+//*************************************************************************
+
+int srTRadGenManip::ConvoluteWithElecBeamOverTransvCoord(float* DataToConv, long Nx, long Nz)
+//int srTRadGenManip::ConvoluteWithElecBeamOverTransvCoord(float* DataToConv, long long Nx, long long Nz)
+{
+	PadImZerosToRealData(DataToConv, Nx, Nz);
+
+			//srTFFT2D testFFT;
+			//testFFT.AuxDebug_TestFFT_Plans();
+
+	srTSRWRadStructAccessData& RadAccessData = *((srTSRWRadStructAccessData*)(hRadAccessData.ptr()));
+
+	if(RadAccessData.pElecBeam == 0) 
+	{
+		//srTSend Send; Send.AddWarningMessage(&gVectWarnNos, SINGLE_E_EXTRACTED_INSTEAD_OF_MULTI);
+		CErrWarn::AddWarningMessage(&gVectWarnNos, SINGLE_E_EXTRACTED_INSTEAD_OF_MULTI);
+		return 0;
+	}
+
+	float *arKernX = new float[Nx];
+	float *arKernZ = new float[Nz];
+	if((arKernX == 0) || (arKernZ == 0)) return MEMORY_ALLOCATION_FAILURE;
+	SetupElecBeamConvKernel(Nx, Nz, arKernX, arKernZ);
+
+	int result = ConvoluteWithElecBeamKernel(DataToConv, Nx, Nz, arKernX, arKernZ);
+
+	delete[] arKernX;
+	delete[] arKernZ;
+	return result;
 }
 
 //*************************************************************************
@@ -3256,6 +3480,149 @@ void srTRadGenManip::TryToMakePhaseContinuous1D(double* Slice, long long Np, lon
 	}
 }
 
+//*************************************************************************
+
+int srTRadGenManip::UnwrapPhase2D(srTWaveAccessData& WaveData, float* arInt)
+{//Quality-guided unwrapping: pairs of neighbor points are processed in the order of decreasing reliability (estimated from wrapped second differences of phase),
+ //merging groups of mutually unwrapped points (disjoint-set forest with offsets in units of 2*Pi); the value at the center is kept.
+ //Points where intensity (arInt, if supplied) is zero are excluded: pairs including them are not merged, and their (undefined) phase is kept wrapped.
+	const double TwoPi = 6.2831853071796, InvTwoPi = 1./TwoPi;
+	const long long nBins = 65536; //for sorting edges by reliability
+
+	long long nx = WaveData.DimSizes[0], nz = WaveData.DimSizes[1];
+	double *pPh = (double*)(WaveData.pWaveData);
+	if((pPh == 0) || (nx <= 0) || (nz <= 0) || (nx*nz < 2)) return 0;
+	long long np = nx*nz, nEdgesX = (nx - 1)*nz, nEdges = nEdgesX + nx*(nz - 1);
+
+	std::vector<float> vRel;
+	std::vector<unsigned short> vBin;
+	std::vector<long long> vOrd, vCnt, vNode;
+	try
+	{
+		vRel.resize(np); vBin.resize(nEdges); vOrd.resize(nEdges); vCnt.assign(nBins + 1, 0);
+		vNode.resize(np << 1);
+	}
+	catch(std::bad_alloc&) { return MEMORY_ALLOCATION_FAILURE;}
+	float *pRel = &(vRel[0]);
+	unsigned short *pBin = &(vBin[0]);
+	long long *pOrd = &(vOrd[0]), *pCnt = &(vCnt[0]);
+	long long *pNode = &(vNode[0]); //parent (or -1-rank, for group roots) and offset of each point in the disjoint-set forest
+
+	//Reliability of points: inverse r.m.s. of available wrapped second differences (horizontal, vertical and diagonal), or 0
+#ifdef _WITH_OMP
+	#pragma omp parallel for
+#endif
+	for(long long iz=0; iz<nz; iz++)
+	{
+		double *t = pPh + iz*nx;
+		bool zIn = ((iz > 0) && (iz < (nz - 1)));
+		for(long long ix=0; ix<nx; ix++)
+		{
+			long long i = iz*nx + ix;
+			pNode[i << 1] = -1; pNode[(i << 1) + 1] = 0;
+			if((arInt != 0) && (arInt[i] <= 0.f)) { pRel[i] = 0.f; continue;}
+			double ph = t[ix], sumD2 = 0., d1, d2, d;
+			int nD = 0;
+			bool xIn = ((ix > 0) && (ix < (nx - 1)));
+			if(xIn)
+			{
+				d1 = t[ix - 1] - ph; d2 = ph - t[ix + 1];
+				d = WrapPhaseDiff(d1) - WrapPhaseDiff(d2); sumD2 += d*d; nD++;
+			}
+			if(zIn)
+			{
+				d1 = t[ix - nx] - ph; d2 = ph - t[ix + nx];
+				d = WrapPhaseDiff(d1) - WrapPhaseDiff(d2); sumD2 += d*d; nD++;
+			}
+			if(xIn && zIn)
+			{
+				d1 = t[ix - nx - 1] - ph; d2 = ph - t[ix + nx + 1];
+				d = WrapPhaseDiff(d1) - WrapPhaseDiff(d2); sumD2 += d*d;
+				d1 = t[ix - nx + 1] - ph; d2 = ph - t[ix + nx - 1];
+				d = WrapPhaseDiff(d1) - WrapPhaseDiff(d2); sumD2 += d*d; nD += 2;
+			}
+			if(nD == 0) pRel[i] = 0.f;
+			else if(sumD2 <= 0.) pRel[i] = 1.e+30f;
+			else pRel[i] = (float)(1./sqrt(sumD2/nD));
+		}
+	}
+
+	//Sorting edges (pairs of neighbor points) by decreasing reliability (counting sort over bins of 1/(1 + rel1 + rel2))
+#ifdef _WITH_OMP
+	#pragma omp parallel for
+#endif
+	for(long long ie=0; ie<nEdges; ie++)
+	{
+		long long i1, i2;
+		if(ie < nEdgesX) { i1 = ie + ie/(nx - 1); i2 = i1 + 1;}
+		else { i1 = ie - nEdgesX; i2 = i1 + nx;}
+		long long iBin = nBins - 1;
+		if((pRel[i1] > 0.f) && (pRel[i2] > 0.f)) iBin = (long long)(nBins/(1. + (double)pRel[i1] + (double)pRel[i2]));
+		pBin[ie] = (unsigned short)((iBin < nBins)? iBin : (nBins - 1));
+	}
+	for(long long ie=0; ie<nEdges; ie++) pCnt[pBin[ie] + 1]++;
+	for(long long iBin=0; iBin<nBins; iBin++) pCnt[iBin + 1] += pCnt[iBin];
+	for(long long ie=0; ie<nEdges; ie++) pOrd[pCnt[pBin[ie]]++] = ie;
+
+	//Merging groups of points
+	for(long long j=0; j<nEdges; j++)
+	{
+		long long ie = pOrd[j], i1, i2;
+		if(ie < nEdgesX) { i1 = ie + ie/(nx - 1); i2 = i1 + 1;}
+		else { i1 = ie - nEdgesX; i2 = i1 + nx;}
+		if((arInt != 0) && ((arInt[i1] <= 0.f) || (arInt[i2] <= 0.f))) continue; //dark points don't bridge phase jumps
+
+		long long k1, k2;
+		long long r1 = FindUnwrapPhaseGroup(pNode, i1, k1);
+		long long r2 = FindUnwrapPhaseGroup(pNode, i2, k2);
+		if(r1 == r2) continue;
+
+		//group of lower rank is attached to the other one with the offset keeping wrapped difference of phase between the points
+		long long dk = k1 - k2 - (long long)floor((pPh[i2] - pPh[i1])*InvTwoPi + 0.5);
+		long long mRank1 = pNode[r1 << 1], mRank2 = pNode[r2 << 1];
+		if(mRank1 > mRank2) { pNode[r1 << 1] = r2; pNode[(r1 << 1) + 1] = -dk;}
+		else
+		{
+			pNode[r2 << 1] = r1; pNode[(r2 << 1) + 1] = dk;
+			if(mRank1 == mRank2) pNode[r1 << 1]--;
+		}
+	}
+
+	long long ic = (nz >> 1)*nx + (nx >> 1);
+	long long kc = 0;
+	for(long long i=ic; pNode[i << 1]>=0; i=pNode[i << 1]) kc += pNode[(i << 1) + 1];
+#ifdef _WITH_OMP
+	#pragma omp parallel for
+#endif
+	for(long long i=0; i<np; i++)
+	{
+		if((arInt != 0) && (arInt[i] <= 0.f)) continue;
+		long long k = -kc;
+		for(long long j=i; pNode[j << 1]>=0; j=pNode[j << 1]) k += pNode[(j << 1) + 1];
+		if(k != 0) pPh[i] += TwoPi*k;
+	}
+	return 0;
+}
+
+//*************************************************************************
+
+long long srTRadGenManip::FindUnwrapPhaseGroup(long long* arNode, long long i, long long& k)
+{//Returns root of the group of point i and offset of the point with respect to the root (in units of 2*Pi), compressing the path;
+ //arNode contains parent (or -1-rank, for roots) and offset with respect to parent of each point
+	long long r = i;
+	k = 0;
+	while(arNode[r << 1] >= 0) { k += arNode[(r << 1) + 1]; r = arNode[r << 1];}
+
+	long long kj = k;
+	while(i != r)
+	{
+		long long iNext = arNode[i << 1], kNext = kj - arNode[(i << 1) + 1];
+		arNode[i << 1] = r; arNode[(i << 1) + 1] = kj;
+		i = iNext; kj = kNext;
+	}
+	return r;
+}
+
 //*************************************************************************
 //OC13122019 (moved to .h)
 //void srTRadGenManip::ExtractRadiation(int PolarizCompon, int Int_or_Phase, int SectID, int TransvPres, double e, double x, double z, char* pData)
@@ -3348,6 +3715,13 @@ void srTRadGenManip::Int2DIntegOverAzim(srTWaveAccessData* pwI1, srTWaveAccessDa
 	if((pwI1 == 0) || (pwI2 == 0) || (arPar == 0)) throw SRWL_INCORRECT_PARAM_FOR_INT_PROC;
 	if((pwI1->AmOfDims != 1) || (pwI1->pWaveData == 0) || (pwI2->AmOfDims != 2) || (pwI2->pWaveData == 0)) throw SRWL_INCORRECT_PARAM_FOR_INT_PROC;
 
+	std::vector<double> vKey;
+	if(srTAuxInt2DIntegOverAzimPlan::SetupKey(pwI1, pwI2, arPar, nPar, vKey))
+	{//use prepared plan, if any
+		CSmartPtr<srTAuxInt2DIntegOverAzimPlan> hPlan = srTAuxInt2DIntegOverAzimPlan::Find(vKey);
+		if(hPlan.ptr() != 0) { hPlan.ptr()->Apply(pwI1, pwI2); return;}
+	}
+
 	bool calcAvg = ((char)arPar[0] == 1);
 	char meth = (char)arPar[1];
 
@@ -3370,9 +3744,11 @@ void srTRadGenManip::Int2DIntegOverAzim(srTWaveAccessData* pwI1, srTWaveAccessDa
 	int nParMin = 8; //OC09032019 (number of input params without optional ones)
 	int nRectToSkip = (int)(0.25*(nPar - nParMin) + 1e-07);
 	double *arRectToSkipPar = 0;
+	std::vector<double> vRectToSkipPar; //copy, to keep arPar unchanged
 	if(nRectToSkip > 0)
 	{
-		arRectToSkipPar = arPar + nParMin;
+		vRectToSkipPar.assign(arPar + nParMin, arPar + nParMin + (nRectToSkip << 2));
+		arRectToSkipPar = &(vRectToSkipPar[0]);
 		//converting widths to half-widths for convenience of treatment
 		for(int i=0; i<(nRectToSkip << 1); i++) arRectToSkipPar[2*i + 1] *= 0.5; 
 	}
@@ -3507,7 +3883,7 @@ void srTRadGenManip::Int2DIntegOverAzim(srTWaveAccessData* pwI1, srTWaveAccessDa
 					{
 						xx = x0 + r*cos(ph); yy = y0 + r*sin(ph); //OC09032019
 						if(arRectToSkipPar != 0) pointToBeUsed = CheckIfPointIsOutsideRectangles(xx, yy, arRectToSkipPar, nRectToSkip); //OC09032019
-						if(pointToBeUsed) *t_ar = CGenMathInterp::InterpOnRegMesh2d(xx, yy, xMin, xStep, nx, yMin, yStep, ny, pfI2, ordInterp);
+						if(pointToBeUsed) *t_ar = CGenMathInterp::InterpOnRegMesh2d(xx, yy, xMin, xStep, nx, yMin, yStep, ny, pdI2, ordInterp);
 						else *t_ar = 0;
 						//*t_ar = CGenMathInterp::InterpOnRegMesh2d(x0 + r*cos(ph), y0 + r*sin(ph), xMin, xStep, nx, yMin, yStep, ny, pfI2, ordInterp);
 					}
@@ -3552,6 +3928,242 @@ void srTRadGenManip::Int2DIntegOverAzim(srTWaveAccessData* pwI1, srTWaveAccessDa
 
 //*************************************************************************
 
+void srTRadGenManip::Int2DIntegOverAzimMult(srTWaveAccessData* pwI1, srTWaveAccessData* pwI2, long long nFrames, double* arPar, int nPar)
+{//Same as Int2DIntegOverAzim, for nFrames 2D distributions stored one after another in *pwI2 (resulting 1D distributions are stored one after another in *pwI1)
+	if((pwI1 == 0) || (pwI2 == 0) || (arPar == 0) || (nFrames <= 0)) throw SRWL_INCORRECT_PARAM_FOR_INT_PROC;
+	if((pwI1->AmOfDims != 1) || (pwI1->pWaveData == 0) || (pwI2->AmOfDims != 2) || (pwI2->pWaveData == 0)) throw SRWL_INCORRECT_PARAM_FOR_INT_PROC;
+	if(nFrames == 1) { Int2DIntegOverAzim(pwI1, pwI2, arPar, nPar); return;}
+
+	std::vector<double> vKey;
+	if(srTAuxInt2DIntegOverAzimPlan::SetupKey(pwI1, pwI2, arPar, nPar, vKey))
+	{//the plan is made for this call only, if it was not prepared before
+		CSmartPtr<srTAuxInt2DIntegOverAzimPlan> hPlan = srTAuxInt2DIntegOverAzimPlan::Find(vKey);
+		if(hPlan.ptr() == 0) hPlan = CSmartPtr<srTAuxInt2DIntegOverAzimPlan>(new srTAuxInt2DIntegOverAzimPlan(pwI1, pwI2, arPar, nPar));
+		hPlan.ptr()->Apply(pwI1, pwI2, nFrames);
+		return;
+	}
+
+	//Integration driven by relative accuracy: frames are processed independently
+	long long perFr1 = (pwI1->DimSizes[0])*((*(pwI1->WaveType) == 'f')? sizeof(float) : sizeof(double));
+	long long perFr2 = (pwI2->DimSizes[0])*(pwI2->DimSizes[1])*((*(pwI2->WaveType) == 'f')? sizeof(float) : sizeof(double));
+	int resErr = 0;
+
+#ifdef _WITH_OMP
+	#pragma omp parallel for
+#endif
+	for(long long iFr=0; iFr<nFrames; iFr++)
+	{
+		srTWaveAccessData wI1 = *pwI1, wI2 = *pwI2;
+		wI1.pWaveData += iFr*perFr1;
+		wI2.pWaveData += iFr*perFr2;
+		try { Int2DIntegOverAzim(&wI1, &wI2, arPar, nPar);}
+		catch(int erNo)
+		{
+#ifdef _WITH_OMP
+			#pragma omp critical
+#endif
+			{
+				if(resErr == 0) resErr = erNo;
+			}
+		}
+	}
+	if(resErr != 0) throw resErr;
+}
+
+//*************************************************************************
+
+std::vector<CSmartPtr<srTAuxInt2DIntegOverAzimPlan> > srTAuxInt2DIntegOverAzimPlan::m_vReg;
+std::mutex srTAuxInt2DIntegOverAzimPlan::m_mtxReg;
+
+//*************************************************************************
+
+srTAuxInt2DIntegOverAzimPlan::srTAuxInt2DIntegOverAzimPlan(srTWaveAccessData* pwI1, srTWaveAccessData* pwI2, double* arPar, int nPar)
+{//Follows the sampling of srTRadGenManip::Int2DIntegOverAzim (method 1)
+	if(!SetupKey(pwI1, pwI2, arPar, nPar, m_vKey)) throw SRWL_INCORRECT_PARAM_FOR_INT_PROC;
+
+	bool calcAvg = ((char)arPar[0] == 1);
+	int nPhMax = (int)arPar[2];
+	char ordInterp = (char)arPar[3];
+	double phMin = arPar[4], phMax = arPar[5];
+	double x0 = arPar[6], y0 = arPar[7];
+
+	const int nParMin = 8;
+	int nRectToSkip = (int)(0.25*(nPar - nParMin) + 1e-07);
+	double *arRectToSkipPar = 0;
+	std::vector<double> vRectToSkipPar;
+	if(nRectToSkip > 0)
+	{
+		vRectToSkipPar.assign(arPar + nParMin, arPar + nParMin + (nRectToSkip << 2));
+		arRectToSkipPar = &(vRectToSkipPar[0]);
+		for(int i=0; i<(nRectToSkip << 1); i++) arRectToSkipPar[2*i + 1] *= 0.5;
+	}
+
+	const double twoPi = 2*3.141592653589793;
+	if(phMin == phMax) phMax = phMin + twoPi;
+	double phRange = phMax - phMin;
+
+	double xMin = pwI2->DimStartValues[0], xStep = pwI2->DimSteps[0];
+	double yMin = pwI2->DimStartValues[1], yStep = pwI2->DimSteps[1];
+	long long nx = pwI2->DimSizes[0], ny = pwI2->DimSizes[1];
+	m_nxny = nx*ny;
+
+	long long nr = pwI1->DimSizes[0];
+	double rStep = pwI1->DimSteps[0];
+	double r = pwI1->DimStartValues[0];
+	double rMax = r + rStep*(nr - 1);
+
+	std::vector<double> vWph(nPhMax);
+	std::vector<std::pair<long long, double> > vTerms;
+	long long arInd[16];
+	double arW[16];
+
+	m_vRowStart.resize(nr + 1);
+	for(long long ir=0; ir<nr; ir++)
+	{
+		m_vRowStart[ir] = (long long)m_vInd.size();
+		vTerms.clear();
+
+		long nPhCur = (long)round((r/rMax)*nPhMax);
+		if(nPhCur <= 1)
+		{
+			if(calcAvg && ((arRectToSkipPar == 0) || srTRadGenManip::CheckIfPointIsOutsideRectangles(x0 + r, y0, arRectToSkipPar, nRectToSkip)))
+			{
+				int nw = CGenMathInterp::InterpOnRegMesh2dWeights(x0 + r, y0, xMin, xStep, nx, yMin, yStep, ny, arInd, arW, ordInterp);
+				for(int i=0; i<nw; i++) vTerms.push_back(std::pair<long long, double>(arInd[i], arW[i]));
+			}
+		}
+		else
+		{
+			long nPhCur_mi_1 = nPhCur - 1;
+			double phStep = phRange/nPhCur_mi_1;
+			if(nPhCur > (long)vWph.size()) vWph.resize(nPhCur);
+			CGenMathMeth::Integ1D_FuncDefByArrayWeights(&(vWph[0]), nPhCur, phStep);
+			if(::fabs(::fabs(phRange) - twoPi) < ::fabs(1.e-03*phStep)) { vWph[0] += vWph[nPhCur_mi_1]; vWph[nPhCur_mi_1] = 0.;} //full circle: last point is the first one
+			double mult = calcAvg? 1./phRange : 1.;
+
+			double ph = phMin;
+			for(long iph=0; iph<nPhCur; iph++)
+			{
+				if(vWph[iph] != 0.)
+				{
+					double xx = x0 + r*cos(ph), yy = y0 + r*sin(ph);
+					if((arRectToSkipPar == 0) || srTRadGenManip::CheckIfPointIsOutsideRectangles(xx, yy, arRectToSkipPar, nRectToSkip))
+					{
+						double wPh = vWph[iph]*mult;
+						int nw = CGenMathInterp::InterpOnRegMesh2dWeights(xx, yy, xMin, xStep, nx, yMin, yStep, ny, arInd, arW, ordInterp);
+						for(int i=0; i<nw; i++) vTerms.push_back(std::pair<long long, double>(arInd[i], arW[i]*wPh));
+					}
+				}
+				ph += phStep;
+			}
+		}
+
+		//merging terms referring to same input values
+		std::sort(vTerms.begin(), vTerms.end());
+		for(size_t i=0; i<vTerms.size(); i++)
+		{
+			if((i > 0) && (vTerms[i].first == vTerms[i - 1].first)) m_vW.back() += vTerms[i].second;
+			else { m_vInd.push_back(vTerms[i].first); m_vW.push_back(vTerms[i].second);}
+		}
+		r += rStep;
+	}
+	m_vRowStart[nr] = (long long)m_vInd.size();
+}
+
+//*************************************************************************
+
+void srTAuxInt2DIntegOverAzimPlan::Apply(srTWaveAccessData* pwI1, srTWaveAccessData* pwI2, long long nFrames)
+{//Calculates resulting values as sparse weighted sums of input values, for nFrames input distributions stored one after another
+	if((pwI1 == 0) || (pwI2 == 0) || (pwI1->pWaveData == 0) || (pwI2->pWaveData == 0)) throw SRWL_INCORRECT_PARAM_FOR_INT_PROC;
+	long long nr = (long long)m_vRowStart.size() - 1;
+	if((pwI1->DimSizes[0] != nr) || ((pwI2->DimSizes[0])*(pwI2->DimSizes[1]) != m_nxny)) throw SRWL_INCORRECT_PARAM_FOR_INT_PROC;
+
+	float *pfI1=0, *pfI2=0;
+	double *pdI1=0, *pdI2=0;
+	if(*(pwI1->WaveType) == 'f') pfI1 = (float*)(pwI1->pWaveData);
+	else if(*(pwI1->WaveType) == 'd') pdI1 = (double*)(pwI1->pWaveData);
+	else throw SRWL_INCORRECT_PARAM_FOR_INT_PROC;
+	if(*(pwI2->WaveType) == 'f') pfI2 = (float*)(pwI2->pWaveData);
+	else if(*(pwI2->WaveType) == 'd') pdI2 = (double*)(pwI2->pWaveData);
+	else throw SRWL_INCORRECT_PARAM_FOR_INT_PROC;
+
+	const long long *arRowStart = &(m_vRowStart[0]);
+	const long long *arInd = m_vInd.empty()? 0 : &(m_vInd[0]);
+	const double *arW = m_vW.empty()? 0 : &(m_vW[0]);
+	long long nTot = nFrames*nr;
+
+#ifdef _WITH_OMP
+	#pragma omp parallel for
+#endif
+	for(long long i=0; i<nTot; i++)
+	{
+		long long iFr = i/nr, ir = i - iFr*nr;
+		long long ofstFr = iFr*m_nxny;
+		double sum = 0.;
+		if(pfI2)
+		{
+			const float *tI2 = pfI2 + ofstFr;
+			for(long long k=arRowStart[ir]; k<arRowStart[ir + 1]; k++) sum += arW[k]*tI2[arInd[k]];
+		}
+		else
+		{
+			const double *tI2 = pdI2 + ofstFr;
+			for(long long k=arRowStart[ir]; k<arRowStart[ir + 1]; k++) sum += arW[k]*tI2[arInd[k]];
+		}
+		if(pfI1) pfI1[i] = (float)sum;
+		else pdI1[i] = sum;
+	}
+}
+
+//*************************************************************************
+
+bool srTAuxInt2DIntegOverAzimPlan::SetupKey(srTWaveAccessData* pwI1, srTWaveAccessData* pwI2, double* arPar, int nPar, std::vector<double>& vKey)
+{//Plans are only possible for fixed numbers of points vs azimuth (method 1); the data pointers are not part of the key
+	if((pwI1 == 0) || (pwI2 == 0) || (arPar == 0) || (nPar < 8)) return false;
+	if((pwI1->AmOfDims != 1) || (pwI2->AmOfDims != 2)) return false;
+	if(((char)arPar[1] != 1) || ((int)arPar[2] <= 0)) return false;
+
+	vKey.resize(9 + nPar);
+	vKey[0] = (double)(pwI2->DimSizes[0]); vKey[1] = pwI2->DimStartValues[0]; vKey[2] = pwI2->DimSteps[0];
+	vKey[3] = (double)(pwI2->DimSizes[1]); vKey[4] = pwI2->DimStartValues[1]; vKey[5] = pwI2->DimSteps[1];
+	vKey[6] = (double)(pwI1->DimSizes[0]); vKey[7] = pwI1->DimStartValues[0]; vKey[8] = pwI1->DimSteps[0];
+	for(int i=0; i<nPar; i++) vKey[9 + i] = arPar[i];
+	return true;
+}
+
+//*************************************************************************
+
+void srTAuxInt2DIntegOverAzimPlan::Register(const CSmartPtr<srTAuxInt2DIntegOverAzimPlan>& hPlan)
+{
+	std::lock_guard<std::mutex> lock(m_mtxReg);
+	m_vReg.push_back(hPlan);
+}
+
+//*************************************************************************
+
+void srTAuxInt2DIntegOverAzimPlan::Unregister(srTAuxInt2DIntegOverAzimPlan* pPlan)
+{//The plan itself is deleted when it is not used by any calculation any more
+	std::lock_guard<std::mutex> lock(m_mtxReg);
+	for(std::vector<CSmartPtr<srTAuxInt2DIntegOverAzimPlan> >::iterator it = m_vReg.begin(); it != m_vReg.end(); ++it)
+	{
+		if(it->ptr() == pPlan) { m_vReg.erase(it); return;}
+	}
+}
+
+//*************************************************************************
+
+CSmartPtr<srTAuxInt2DIntegOverAzimPlan> srTAuxInt2DIntegOverAzimPlan::Find(const std::vector<double>& vKey)
+{
+	std::lock_guard<std::mutex> lock(m_mtxReg);
+	for(std::vector<CSmartPtr<srTAuxInt2DIntegOverAzimPlan> >::iterator it = m_vReg.begin(); it != m_vReg.end(); ++it)
+	{
+		if(it->ptr()->m_vKey == vKey) return *it;
+	}
+	return CSmartPtr<srTAuxInt2DIntegOverAzimPlan>();
+}
+
+//*************************************************************************
+
 void srTRadGenManip::MutualIntSumPart(srTWaveAccessData* pwI1, srTWaveAccessData* pwI2, long iterAvg) //OC25042021
 //void srTRadGenManip::MutualIntSumPart(srTWaveAccessData* pwI1, srTWaveAccessData* pwI2)
 {//OC20042021
@@ -3825,82 +4437,67 @@ void srTRadGenManip::MutualIntTreatComQuadPhTerm(srTWaveAccessData* pwI, double*
 
 	if(AddOrRem == 'r') { ConstRxE = -ConstRxE; ConstRzE = -ConstRzE;}
 
-	double phTermZ, phTermZt, phTerm, phTermT;
+	//The phase term is Ph(x,z) - Ph(xt,zt), with Ph(x,z) = ConstRxE*x^2 + ConstRzE*z^2, so cos and sin are only required at nx + nz points
+	vector<double> vCosSinX(nx << 1), vCosSinZ(nz << 1);
+	SetupQuadPhTermCosSin(ConstRxE, xStart - xc, xStep, nx, &vCosSinX[0]);
+	SetupQuadPhTermCosSin(ConstRzE, zStart - zc, zStep, nz, &vCosSinZ[0]);
+	const double *arCosSinX = &vCosSinX[0], *arCosSinZ = &vCosSinZ[0];
 
-	if(pDataF != 0)
+	long long nxnz = nx*nz;
+	long long PerT = nxnz << 1;
+
+#ifdef _WITH_OMP
+	#pragma omp parallel for
+#endif
+	for(long long it=0; it<nxnz; it++)
 	{
-		float *pMI = pDataF;
-		float reMI, imMI;
-		double zt = zStart - zc;
-		float cosPh, sinPh;
-		for(long long izt=0; izt<nz; izt++)
+		long long izt = it/nx, ixt = it - izt*nx;
+		const double *pCSXt = arCosSinX + (ixt << 1), *pCSZt = arCosSinZ + (izt << 1);
+		double cosPhT = pCSXt[0]*pCSZt[0] - pCSXt[1]*pCSZt[1];
+		double sinPhT = -(pCSXt[0]*pCSZt[1] + pCSXt[1]*pCSZt[0]);
+
+		const double *pCSZ = arCosSinZ;
+		if(pDataF != 0)
 		{
-			double xt = xStart - xc;
-			phTermZt = -ConstRzE*zt*zt;
-			for(long long ixt=0; ixt<nx; ixt++)
+			float *pMI = pDataF + it*PerT;
+			for(long long iz=0; iz<nz; iz++)
 			{
-				double z = zStart - zc;
-				phTermT = phTermZt - ConstRxE*xt*xt;
-				for(long long iz=0; iz<nz; iz++)
+				double cosPhZ = pCSZ[0]*cosPhT - pCSZ[1]*sinPhT;
+				double sinPhZ = pCSZ[0]*sinPhT + pCSZ[1]*cosPhT;
+				pCSZ += 2;
+				const double *pCSX = arCosSinX;
+				for(long long ix=0; ix<nx; ix++)
 				{
-					double x = xStart - xc;
-					phTermZ = ConstRzE*z*z;
-					for(long long ix=0; ix<nx; ix++)
-					{
-						phTerm = phTermZ + ConstRxE*x*x + phTermT;
-						CosAndSin(phTerm, cosPh, sinPh);
+					double cosPh = pCSX[0]*cosPhZ - pCSX[1]*sinPhZ;
+					double sinPh = pCSX[0]*sinPhZ + pCSX[1]*cosPhZ;
+					pCSX += 2;
 
-						reMI = *pMI;
-						imMI = *(pMI+1);
-						*(pMI++) = reMI*cosPh - imMI*sinPh; //new reMI
-						*(pMI++) = reMI*sinPh + imMI*cosPh; //new imMI
-
-						x += xStep;
-					}
-					z += zStep;
+					double reMI = *pMI, imMI = *(pMI+1);
+					*(pMI++) = (float)(reMI*cosPh - imMI*sinPh); //new reMI
+					*(pMI++) = (float)(reMI*sinPh + imMI*cosPh); //new imMI
 				}
-				xt += xStep;
 			}
-			zt += zStep;
 		}
-	}
-	if(pDataD != 0)
-	{
-		double *pMI = pDataD;
-		double reMI, imMI;
-		double zt = zStart - zc;
-		double cosPh, sinPh;
-		for(long long izt=0; izt<nz; izt++)
+		else if(pDataD != 0)
 		{
-			double xt = xStart - xc;
-			phTermZt = -ConstRzE*zt*zt;
-			for(long long ixt=0; ixt<nx; ixt++)
+			double *pMI = pDataD + it*PerT;
+			for(long long iz=0; iz<nz; iz++)
 			{
-				double z = zStart - zc;
-				phTermT = phTermZt - ConstRxE*xt*xt;
-				for(long long iz=0; iz<nz; iz++)
+				double cosPhZ = pCSZ[0]*cosPhT - pCSZ[1]*sinPhT;
+				double sinPhZ = pCSZ[0]*sinPhT + pCSZ[1]*cosPhT;
+				pCSZ += 2;
+				const double *pCSX = arCosSinX;
+				for(long long ix=0; ix<nx; ix++)
 				{
-					double x = xStart - xc;
-					phTermZ = ConstRzE*z*z;
-					for(long long ix=0; ix<nx; ix++)
-					{
-						phTerm = phTermZ + ConstRxE*x*x + phTermT;
-						cosPh = cos(phTerm);
-						sinPh = sin(phTerm);
-						//CosAndSin(phTerm, cosPh, sinPh);
-
-						reMI = *pMI;
-						imMI = *(pMI+1);
-						*(pMI++) = reMI*cosPh - imMI*sinPh; //new reMI
-						*(pMI++) = reMI*sinPh + imMI*cosPh; //new imMI
+					double cosPh = pCSX[0]*cosPhZ - pCSX[1]*sinPhZ;
+					double sinPh = pCSX[0]*sinPhZ + pCSX[1]*cosPhZ;
+					pCSX += 2;
 
-						x += xStep;
-					}
-					z += zStep;
+					double reMI = *pMI, imMI = *(pMI+1);
+					*(pMI++) = reMI*cosPh - imMI*sinPh; //new reMI
+					*(pMI++) = reMI*sinPh + imMI*cosPh; //new imMI
 				}
-				xt += xStep;
 			}
-			zt += zStep;
 		}
 	}
 }
@@ -3955,86 +4552,64 @@ void srTRadGenManip::CohModesTreatComQuadPhTerm(srTWaveAccessData* pwI, double*
 
 	if(AddOrRem == 'r') { ConstRx = -ConstRx; ConstRz = -ConstRz;}
 
+	//The phase term is separable in x and z: cos and sin are tabulated for each photon energy at nx + nz points, and used for all modes
+	long long Two_nx = nx << 1, Two_nz = nz << 1;
+	vector<double> vCosSinX(ne*Two_nx), vCosSinZ(ne*Two_nz);
+	double ePh = eStart;
+	for(long long ie=0; ie<ne; ie++)
+	{
+		SetupQuadPhTermCosSin(ConstRx*ePh, xStart - xc, xStep, nx, &vCosSinX[ie*Two_nx]);
+		SetupQuadPhTermCosSin(ConstRz*ePh, zStart - zc, zStep, nz, &vCosSinZ[ie*Two_nz]);
+		ePh += eStep;
+	}
+	const double *arCosSinX = &vCosSinX[0], *arCosSinZ = &vCosSinZ[0];
+
 	long long PerX = ne << 1;
 	long long PerZ = PerX*nx;
-	long long PerM = PerZ*nz;
+	long long nRows = ((long long)nModes)*nz;
 
-	double phTermZ, phTerm;
-	double x, z, ConstRxE, ConstRzE;
-	for(int im=0; im<nModes; im++)
+#ifdef _WITH_OMP
+	#pragma omp parallel for
+#endif
+	for(long long iRow=0; iRow<nRows; iRow++) //rows vs x of all modes (PerM = PerZ*nz)
 	{
-		if(pDataF != 0)
+		long long iz = iRow % nz;
+		for(long long ie=0; ie<ne; ie++)
 		{
-			float cosPh, sinPh;
-			float *pE0 = pDataF + im*PerM;
-			double ePh = eStart;
-			for(long long ie=0; ie<ne; ie++)
+			long long Two_ie = ie << 1;
+			const double *pCSZ = arCosSinZ + ie*Two_nz + (iz << 1);
+			const double *pCSX = arCosSinX + ie*Two_nx;
+			if(pDataF != 0)
 			{
-				long long Two_ie = ie << 1;
-				ConstRxE = ConstRx*ePh;
-				ConstRzE = ConstRz*ePh;
-				z = zStart - zc;
-				for(long long iz=0; iz<nz; iz++)
+				float *pE_Re = pDataF + iRow*PerZ + Two_ie;
+				for(long long ix=0; ix<nx; ix++)
 				{
-					long long izPerZ = iz*PerZ;
-					float *pE_StartForX = pE0 + izPerZ;
-					phTermZ = ConstRzE*z*z;
-					x = xStart - xc;
-					for(long long ix=0; ix<nx; ix++)
-					{
-						long long ixPerX_p_Two_ie = ix*PerX + Two_ie;
-						phTerm = phTermZ + ConstRxE*x*x;
-
-						CosAndSin(phTerm, cosPh, sinPh);
-
-						float *pE_Re = pE_StartForX + ixPerX_p_Two_ie;
-						float *pE_Im = pE_Re + 1;
-						double E_ReNew = (*pE_Re)*cosPh - (*pE_Im)*sinPh;
-						double E_ImNew = (*pE_Re)*sinPh + (*pE_Im)*cosPh;
-						*pE_Re = (float)E_ReNew; *pE_Im = (float)E_ImNew;
-
-						x += xStep;
-					}
-					z += zStep;
+					double cosPh = pCSX[0]*pCSZ[0] - pCSX[1]*pCSZ[1];
+					double sinPh = pCSX[0]*pCSZ[1] + pCSX[1]*pCSZ[0];
+					pCSX += 2;
+
+					float *pE_Im = pE_Re + 1;
+					double E_ReNew = (*pE_Re)*cosPh - (*pE_Im)*sinPh;
+					double E_ImNew = (*pE_Re)*sinPh + (*pE_Im)*cosPh;
+					*pE_Re = (float)E_ReNew; *pE_Im = (float)E_ImNew;
+					pE_Re += PerX;
 				}
-				ePh += eStep;
 			}
-		}
-		else if(pDataD != 0)
-		{
-			double cosPh, sinPh;
-			double *pE0 = pDataD + im*PerM;
-			double ePh = eStart;
-			for(long long ie=0; ie<ne; ie++)
+			else if(pDataD != 0)
 			{
-				long long Two_ie = ie << 1;
-				ConstRxE = ConstRx*ePh;
-				ConstRzE = ConstRz*ePh;
-				z = zStart - zc;
-				for(long long iz=0; iz<nz; iz++)
+				double *pE_Re = pDataD + iRow*PerZ + Two_ie;
+				for(long long ix=0; ix<nx; ix++)
 				{
-					long long izPerZ = iz*PerZ;
-					double *pE_StartForX = pE0 + izPerZ;
-					phTermZ = ConstRzE*z*z;
-					x = xStart - xc;
-					for(long long ix=0; ix<nx; ix++)
-					{
-						long long ixPerX_p_Two_ie = ix*PerX + Two_ie;
-						phTerm = phTermZ + ConstRxE*x*x;
-						cosPh = cos(phTerm);
-						sinPh = sin(phTerm);
-
-						double *pE_Re = pE_StartForX + ixPerX_p_Two_ie;
-						double *pE_Im = pE_Re + 1;
-						double E_ReNew = (*pE_Re)*cosPh - (*pE_Im)*sinPh;
-						double E_ImNew = (*pE_Re)*sinPh + (*pE_Im)*cosPh;
-						*pE_Re = E_ReNew; *pE_Im = E_ImNew;
-
-						x += xStep;
-					}
-					z += zStep;
+					double cosPh = pCSX[0]*pCSZ[0] - pCSX[1]*pCSZ[1];
+					double sinPh = pCSX[0]*pCSZ[1] + pCSX[1]*pCSZ[0];
+					pCSX += 2;
+
+					double *pE_Im = pE_Re + 1;
+					double E_ReNew = (*pE_Re)*cosPh - (*pE_Im)*sinPh;
+					double E_ImNew = (*pE_Re)*sinPh + (*pE_Im)*cosPh;
+					*pE_Re = E_ReNew; *pE_Im = E_ImNew;
+					pE_Re += PerX;
 				}
-				ePh += eStep;
 			}
 		}
 	}
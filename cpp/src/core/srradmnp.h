@@ -17,9 +17,12 @@
 #include "sroptelm.h"
 #include "srstraux.h"
 #include "srerror.h"
+#include "srwlprof.h"
 #include "gminterp.h"
 
 #include <complex>
+#include <vector>
+#include <mutex>
 
 //*************************************************************************
 
@@ -41,6 +44,39 @@ struct srTAuxInt2DIntegOverAzim {
 
 //*************************************************************************
 
+class srTAuxInt2DIntegOverAzimPlan {
+//Precomputed resampling for srTRadGenManip::Int2DIntegOverAzim with fixed numbers of points vs azimuth (method 1):
+//each resulting value is a weighted sum of input intensity values, the weights including interpolation and integration over azimuth.
+//Plans are registered process-wide and found by their key (meshes of input and resulting intensities and processing parameters).
+
+	std::vector<long long> m_vRowStart; //start of terms of each resulting point in m_vInd, m_vW (nr + 1 values)
+	std::vector<long long> m_vInd; //indexes of input intensity values
+	std::vector<double> m_vW; //weights
+	long long m_nxny; //number of input intensity values per frame
+
+	static std::vector<CSmartPtr<srTAuxInt2DIntegOverAzimPlan> > m_vReg;
+	static std::mutex m_mtxReg;
+
+public:
+
+	std::vector<double> m_vKey;
+
+	srTAuxInt2DIntegOverAzimPlan(srTWaveAccessData* pwI1, srTWaveAccessData* pwI2, double* arPar, int nPar);
+
+	void Apply(srTWaveAccessData* pwI1, srTWaveAccessData* pwI2, long long nFrames=1);
+
+	static bool SetupKey(srTWaveAccessData* pwI1, srTWaveAccessData* pwI2, double* arPar, int nPar, std::vector<double>& vKey);
+	static void Register(const CSmartPtr<srTAuxInt2DIntegOverAzimPlan>& hPlan);
+	static void Unregister(srTAuxInt2DIntegOverAzimPlan* pPlan);
+	static CSmartPtr<srTAuxInt2DIntegOverAzimPlan> Find(const std::vector<double>& vKey);
+};
+
+struct SRWLStructIntProcPlan { //prepared intensity processing (opaque in C API)
+	CSmartPtr<srTAuxInt2DIntegOverAzimPlan> hPlan;
+};
+
+//*************************************************************************
+
 class srTRadGenManip {
 // Various manipulations with computed Radiation
 	bool EhOK, EvOK; //OC111111
@@ -137,6 +173,23 @@ public:
 			//if(res = ExtractSingleElecIntensity(RadExtract, pGpuUsage)) throw res; //Himanshu?
 		}
 
+		if((RadExtract.Int_or_Phase == 2) && (RadExtract.PlotType == 3) && (pMeth != 0) && (pMeth[0] == 3))
+		{//Optional unwrapping of phase vs x&z (requested by pMeth[0] = 3), pMeth[1]: 1- row/column scan, 2- quality-guided
+			int methUnwrap = (int)pMeth[1];
+			if(methUnwrap > 0)
+			{
+				srTWaveAccessData ExtrWaveData;
+				if(res = SetupExtractedWaveData(RadExtract, ExtrWaveData)) throw res;
+				if(methUnwrap == 1) { if(res = TryToMakePhaseContinuous(ExtrWaveData)) throw res;}
+				else
+				{//intensity is used to exclude points where phase is not defined
+					std::vector<float> vInt(RadAccessData.nx*RadAccessData.nz, 0.f);
+					srTRadExtract RadExtractInt(PolarizCompon, 0, SectID, TransvPres, e, x, z, (char*)(&(vInt[0])));
+					if(res = ExtractSingleElecIntensity(RadExtractInt)) throw res;
+					if(res = UnwrapPhase2D(ExtrWaveData, &(vInt[0]))) throw res;
+				}
+			}
+		}
 		//OCTEST17082019
 		//if((RadExtract.Int_or_Phase == 2) && (RadExtract.PlotType == 3))
 		//{
@@ -209,6 +262,9 @@ public:
 		int Int_or_ReE = RadExtract.Int_or_Phase;
 		//if((PolCom == 6) || (Int_or_ReE != 8)) return CAN_NOT_EXTRACT_MUT_INT;
 		if(Int_or_ReE != 8) return CAN_NOT_EXTRACT_MUT_INT;
+		srTSRWRadStructAccessData& RadAccessData = *((srTSRWRadStructAccessData*)(hRadAccessData.ptr()));
+		long long npMI = (RadExtract.PlotType == 1)? RadAccessData.nx : ((RadExtract.PlotType == 2)? RadAccessData.nz : ((long long)RadAccessData.nx)*((long long)RadAccessData.nz));
+		CSRWLProfScope profScope(srwlProfMutInt, npMI*npMI*RadAccessData.ne*2*sizeof(float));
 
 		//if(RadExtract.PlotType == 0) return ExtractSingleElecMutualIntensityVsE(RadExtract);
 		//else if(RadExtract.PlotType == 1) return ExtractSingleElecMutualIntensityVsX(RadExtract);
@@ -242,6 +298,14 @@ public:
 	}
 **/
 	int TryToMakePhaseContinuous(srTWaveAccessData& WaveData);
+	static int UnwrapPhase2D(srTWaveAccessData& WaveData, float* arInt=0);
+	static long long FindUnwrapPhaseGroup(long long* arNode, long long i, long long& k);
+	static double WrapPhaseDiff(double d) //reduces phase difference to [-Pi, Pi)
+	{
+		const double Pi = 3.1415926535898, TwoPi = 6.2831853071796;
+		if((d >= -Pi) && (d < Pi)) return d;
+		return d - TwoPi*floor(d/TwoPi + 0.5);
+	}
 	void TryToMakePhaseContinuous1D(double* pOutPhase, long long Np, long long i0, float Phi0); //OC26042019
 	//void TryToMakePhaseContinuous1D(double* pOutPhase, long Np, long i0, float Phi0);
 
@@ -300,6 +364,10 @@ public:
 	int ComputeConvolutedIntensity(srTRadExtract&);
 	//int ConvoluteWithElecBeamOverTransvCoord(float*, long long, long long);
 	int ConvoluteWithElecBeamOverTransvCoord(float*, long, long);
+	int ConvolutePairOfIntensSlices(long long iPair, long long nSlices, int nComp, long long ofstCmp, long Nx, long Nz, float* pCmplData, float* pRealSlice, float* arKernX, float* arKernZ, srTRadExtract& RadExtract, void* pvFrwPlan=0, void* pvBckwPlan=0);
+	float PackRealSliceToCmplData(float* pCmplData, float* pRealSlice, long Nx, long Nz, int iReIm);
+	void SetupElecBeamConvKernel(long Nx, long Nz, float* arKernX, float* arKernZ);
+	int ConvoluteWithElecBeamKernel(float* DataToConv, long Nx, long Nz, float* arKernX, float* arKernZ, void* pvFrwPlan=0, void* pvBckwPlan=0);
 	void PutConstPhotEnergySliceInExtractPlace(long long, long long, long long, srTRadExtract&, srTRadExtract&); //OC26042019
 	//void PutConstPhotEnergySliceInExtractPlace(long, long, long, srTRadExtract&, srTRadExtract&);
 	void PropagateElecBeamMoments(srTElecBeamMoments&);
@@ -428,6 +496,83 @@ public:
 		}
 		//return (float)(ExRe*ExRe + ExIm*ExIm + EzRe*EzRe + EzIm*EzIm);
 	}
+	template<int PolCom> static float IntensityComponentFast(float ExRe, float ExIm, float EzRe, float EzIm)
+	{//Same as IntensityComponent(..., PolCom, 0), with polarization component resolved at compile time (so that loops over points can be vectorized)
+		switch(PolCom)
+		{
+			case 0: return ExRe*ExRe + ExIm*ExIm; // Lin. Hor.
+			case 1: return EzRe*EzRe + EzIm*EzIm; // Lin. Vert.
+			case 2: { float ExRe_p_EzRe = ExRe + EzRe, ExIm_p_EzIm = ExIm + EzIm; return (float)(0.5*(ExRe_p_EzRe*ExRe_p_EzRe + ExIm_p_EzIm*ExIm_p_EzIm));} // Linear 45 deg.
+			case 3: { float ExRe_mi_EzRe = ExRe - EzRe, ExIm_mi_EzIm = ExIm - EzIm; return (float)(0.5*(ExRe_mi_EzRe*ExRe_mi_EzRe + ExIm_mi_EzIm*ExIm_mi_EzIm));} // Linear 135 deg.
+			case 5: { float ExRe_mi_EzIm = ExRe - EzIm, ExIm_p_EzRe = ExIm + EzRe; return (float)(0.5*(ExRe_mi_EzIm*ExRe_mi_EzIm + ExIm_p_EzRe*ExIm_p_EzRe));} // Circ. Left
+			case 4: { float ExRe_p_EzIm = ExRe + EzIm, ExIm_mi_EzRe = ExIm - EzRe; return (float)(0.5*(ExRe_p_EzIm*ExRe_p_EzIm + ExIm_mi_EzRe*ExIm_mi_EzRe));} // Circ. Right
+			case -2: return (float)(ExRe*ExRe + ExIm*ExIm - (EzRe*EzRe + EzIm*EzIm)); // s1
+			case -3: return (float)(2.*(ExRe*EzRe + ExIm*EzIm)); // s2
+			case -4: return (float)(2.*(ExRe*EzIm - ExIm*EzRe)); // s3
+			default: return ExRe*ExRe + ExIm*ExIm + EzRe*EzRe + EzIm*EzIm; // Total, s0
+		}
+	}
+
+	static void SetOrAvgExtractedVal(double resInt, double iter, double inv_iter_p_1, float*& pI, double*& pId)
+	{//Stores extracted value, or averages / adds it to existing one (as in ExtractSingleElecIntensity2DvsXZ)
+		if(iter == 0)
+		{
+			if(pI != 0) *(pI++) = (float)resInt;
+			if(pId != 0) *(pId++) = resInt;
+		}
+		else if(iter > 0)
+		{
+			if(pI != 0) { float newI = (float)(((*pI)*iter + resInt)*inv_iter_p_1); *(pI++) = newI;}
+			if(pId != 0) { double newI = ((*pId)*iter + resInt)*inv_iter_p_1; *(pId++) = newI;}
+		}
+		else
+		{
+			if(pI != 0) *(pI++) += (float)resInt;
+			if(pId != 0) *(pId++) += resInt;
+		}
+	}
+
+	template<int PolCom> void ExtractSingleElecIntensityRowXZ(float* pEx_St, float* pEx_Fi, float* pEz_St, float* pEz_Fi, long long PerX, long nx, double InvStepRelArg, double iter, double inv_iter_p_1, float* pI, double* pId)
+	{//Single-electron intensity (one polarization component) vs x at fixed z and photon energy (/time), with linear interpolation vs photon energy (/time)
+		bool InterpE = (pEx_Fi != pEx_St);
+		for(long ix=0; ix<nx; ix++)
+		{
+			float I_St = IntensityComponentFast<PolCom>(*pEx_St, *(pEx_St + 1), *pEz_St, *(pEz_St + 1));
+			double resInt = I_St;
+			if(InterpE)
+			{
+				float I_Fi = IntensityComponentFast<PolCom>(*pEx_Fi, *(pEx_Fi + 1), *pEz_Fi, *(pEz_Fi + 1));
+				resInt = (float)((I_Fi - I_St)*InvStepRelArg + I_St);
+			}
+			SetOrAvgExtractedVal(resInt, iter, inv_iter_p_1, pI, pId);
+			pEx_St += PerX; pEz_St += PerX; pEx_Fi += PerX; pEz_Fi += PerX;
+		}
+	}
+
+	void ExtractSingleElecStokesRowXZ(float* pEx_St, float* pEx_Fi, float* pEz_St, float* pEz_Fi, long long PerX, long nx, double InvStepRelArg, double iter, double inv_iter_p_1, float** arPtrI, double** arPtrId)
+	{//All four Stokes components vs x at fixed z and photon energy (/time), from one pass over field data
+		bool InterpE = (pEx_Fi != pEx_St);
+		float *pI0 = arPtrI[0], *pI1 = arPtrI[1], *pI2 = arPtrI[2], *pI3 = arPtrI[3];
+		double *pId0 = arPtrId[0], *pId1 = arPtrId[1], *pId2 = arPtrId[2], *pId3 = arPtrId[3];
+		for(long ix=0; ix<nx; ix++)
+		{
+			float ExRe = *pEx_St, ExIm = *(pEx_St + 1), EzRe = *pEz_St, EzIm = *(pEz_St + 1);
+			float S_St[] = { IntensityComponentFast<-1>(ExRe, ExIm, EzRe, EzIm), IntensityComponentFast<-2>(ExRe, ExIm, EzRe, EzIm), IntensityComponentFast<-3>(ExRe, ExIm, EzRe, EzIm), IntensityComponentFast<-4>(ExRe, ExIm, EzRe, EzIm) };
+			double S[] = { S_St[0], S_St[1], S_St[2], S_St[3] };
+			if(InterpE)
+			{
+				ExRe = *pEx_Fi; ExIm = *(pEx_Fi + 1); EzRe = *pEz_Fi; EzIm = *(pEz_Fi + 1);
+				float S_Fi[] = { IntensityComponentFast<-1>(ExRe, ExIm, EzRe, EzIm), IntensityComponentFast<-2>(ExRe, ExIm, EzRe, EzIm), IntensityComponentFast<-3>(ExRe, ExIm, EzRe, EzIm), IntensityComponentFast<-4>(ExRe, ExIm, EzRe, EzIm) };
+				for(int k=0; k<4; k++) S[k] = (float)((S_Fi[k] - S_St[k])*InvStepRelArg + S_St[k]);
+			}
+			SetOrAvgExtractedVal(S[0], iter, inv_iter_p_1, pI0, pId0);
+			SetOrAvgExtractedVal(S[1], iter, inv_iter_p_1, pI1, pId1);
+			SetOrAvgExtractedVal(S[2], iter, inv_iter_p_1, pI2, pId2);
+			SetOrAvgExtractedVal(S[3], iter, inv_iter_p_1, pI3, pId3);
+			pEx_St += PerX; pEz_St += PerX; pEx_Fi += PerX; pEz_Fi += PerX;
+		}
+	}
+
 #ifdef _OFFLOAD_GPU //HG30112023
 	GPU_PORTABLE
 #endif
@@ -777,10 +922,23 @@ public:
 		if(ChangeSign) { Cos = -Cos; Sin = -Sin; }
 	}
 
+	static void SetupQuadPhTermCosSin(double ConstR, double xStart, double xStep, long long nx, double* arCosSin)
+	{//cos and sin of ConstR*x^2 at nx points (x is incremented as in the loops over data)
+		double x = xStart;
+		double *t = arCosSin;
+		for(long long ix=0; ix<nx; ix++)
+		{
+			double ph = ConstR*x*x;
+			*(t++) = cos(ph); *(t++) = sin(ph);
+			x += xStep;
+		}
+	}
+
 
 	static void IntProc(srTWaveAccessData* pwI1, srTWaveAccessData* pwI2, double* arPar, int nPar); //OC09032019
 	//static void IntProc(srTWaveAccessData* pwI1, srTWaveAccessData* pwI2, double* arPar);
 	static void Int2DIntegOverAzim(srTWaveAccessData* pwI1, srTWaveAccessData* pwI2, double* arPar, int nPar); //OC09032019
+	static void Int2DIntegOverAzimMult(srTWaveAccessData* pwI1, srTWaveAccessData* pwI2, long long nFrames, double* arPar, int nPar);
 	//static void Int2DIntegOverAzim(srTWaveAccessData* pwI1, srTWaveAccessData* pwI2, double* arPar);
 	static void MutualIntFillHalfHermit(srTWaveAccessData* pwI); //OC06022021
 	static void MutualIntSumPart(srTWaveAccessData* pwI1, srTWaveAccessData* pwI2, long iterAvg=-1); //OC25042021
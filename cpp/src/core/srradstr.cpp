@@ -20,6 +20,7 @@
 #include "gmfft.h"
 #include "gmmeth.h"
 #include "gminterp.h"
+#include "srwlctx.h"
 
 #ifdef __IGOR_PRO__
 #ifndef __SRSEND_H
@@ -30,8 +31,6 @@
 //*************************************************************************
 
 extern int (*pgWfrExtModifFunc)(int Action, srTSRWRadInData* pWfrIn, char PolComp);
-extern int (*gpWfrModifFunc)(int action, SRWLWfr* pWfrIn, char pol); //SRWLIB
-extern char* (*gpAllocArrayFunc)(char type, long long len); //OC15082018
 
 //*************************************************************************
 
@@ -362,9 +361,9 @@ void srTSRWRadStructAccessData::AuxSetupActionsArbSrc(SRWLWfr& srwlWfr, double R
 			srwlWfr.mesh.nx = nxNew; srwlWfr.mesh.ny = nzNew;
 			//OutSRWRadPtrs(srwlWfr);
 			//(*pgWfrExtModifFunc)(2, pRadInData, 0);
-			if(gpWfrModifFunc != 0) 
+			if(srwlCurWfrModifFunc() != 0) 
 			{//wavefront resizing from external application!
-				if((*gpWfrModifFunc)(2, &srwlWfr, 0)) throw SRWL_WFR_EXT_MODIF_FAILED; 
+				if((*srwlCurWfrModifFunc())(2, &srwlWfr, 0)) throw SRWL_WFR_EXT_MODIF_FAILED; 
 			}
 			else throw SRWL_WFR_EXT_FUNC_NOT_DEFINED; 
 
@@ -412,9 +411,9 @@ void srTSRWRadStructAccessData::AuxSetupActions2SR(SRWLWfr& srwlWfr, srTTrjDat&
 			srwlWfr.nx = nxNew; srwlWfr.ny = nzNew;
 			//OutSRWRadPtrs(srwlWfr);
 			//(*pgWfrExtModifFunc)(2, pRadInData, 0);
-			if(gpWfrModifFunc != 0) 
+			if(srwlCurWfrModifFunc() != 0) 
 			{//wavefront resizing from external application!
-				if((*gpWfrModifFunc)(2, &srwlWfr, 0)) throw SRWL_WFR_EXT_MODIF_FAILED; 
+				if((*srwlCurWfrModifFunc())(2, &srwlWfr, 0)) throw SRWL_WFR_EXT_MODIF_FAILED; 
 			}
 			else throw SRWL_WFR_EXT_FUNC_NOT_DEFINED; 
 
@@ -772,18 +771,18 @@ int srTSRWRadStructAccessData::ModifyWfrNeNxNz(char PolarizComp, bool backupIsRe
 
 		InSRWRadPtrs(&AuxRadInData);
 	}
-	else if((gpWfrModifFunc != 0) && (m_pExtWfr != 0))
+	else if((srwlCurWfrModifFunc() != 0) && (m_pExtWfr != 0))
 	{
 		SRWLWfr *pExtWfr = (SRWLWfr*)m_pExtWfr;
 		OutSRWRadPtrs(*pExtWfr);
 
 		int actNum = 2;
 		if(backupIsReq) actNum = 12; //OC131115
-		if((*gpWfrModifFunc)(actNum, pExtWfr, PolarizComp)) return SRWL_WFR_EXT_MODIF_FAILED;
+		if((*srwlCurWfrModifFunc())(actNum, pExtWfr, PolarizComp)) return SRWL_WFR_EXT_MODIF_FAILED;
 
 		InSRWRadPtrs(*pExtWfr);
 	}
-	else if(gpWfrModifFunc == 0) return SRWL_WFR_EXT_FUNC_NOT_DEFINED;
+	else if(srwlCurWfrModifFunc() == 0) return SRWL_WFR_EXT_FUNC_NOT_DEFINED;
 	else if(pgWfrExtModifFunc == 0) return SRWL_WFR_EXT_FUNC_NOT_DEFINED;
 
 	return 0;
@@ -801,7 +800,7 @@ int srTSRWRadStructAccessData::AllocExtIntArray(char type, char dep, char*& pcAl
 #if defined(SRWLIB_STATIC) || defined(SRWLIB_SHARED) 
 	
 	pcAlloc = 0;
-	if(gpAllocArrayFunc != 0)
+	if(srwlCurAllocArrayFunc() != 0)
 	{
 		char typeAr = 'f';
 		if(type == 4) typeAr = 'd'; //single-e rad. phase
@@ -809,7 +808,7 @@ int srTSRWRadStructAccessData::AllocExtIntArray(char type, char dep, char*& pcAl
 		long long np = GetIntNumPts(dep);
 		if(np > 0)
 		{
-			pcAlloc = (*gpAllocArrayFunc)(typeAr, np);
+			pcAlloc = (*srwlCurAllocArrayFunc())(typeAr, np);
 			if(pcAlloc == 0) return SRWL_EXT_ARRAY_ALLOC_FAILED;
 		}
 	}
@@ -824,13 +823,13 @@ int srTSRWRadStructAccessData::DeleteWfrBackupData(char PolarizComp)
 {//OC131115
 #if defined(SRWLIB_STATIC) || defined(SRWLIB_SHARED) 
 
-	if((gpWfrModifFunc != 0) && (m_pExtWfr != 0))
+	if((srwlCurWfrModifFunc() != 0) && (m_pExtWfr != 0))
 	{
 		SRWLWfr *pExtWfr = (SRWLWfr*)m_pExtWfr;
 		OutSRWRadPtrs(*pExtWfr);
 
 		int actNum = 20; //Delete backup data
-		if((*gpWfrModifFunc)(actNum, pExtWfr, PolarizComp)) return SRWL_WFR_EXT_MODIF_FAILED;
+		if((*srwlCurWfrModifFunc())(actNum, pExtWfr, PolarizComp)) return SRWL_WFR_EXT_MODIF_FAILED;
 
 		InSRWRadPtrs(*pExtWfr);
 	}
@@ -3934,17 +3933,18 @@ int srTSRWRadStructAccessData::SetRepresFT(char FreqOrTime)
 	FFT1DInfo.MultExtra = multPreInt; //1./multConv; //???
 	FFT1DInfo.ApplyAutoShiftAfter = false;
 
-	CGenMathFFT1D FFT1D;
-	if(pBaseRadX != 0)
-	{
-		FFT1DInfo.pInData = pBaseRadX;
-		FFT1DInfo.pOutData = pBaseRadX;
-		if(result = FFT1D.Make1DFFT(FFT1DInfo)) return result;
-	}
-	if(pBaseRadZ != 0)
+	//Both polarization components are transformed by one call (with one plan, one set of shift multipliers, 
+	//and normalization / shifts applied in one pass per energy-vector):
+	float *pFirst = (pBaseRadX != 0)? pBaseRadX : pBaseRadZ;
+	float *pSecond = (pBaseRadX != 0)? pBaseRadZ : 0;
+	if(pFirst != 0)
 	{
-		FFT1DInfo.pInData = pBaseRadZ;
-		FFT1DInfo.pOutData = pBaseRadZ;
+		FFT1DInfo.pInData = pFirst;
+		FFT1DInfo.pOutData = pFirst;
+		FFT1DInfo.pInData2 = pSecond;
+		FFT1DInfo.pOutData2 = pSecond;
+
+		CGenMathFFT1D FFT1D;
 		if(result = FFT1D.Make1DFFT(FFT1DInfo)) return result;
 	}
 
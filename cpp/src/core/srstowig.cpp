@@ -16,6 +16,10 @@
 #include "gmfft.h"
 #include "srerror.h"
 
+#ifdef _WITH_OMP //Pre-processor definition for compiling with OpenMP library
+#include "omp.h"
+#endif
+
 //*************************************************************************
 
 int srTRadIntWiggler::CheckInputConsistency()
@@ -68,45 +72,83 @@ int srTRadIntWiggler::ComputeTotalStokesDistr(srTStokesStructAccessData& StokesA
 	long long PerX = StokesAccessData.ne*PerE;
 	long long PerZ = StokesAccessData.nx*PerX;
 	
-	EXZ.z = StokesAccessData.zStart;
-
 	//long TotalAmOfOutPoints = DistrInfoDat.nz*DistrInfoDat.nx*DistrInfoDat.nLamb;
 	long long TotalAmOfOutPoints = ((long long)DistrInfoDat.nz)*((long long)DistrInfoDat.nx)*((long long)DistrInfoDat.nLamb);
 	if(FinalResAreSymOverX) TotalAmOfOutPoints >>= 1;
 	if(FinalResAreSymOverZ) TotalAmOfOutPoints >>= 1;
-	//long PointCount = 0;
-	long long PointCount = 0;
 	double UpdateTimeInt_s = 0.5;
 	srTCompProgressIndicator CompProgressInd(TotalAmOfOutPoints, UpdateTimeInt_s);
 
-	for(int iz=0; iz<DistrInfoDat.nz; iz++)
+	//In the case of symmetry, only the points with x <= xc (z <= zc) are calculated; the rest is filled-in by FillInSymPartsOfResults
+	long long nxCalc = DistrInfoDat.nx, nzCalc = DistrInfoDat.nz;
+	if(FinalResAreSymOverX) { nxCalc = 0; while((nxCalc < DistrInfoDat.nx) && ((StokesAccessData.xStart + nxCalc*StokesAccessData.xStep - xc) <= xTol)) nxCalc++;}
+	if(FinalResAreSymOverZ) { nzCalc = 0; while((nzCalc < DistrInfoDat.nz) && ((StokesAccessData.zStart + nzCalc*StokesAccessData.zStep - zc) <= zTol)) nzCalc++;}
+	long long nPtCalc = nxCalc*nzCalc;
+
+	srTRadIntWiggler *arWorkers = 0;
+#ifdef _WITH_OMP
+	//Transverse observation points are distributed over threads; each thread uses its own worker (with own radiation intervals and scratch arrays)
+	int nThreads = omp_get_max_threads();
+	arWorkers = new srTRadIntWiggler[nThreads];
+	for(int i=0; i<nThreads; i++)
 	{
-		if(FinalResAreSymOverZ) { if((EXZ.z - zc) > zTol) break;}
-		
-		//long izPerZ = iz*PerZ;
-		long long izPerZ = iz*PerZ;
-		EXZ.x = StokesAccessData.xStart;
-		for(int ix=0; ix<DistrInfoDat.nx; ix++)
+		if(result = arWorkers[i].SetupAsWorkerOf(*this)) { delete[] arWorkers; return result;}
+	}
+#endif
+
+	int resPar = 0;
+	CErrWarnBind WarnBind(&gVectWarnNos); //warnings of worker threads go to the list of calling thread
+#ifdef _WITH_OMP
+	#pragma omp parallel firstprivate(WarnBind)
+#endif
+	{
+		srTCompProgressCounter ProgressCounter(CompProgressInd); //points are counted per thread and passed to the shared indicator at a bounded rate
+#ifdef _WITH_OMP
+		#pragma omp for schedule(dynamic)
+#endif
+		for(long long ip=0; ip<nPtCalc; ip++)
 		{
-			if(FinalResAreSymOverX) { if((EXZ.x - xc) > xTol) break;}
-			
-			//long ixPerX = ix*PerX;
-			long long ixPerX = ix*PerX;
-			EXZ.e = StokesAccessData.eStart;
+			int resCur = 0;
+#ifdef _WITH_OMP
+			#pragma omp atomic read
+			resCur = resPar;
+			if(resCur != 0) continue; //error or abort: skip remaining points
+
+			int iThr = omp_get_thread_num();
+			srTRadIntWiggler &RadInt = arWorkers[iThr];
+#else
+			int iThr = 0;
+			srTRadIntWiggler &RadInt = *this;
+#endif
+			long long iz = ip/nxCalc, ix = ip - iz*nxCalc;
+			double z = StokesAccessData.zStart + iz*StokesAccessData.zStep;
+			double x = StokesAccessData.xStart + ix*StokesAccessData.xStep;
+
+			long long OffsetXZ = iz*PerZ + ix*PerX;
 			for(int ie=0; ie<DistrInfoDat.nLamb; ie++)
 			{
-				float* pStokes = StokesAccessData.pBaseSto + izPerZ + ixPerX +ie*PerE;
-				if(result = ComputeStokesAtPoint(pStokes)) return result;
+				long long OffsetStokes = OffsetXZ + ie*PerE;
+				RadInt.SetupObsPoint(StokesAccessData.eStart + ie*StokesAccessData.eStep, x, z, OffsetStokes);
+				if(resCur = RadInt.ComputeStokesAtPoint(StokesAccessData.pBaseSto + OffsetStokes)) break;
+			}
 
-				if(result = srYield.Check()) return result;
-				if(result = CompProgressInd.UpdateIndicator(PointCount++)) return result;
-				
-				EXZ.e += StokesAccessData.eStep;
+			if((resCur == 0) && (iThr == 0)) resCur = srYield.Check(); //yield is only called from the "master" thread
+			if(resCur == 0) resCur = ProgressCounter.Add(DistrInfoDat.nLamb);
+			if(resCur != 0)
+			{
+#ifdef _WITH_OMP
+				#pragma omp atomic write
+				resPar = resCur;
+#else
+				resPar = resCur;
+				break;
+#endif
 			}
-			EXZ.x += StokesAccessData.xStep;
 		}
-		EXZ.z += StokesAccessData.zStep;
 	}
+	if(arWorkers != 0) delete[] arWorkers;
+	if(resPar != 0) return resPar;
+
 	DeallocateIntervalsArray();
 	FieldBasedArrays.DisposeArrays();
 
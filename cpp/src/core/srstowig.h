@@ -122,6 +122,8 @@ class srTRadIntWiggler {
 	char IncludeCrossTermsG;
 	double Gx, Gz;
 
+	srTRadIntWiggler* m_pMasterRadInt; //if not 0, this object is a per-thread worker which shares field-based arrays of the "master" one
+
 public:
 
 	srTTrjDat* TrjDatPtr;
@@ -133,7 +135,37 @@ public:
 
 	srTRadIntWiggler()
 	{
+		m_pMasterRadInt = 0;
+		Initialize();
+	}
+	~srTRadIntWiggler()
+	{
+		if(m_pMasterRadInt != 0) FieldBasedArrays.ZeroPtrs(); //these arrays belong to the master
+		DeallocateIntervalsArray();
+	}
+
+	int SetupAsWorkerOf(srTRadIntWiggler& Master)
+	{//to be called after Master has set up field-based arrays and precision parameters;
+	 //the worker keeps its own radiation intervals, auxiliary trajectory arrays and observation point
+		m_pMasterRadInt = &Master;
+		TrjDatPtr = Master.TrjDatPtr;
+		DistrInfoDat = Master.DistrInfoDat;
+		IntWigPrec = Master.IntWigPrec;
+		LongIntTypeG = Master.LongIntTypeG;
 		Initialize();
+
+		FieldBasedArrays = Master.FieldBasedArrays;
+		sIntegRelPrecG = Master.sIntegRelPrecG; RelTolForAnTermsG = Master.RelTolForAnTermsG;
+		NormalizingConst = Master.NormalizingConst;
+		MaxIntValWithinPointG = Master.MaxIntValWithinPointG; MinEstIntValWithinPointG = Master.MinEstIntValWithinPointG;
+		CrossTermsContribArray = Master.CrossTermsContribArray; //results for cross terms are written by tCrossTermsContribG, set up for each point
+		Gx = Master.Gx; Gz = Master.Gz;
+		return AllocateIntervalsArray(FieldBasedArrays.Ns);
+	}
+	void SetupObsPoint(double e, double x, double z, long long OffsetStokes)
+	{
+		EXZ.e = e; EXZ.x = x; EXZ.z = z;
+		if(CrossTermsContribArray != 0) tCrossTermsContribG = CrossTermsContribArray + OffsetStokes;
 	}
 	void Initialize() 
 	{
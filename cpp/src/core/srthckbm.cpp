@@ -18,6 +18,15 @@
 //#include "srmamet.h"
 #include "gmmeth.h"
 #include "gmfunc.h"
+#include "srerror.h"
+
+#ifdef _WITH_OMP //Pre-processor definition for compiling with OpenMP library
+#include "omp.h"
+#endif
+
+//*************************************************************************
+
+extern srTIntVect gVectWarnNos;
 
 //*************************************************************************
 
@@ -141,7 +150,8 @@ void srTRadIntThickBeam::ComputeTotalStokesDistr(srTEbmDat* pElecBeam, srTMagFld
 	
 	char FinalResAreSymOverX=0, FinalResAreSymOverZ=0;
 	AnalyzeFinalResultsSymmetry(FinalResAreSymOverX, FinalResAreSymOverZ, pElecBeam, pTrjDat, pMagLensCont, pStokes);
-	srTCompProgressIndicator CompProgressInd(FindTotalAmOfPointsToCalc(pStokes, FinalResAreSymOverX, FinalResAreSymOverZ), 0.5, 1);
+	//srTCompProgressIndicator CompProgressInd(FindTotalAmOfPointsToCalc(pStokes, FinalResAreSymOverX, FinalResAreSymOverZ), 0.5, 1);
+	srTCompProgressIndicator CompProgressInd(FindTotalAmOfPointsToCalc(pStokes, FinalResAreSymOverX, FinalResAreSymOverZ), 0.5);
 
 	SetupInitialTrajArrays(pTrjDat, pMagLensCont, pPrcPar);
 
@@ -158,6 +168,12 @@ void srTRadIntThickBeam::ComputeTotalStokesDistr(srTEbmDat* pElecBeam, srTMagFld
 	double zc = pElecBeam->z0;
 	double xTol = (pStokes->xStep)*0.001, zTol = (pStokes->zStep)*0.001; // To steer
 
+	//In the case of symmetry, only the points with x <= xc (z <= zc) are calculated; the rest is filled-in by FillInSymPartsOfResults
+	long long nxCalc = pStokes->nx, nzCalc = pStokes->nz;
+	if(FinalResAreSymOverX) { nxCalc = 0; while((nxCalc < pStokes->nx) && ((pStokes->xStart + nxCalc*(pStokes->xStep) - xc) <= xTol)) nxCalc++;}
+	if(FinalResAreSymOverZ) { nzCalc = 0; while((nzCalc < pStokes->nz) && ((pStokes->zStart + nzCalc*(pStokes->zStep) - zc) <= zTol)) nzCalc++;}
+	long long nPtCalc = nxCalc*nzCalc;
+
 	int res = 0;
     float* pBaseStokes = pStokes->pBaseSto;
 
@@ -170,49 +186,92 @@ void srTRadIntThickBeam::ComputeTotalStokesDistr(srTEbmDat* pElecBeam, srTMagFld
 	//	EXZY.dz = ((pStokes->nz) - 1)*(pStokes->zStep);
 	//}
 
-	//loop according to pStokes
-	EXZY.y = pStokes->yStart;
-	for(int iy=0; iy<pStokes->ny; iy++)
+	srTRadIntThickBeam *arWorkers = 0;
+#ifdef _WITH_OMP
+	//Observation points of one (y, e) block are calculated in parallel; each thread uses its own worker (with own obs. point state),
+	//sharing trajectory arrays and exp. coefficients (which only depend on y and e) with this object
+	int nThreads = omp_get_max_threads();
+	arWorkers = new srTRadIntThickBeam[nThreads];
+	for(int i=0; i<nThreads; i++) arWorkers[i].SetupAsWorkerOf(*this);
+#endif
+
+	try
 	{
-		//long iyPerY = iy*PerY;
-		long long iyPerY = iy*PerY;
-		EXZY.e = pStokes->eStart;
-		for(int ie=0; ie<pStokes->ne; ie++)
+		//loop according to pStokes
+		EXZY.y = pStokes->yStart;
+		for(int iy=0; iy<pStokes->ny; iy++)
 		{
-            //long iePerE = ie*PerE;
-            long long iePerE = ie*PerE;
-
-            ComputeExpCoefXZArraysForInteg2D(EXZY.y, EXZY.e, *pPrcPar);
-
-			EXZY.z = pStokes->zStart;
-			for(int iz=0; iz<pStokes->nz; iz++)
+			//long iyPerY = iy*PerY;
+			long long iyPerY = iy*PerY;
+			EXZY.e = pStokes->eStart;
+			for(int ie=0; ie<pStokes->ne; ie++)
 			{
-				if(FinalResAreSymOverZ) { if((EXZY.z - zc) > zTol) break;}
-				//long izPerZ = iz*PerZ;
-				long long izPerZ = iz*PerZ;
+				//long iePerE = ie*PerE;
+				long long iePerE = ie*PerE;
 
-				EXZY.x = pStokes->xStart;
-				for(int ix=0; ix<pStokes->nx; ix++)
-				{
-					if(FinalResAreSymOverX) { if((EXZY.x - xc) > xTol) break;}
-					//long ixPerX = ix*PerX;
-					long long ixPerX = ix*PerX;
+				ComputeExpCoefXZArraysForInteg2D(EXZY.y, EXZY.e, *pPrcPar);
 
-					srTStokes CurSt;
-					ComputeStokesAtOneObsPoint(EXZY, *pPrcPar, CurSt);
-
-					float* pSto = pBaseStokes + (iyPerY + izPerZ + ixPerX + iePerE);
-					*(pSto++) = (float)CurSt.s0; *(pSto++) = (float)CurSt.s1; *(pSto++) = (float)CurSt.s2; *pSto = (float)CurSt.s3;
-
-					if(res = CompProgressInd.UpdateIndicator()) throw res;
-					EXZY.x += pStokes->xStep;
+				CErrWarnBind WarnBind(&gVectWarnNos); //warnings of worker threads go to the list of calling thread
+#ifdef _WITH_OMP
+				#pragma omp parallel firstprivate(EXZY, WarnBind)
+#endif
+				{
+					srTCompProgressCounter ProgressCounter(CompProgressInd); //points are counted per thread and passed to the shared indicator at a bounded rate
+#ifdef _WITH_OMP
+					#pragma omp for schedule(dynamic)
+#endif
+					for(long long ip=0; ip<nPtCalc; ip++)
+					{
+						int resCur = 0;
+#ifdef _WITH_OMP
+						#pragma omp atomic read
+						resCur = res;
+						if(resCur != 0) continue; //error or abort requested: skip remaining points
+
+						srTRadIntThickBeam &RadInt = arWorkers[omp_get_thread_num()];
+#else
+						srTRadIntThickBeam &RadInt = *this;
+#endif
+						long long iz = ip/nxCalc, ix = ip - iz*nxCalc;
+						EXZY.z = pStokes->zStart + iz*(pStokes->zStep);
+						EXZY.x = pStokes->xStart + ix*(pStokes->xStep);
+
+						srTStokes CurSt;
+						try { RadInt.ComputeStokesAtOneObsPoint(EXZY, *pPrcPar, CurSt);}
+						catch(int ErrNo) { resCur = ErrNo;}
+
+						if(resCur == 0)
+						{
+							float* pSto = pBaseStokes + (iyPerY + iz*PerZ + ix*PerX + iePerE);
+							*(pSto++) = (float)CurSt.s0; *(pSto++) = (float)CurSt.s1; *(pSto++) = (float)CurSt.s2; *pSto = (float)CurSt.s3;
+						}
+
+						if(resCur == 0) resCur = ProgressCounter.Add();
+						if(resCur != 0)
+						{
+#ifdef _WITH_OMP
+							#pragma omp atomic write
+							res = resCur;
+#else
+							res = resCur; break;
+#endif
+						}
+					}
 				}
-				EXZY.z += pStokes->zStep;
+				if(res != 0) throw res;
+
+				EXZY.e += pStokes->eStep;
 			}
-			EXZY.e += pStokes->eStep;
+			EXZY.y += pStokes->yStep;
 		}
-		EXZY.y += pStokes->yStep;
 	}
+	catch(int ErrNo)
+	{
+		if(arWorkers != 0) delete[] arWorkers;
+		if(pTrjDat != 0) delete pTrjDat;
+		throw ErrNo;
+	}
+	if(arWorkers != 0) delete[] arWorkers;
 
 	if(FinalResAreSymOverZ || FinalResAreSymOverX) FillInSymPartsOfResults(FinalResAreSymOverX, FinalResAreSymOverZ, pStokes);
 	if(pTrjDat != 0) delete pTrjDat;
@@ -508,20 +567,25 @@ void srTRadIntThickBeam::ComputeStokesAtOneObsPoint(srTEXZY EXZY, srTParPrecStok
     gAuxPar.zObsE2 = EXZY.z*EXZY.z;
     gAuxPar.xzObs = EXZY.x*EXZY.z;
 
+	double *m = gAuxPar.arMonXZ;
+	m[0] = 1.; m[1] = EXZY.x; m[2] = EXZY.z; m[3] = gAuxPar.xObsE2; m[4] = gAuxPar.xzObs; m[5] = gAuxPar.zObsE2;
+
+	srTFieldBasedArrays &FldArr = CurFldArr(); //workers use trajectory arrays of their master
+
 	if(PrecPar.MethNo == 1)
 	{
 		srTStokes StExt;
 		if(PrecPar.IntOrFlux == 'i') 
 		{
-            ComputeStokesAtOneObsPoint_Intens_PrepAandB(gFldArr, 0, 0, gFldArr.Ns, 4, gBottomArrA, gBottomArrB);
-            ComputeStokesAtOneObsPoint_Intens_PrepAandB(gFldArr, gFldArr.Ns - 4, 4, 4, gFldArr.Ns - 4, gRightArrA, gRightArrB);
+            ComputeStokesAtOneObsPoint_Intens_PrepAandB(FldArr, 0, 0, FldArr.Ns, 4, gBottomArrA, gBottomArrB);
+            ComputeStokesAtOneObsPoint_Intens_PrepAandB(FldArr, FldArr.Ns - 4, 4, 4, FldArr.Ns - 4, gRightArrA, gRightArrB);
 
-			ComputeStokesAtOneObsPoint_ExternIntens(gFldArr, StExt);
-            ComputeStokesAtOneObsPoint_InternIntens_EvenMesh(gFldArr, CurSt);
+			ComputeStokesAtOneObsPoint_ExternIntens(FldArr, StExt);
+            ComputeStokesAtOneObsPoint_InternIntens_EvenMesh(FldArr, CurSt);
 		}
 		//else if(PrecPar.IntOrFlux == 'f') 
 		//{
-        //	ComputeStokesAtOneObsPoint_ExternFlux(EXZY, gFldArr, CompKey, StExt);
+        //	ComputeStokesAtOneObsPoint_ExternFlux(EXZY, FldArr, CompKey, StExt);
 		//}
 
 		//OC//CurSt += StExt; //to uncomment
@@ -881,24 +945,26 @@ void srTRadIntThickBeam::ComputeStokesAtOneObsPoint_ExternIntens_AddTopRight(srT
 
 void srTRadIntThickBeam::ComputeExpCoefXZArraysForInteg2D_EvenMesh(double yObs, double eObs, srTFieldBasedArrays& FldArr, TComplexD* ArrA, TComplexD* ArrB)
 {
-	TComplexD *pA = ArrA, *pB = ArrB;
 	//long Ns = FldArr.Ns;
 	long long Ns = FldArr.Ns;
 	long TotNumCoefForOnePointA = gNumCoefForOnePointA*4; //for 4 stokes components
 
-	//long AuxCount = 0;
-	long long AuxCount = 0;
+	//Rows of the triangular (ist <= is) coefficient arrays are independent (same indexing as in ComputeStokesAtOneObsPoint_Intens_PrepAandB)
+#ifdef _WITH_OMP
+	#pragma omp parallel for schedule(dynamic)
+#endif
 	//for(long ist=0; ist<Ns; ist++)
 	for(long long ist=0; ist<Ns; ist++)
 	{
+		long long Offset1 = ((ist*((Ns << 1) - 1 - ist)) >> 1) + ist;
+		TComplexD *pA = ArrA + Offset1*TotNumCoefForOnePointA, *pB = ArrB + Offset1*gNumCoefForOnePointB;
+
 		//for(long is=ist; is<Ns; is++)
 		for(long long is=ist; is<Ns; is++)
 		{
             ComputeExpCoefForOneObsPoint(is, ist, yObs, eObs, FldArr, pA, pB);
             pA += TotNumCoefForOnePointA;
             pB += gNumCoefForOnePointB;
-
-			AuxCount++; //for debugging
 		}
 	}
 }
@@ -52,6 +52,7 @@ struct srTRadIntThickBeamAuxParams {
 
 	srTEXZY EXZY;
 	double xObsE2, zObsE2, xzObs;
+	double arMonXZ[6]; //1, xObs, zObs, xObs^2, xObs*zObs, zObs^2
 
 	void Setup(srTEbmDat& ElecBeam);
 };
@@ -70,6 +71,8 @@ class srTRadIntThickBeam {
 
 	double m_SpareElecEnergyVal;
 
+	srTRadIntThickBeam* m_pMasterRadInt; //if not 0, this object is a per-thread worker which shares trajectory arrays and exp. coefficients of the "master" one
+
 public:
 
 	//srTRadIntThickBeam(srTEbmDat* pElecBeam, srTMagFldTrUnif* pMagFldTrUnif, srTMagFldCont* pMagLensCont, void* pPrcPar)
@@ -95,11 +98,16 @@ public:
 		gCoefB = 0;
 		gBottomArrA = gBottomArrB = gRightArrA = gRightArrB = 0;
 		m_SpareElecEnergyVal = 0;
+		m_pMasterRadInt = 0;
 	}
 	void DeleteAuxStruct()
 	{
-		if(gCoefA != 0) { delete gCoefA; gCoefA = 0;}
-		if(gCoefB != 0) { delete gCoefB; gCoefB = 0;}
+		if(m_pMasterRadInt == 0)
+		{//coefficient arrays of a worker belong to its master
+			if(gCoefA != 0) delete gCoefA;
+			if(gCoefB != 0) delete gCoefB;
+		}
+		gCoefA = 0; gCoefB = 0;
 
 		if(gBottomArrA != 0) { delete gBottomArrA; gBottomArrA = 0;}
 		if(gBottomArrB != 0) { delete gBottomArrB; gBottomArrB = 0;}
@@ -107,6 +115,18 @@ public:
 		if(gRightArrB != 0) { delete gRightArrB; gRightArrB = 0;}
 	}
 
+	void SetupAsWorkerOf(srTRadIntThickBeam& Master)
+	{//to be called after Master.SetupInitialTrajArrays; the worker keeps its own obs. point parameters and "bottom" / "right" arrays
+		m_pMasterRadInt = &Master;
+		gAuxPar = Master.gAuxPar;
+		gCoefA = Master.gCoefA; gCoefB = Master.gCoefB;
+		if(Master.gBottomArrA != 0) AllocateFuncArraysForExternInteg(Master.gFldArr.Ns);
+	}
+	srTFieldBasedArrays& CurFldArr()
+	{
+		return (m_pMasterRadInt != 0)? m_pMasterRadInt->gFldArr : gFldArr;
+	}
+
 	static void ComputeStokes(srTEbmDat* pElecBeam, srTMagFldTrUnif* pMagFldTrUnif, srTMagFldCont* pMagLensCont, srTParPrecStokesArb* pPrcPar, srTStokesStructAccessData* pStokes);
     void ComputeTotalStokesDistr(srTEbmDat* pElecBeam, srTMagFldTrUnif* pMagFldTrUnif, srTMagFldCont* pMagLensCont, srTParPrecStokesArb* pPrcPar, srTStokesStructAccessData* pStokes);
     void ComputeTotalStokesDistrViaSingleElec(srTEbmDat* pElecBeam, srTMagFldTrUnif* pMagFldTrUnif, srTParPrecStokesArb* pPrcPar, srTStokesStructAccessData* pStokes);
@@ -154,16 +174,25 @@ public:
 	void ComputeIntensFuncPartsForInteg2D(double s, double us, TComplexD* ArrA, TComplexD* ArrB, TComplexD* pA_Stokes, TComplexD& B)
 	{
 		//double xObsE2 = xObs*xObs, zObsE2 = zObs*zObs, xzObs = xObs*zObs;
-		double &xObs = gAuxPar.EXZY.x, &yObs = gAuxPar.EXZY.y, &zObs = gAuxPar.EXZY.z;
-		double &xObsE2 = gAuxPar.xObsE2, &zObsE2 = gAuxPar.zObsE2, &xzObs = gAuxPar.xzObs;
+		//double &xObs = gAuxPar.EXZY.x, &yObs = gAuxPar.EXZY.y, &zObs = gAuxPar.EXZY.z;
+		//double &xObsE2 = gAuxPar.xObsE2, &zObsE2 = gAuxPar.zObsE2, &xzObs = gAuxPar.xzObs;
+		//B = ArrB[0] + (xObs*ArrB[1]) + (zObs*ArrB[2]) + (xObsE2*ArrB[3]) + (xzObs*ArrB[4]) + (zObsE2*ArrB[5]);
+		//The coefficients are polynomials in (xObs, zObs): real and imaginary parts are accumulated separately over the monomials set up in ComputeStokesAtOneObsPoint
+		const double *m = gAuxPar.arMonXZ;
+		double yObs = gAuxPar.EXZY.y;
+
+		double ReB = 0., ImB = 0.;
+		for(int j=0; j<gNumCoefForOnePointA; j++) { ReB += m[j]*ArrB[j].x; ImB += m[j]*ArrB[j].y;}
+		B.x = ReB; B.y = ImB;
 
-		B = ArrB[0] + (xObs*ArrB[1]) + (zObs*ArrB[2]) + (xObsE2*ArrB[3]) + (xzObs*ArrB[4]) + (zObsE2*ArrB[5]);
 		TComplexD Mult = (1./((yObs - s)*(yObs - us)))*ArrB[6];
-		int IndA = 0;
+		const TComplexD *tArrA = ArrA;
 		for(int i=0; i<4; i++)
 		{
-            pA_Stokes[i] = Mult*(ArrA[IndA] + (xObs*ArrA[IndA + 1]) + (zObs*ArrA[IndA + 2]) + (xObsE2*ArrA[IndA + 3]) + (xzObs*ArrA[IndA + 4]) + (zObsE2*ArrA[IndA + 5]));
-            IndA += gNumCoefForOnePointA;
+			double ReA = 0., ImA = 0.;
+			for(int j=0; j<gNumCoefForOnePointA; j++) { ReA += m[j]*tArrA[j].x; ImA += m[j]*tArrA[j].y;}
+			pA_Stokes[i] = Mult*TComplexD(ReA, ImA);
+			tArrA += gNumCoefForOnePointA;
 		}
 	}
 
@@ -192,8 +221,8 @@ public:
                 //long OffsB = ((it - 4) << 2) + (i - (FldArr.Ns - 4));
                 long long OffsB = ((it - 4) << 2) + (i - (FldArr.Ns - 4));
                 B = gRightArrB[OffsB];
-				TComplexD* tBottomArrA = gBottomArrA + (OffsB<<2);
-                for(int k=0; k<4; k++) *(tA_Stokes++) = *(tBottomArrA++);
+				TComplexD* tRightArrA = gRightArrA + (OffsB<<2);
+                for(int k=0; k<4; k++) *(tA_Stokes++) = *(tRightArrA++);
 				AB_ShouldBeComputed = false;
 			}
 		}
@@ -203,7 +232,8 @@ public:
 			double st = FldArr.sStart + it*FldArr.sStep;
 
 			//long Offset1 = it*((((FldArr.Ns) << 1) - 1 - it) >> 1) + i;
-			long long Offset1 = it*((((FldArr.Ns) << 1) - 1 - it) >> 1) + i;
+			//long long Offset1 = it*((((FldArr.Ns) << 1) - 1 - it) >> 1) + i;
+			long long Offset1 = ((it*(((FldArr.Ns) << 1) - 1 - it)) >> 1) + i; //same triangular indexing as in ComputeStokesAtOneObsPoint_Intens_PrepAandB
 			//long OffsetCoefA = Offset1*(gNumCoefForOnePointA << 2);
 			//long OffsetCoefB = Offset1*gNumCoefForOnePointB;
 			long long OffsetCoefA = Offset1*(gNumCoefForOnePointA << 2);
@@ -16,6 +16,7 @@
 
 //#include <cmath>
 #include <math.h>
+#include <string.h>
 
 //*************************************************************************
 
@@ -2088,3 +2089,122 @@ int srTTrjDat::ComputeInterpolatingStructureFromTrj(SRWLPrtTrj* pTrj)
 }
 
 //*************************************************************************
+
+//*************************************************************************
+
+srTTrjDatCacheKey::srTTrjDatCacheKey(SRWLPrtTrj* pTrj)
+{
+	arX = arXp = arY = arYp = 0;
+	np = 0; ctStart = ctEnd = 0.; Ver = 0;
+	memset(&partInitCond, 0, sizeof(SRWLParticle));
+	if(pTrj == 0) return;
+
+	arX = pTrj->arX; arXp = pTrj->arXp; arY = pTrj->arY; arYp = pTrj->arYp;
+	np = pTrj->np; ctStart = pTrj->ctStart; ctEnd = pTrj->ctEnd;
+	partInitCond = pTrj->partInitCond;
+
+	//FNV-1a-type checksum over the data from which the interpolating structure is computed (much cheaper than the computation itself)
+	unsigned long long h = 14695981039346656037ULL;
+	double *arAr[] = {arX, arXp, arY, arYp};
+	for(int j=0; j<4; j++)
+	{
+		const double *p = arAr[j];
+		if(p == 0) continue;
+		for(long long i=0; i<np; i++)
+		{
+			unsigned long long w;
+			memcpy(&w, p + i, sizeof(double));
+			h = (h ^ w)*1099511628211ULL;
+		}
+	}
+	Ver = h;
+}
+
+//*************************************************************************
+
+bool srTTrjDatCacheKey::operator==(const srTTrjDatCacheKey& k) const
+{
+	if((arX != k.arX) || (arXp != k.arXp) || (arY != k.arY) || (arYp != k.arYp)) return false;
+	if((np != k.np) || (ctStart != k.ctStart) || (ctEnd != k.ctEnd) || (Ver != k.Ver)) return false;
+	const SRWLParticle &p = partInitCond, &pk = k.partInitCond;
+	return (p.x == pk.x) && (p.y == pk.y) && (p.z == pk.z) && (p.xp == pk.xp) && (p.yp == pk.yp) && (p.gamma == pk.gamma) && (p.relE0 == pk.relE0) && (p.nq == pk.nq);
+}
+
+//*************************************************************************
+
+std::vector<srTTrjDatCache::srTEntry> srTTrjDatCache::m_vEntries;
+std::mutex srTTrjDatCache::m_mtx;
+long long srTTrjDatCache::m_UseCount = 0;
+
+//*************************************************************************
+
+CSmartPtr<srTTrjDat> srTTrjDatCache::Get(SRWLPrtTrj* pTrj, bool pin)
+{//Returns trajectory interpolating structure for pTrj, computing it if it is not in the cache yet; throws error code on failure
+	srTTrjDatCacheKey Key(pTrj);
+	{
+		std::lock_guard<std::mutex> lck(m_mtx);
+		for(std::vector<srTEntry>::iterator it = m_vEntries.begin(); it != m_vEntries.end(); ++it)
+		{
+			if(!(it->Key == Key)) continue;
+			it->LastUse = ++m_UseCount;
+			if(pin) it->nPins++;
+			return it->hTrjDat;
+		}
+	}
+
+	CSmartPtr<srTTrjDat> hTrjDat(new srTTrjDat(pTrj)); //computed outside of the lock, so that other threads are not blocked
+
+	std::lock_guard<std::mutex> lck(m_mtx);
+	for(std::vector<srTEntry>::iterator it = m_vEntries.begin(); it != m_vEntries.end(); ++it)
+	{//the same entry could be added by another thread in the meantime
+		if(!(it->Key == Key)) continue;
+		it->LastUse = ++m_UseCount;
+		if(pin) it->nPins++;
+		return it->hTrjDat;
+	}
+
+	for(;;)
+	{//evicting least recently used entries which are not pinned
+		int nUnpinned = 0;
+		std::vector<srTEntry>::iterator itOldest = m_vEntries.end();
+		for(std::vector<srTEntry>::iterator it = m_vEntries.begin(); it != m_vEntries.end(); ++it)
+		{
+			if(it->nPins > 0) continue;
+			nUnpinned++;
+			if((itOldest == m_vEntries.end()) || (it->LastUse < itOldest->LastUse)) itOldest = it;
+		}
+		if(nUnpinned < MaxNumUnpinned) break;
+		m_vEntries.erase(itOldest);
+	}
+
+	srTEntry NewEntry;
+	NewEntry.Key = Key;
+	NewEntry.hTrjDat = hTrjDat;
+	NewEntry.nPins = pin? 1 : 0;
+	NewEntry.LastUse = ++m_UseCount;
+	m_vEntries.push_back(NewEntry);
+	return hTrjDat;
+}
+
+//*************************************************************************
+
+void srTTrjDatCache::Unpin(srTTrjDat* pTrjDat)
+{//Entry is identified by its structure, so that nothing happens if it was removed by Clear (even if the same trajectory was cached again)
+	std::lock_guard<std::mutex> lck(m_mtx);
+	for(std::vector<srTEntry>::iterator it = m_vEntries.begin(); it != m_vEntries.end(); ++it)
+	{
+		if(it->hTrjDat.ptr() != pTrjDat) continue;
+		if(it->nPins > 0) it->nPins--;
+		return;
+	}
+}
+
+//*************************************************************************
+
+void srTTrjDatCache::Clear()
+{//Removes all entries, including pinned ones; structures held by handles stay alive until the handles are deleted
+	std::lock_guard<std::mutex> lck(m_mtx);
+	m_vEntries.clear();
+}
+
+//*************************************************************************
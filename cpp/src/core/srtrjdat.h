@@ -30,6 +30,10 @@
 #include "srgtrjdt.h"
 #include "srsysuti.h"
 #include "srwlib.h"
+#include "smartptr.h"
+
+#include <vector>
+#include <mutex>
 
 //*************************************************************************
 
@@ -1118,4 +1122,48 @@ inline int srTTrjDat::CheckIfFieldIsZeroFromTrj()
 
 //*************************************************************************
 
+struct srTTrjDatCacheKey {
+	double *arX, *arXp, *arY, *arYp; //identity of trajectory arrays
+	long long np;
+	double ctStart, ctEnd;
+	SRWLParticle partInitCond;
+	unsigned long long Ver; //checksum of trajectory data, playing role of its version
+
+	srTTrjDatCacheKey(SRWLPrtTrj* pTrj =0);
+	bool operator==(const srTTrjDatCacheKey& k) const;
+};
+
+//*************************************************************************
+
+class srTTrjDatCache {
+//Bounded process-wide cache of trajectory interpolating structures computed from SRWLPrtTrj;
+//entries pinned by prepared-trajectory handles (SRWLPrtTrjPrep) are not evicted (only Clear removes them)
+
+	struct srTEntry {
+		srTTrjDatCacheKey Key;
+		CSmartPtr<srTTrjDat> hTrjDat;
+		int nPins;
+		long long LastUse;
+	};
+	static std::vector<srTEntry> m_vEntries;
+	static std::mutex m_mtx;
+	static long long m_UseCount;
+
+public:
+
+	static const int MaxNumUnpinned = 4; //max. number of entries not pinned by any handle
+
+	static CSmartPtr<srTTrjDat> Get(SRWLPrtTrj* pTrj, bool pin =false);
+	static void Unpin(srTTrjDat* pTrjDat);
+	static void Clear();
+};
+
+//*************************************************************************
+
+struct SRWLStructPrtTrjPrep { //prepared trajectory (opaque in C API)
+	CSmartPtr<srTTrjDat> hTrjDat;
+};
+
+//*************************************************************************
+
 #endif
@@ -2,16 +2,18 @@
 #ifndef __OBJHNDL_H
 #define __OBJHNDL_H
 
+#include <atomic>
+
 //*************************************************************************
 
 template<class T> class CHandle {
 public:
 
 	T* rep;
-	int* pcount;
+	std::atomic<int>* pcount; //atomic, to allow copies of same handle to be created / destroyed in different threads
 
 	CHandle() { rep=0; pcount=0;}
-	CHandle(T* pp) : rep(pp), pcount(new int) { /* (*pcount)=0; */ (*pcount)=1;}
+	CHandle(T* pp) : rep(pp), pcount(new std::atomic<int>(1)) {}
 	CHandle(const CHandle& r) : rep(r.rep), pcount(r.pcount) 
 	{ 
 		if(pcount != 0) (*pcount)++;
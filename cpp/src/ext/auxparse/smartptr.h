@@ -14,16 +14,18 @@
 #ifndef __SMARTPTR_H
 #define __SMARTPTR_H
 
+#include <atomic>
+
 //-------------------------------------------------------------------------
 
 template<class T> class CSmartPtr {
 public:
 	T* rep;
-	int* pcount;
+	std::atomic<int>* pcount; //atomic, to allow copies of same pointer to be created / destroyed in different threads
 	bool dontDelPtr; //OC13112010
 
 	CSmartPtr () { rep=0; pcount=0; dontDelPtr=false;}
-	CSmartPtr (T* pp, bool dontDel =false) : rep(pp), pcount(new int) { (*pcount)=1; dontDelPtr=dontDel;}
+	CSmartPtr (T* pp, bool dontDel =false) : rep(pp), pcount(new std::atomic<int>(1)) { dontDelPtr=dontDel;}
 	CSmartPtr (const CSmartPtr& r) : rep(r.rep), pcount(r.pcount), dontDelPtr(r.dontDelPtr)
 	{ 
 		if(pcount != 0) (*pcount)++;
@@ -13,6 +13,8 @@
  ***************************************************************************/
 
 #include "gmfft.h"
+#include "srwlprof.h"
+#include <vector>
 
 //#include "srwlib.h" //Added by S.Yakubov (for profiling?) at parallelizing SRW via OpenMP
 
@@ -23,6 +25,8 @@
 
 //*************************************************************************
 
+std::mutex CGenMathFFT::m_mtxPlan;
+
 long CGenMathFFT::GoodNumbers[] = {
 	2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30, 32, 36, 40, 42, 44, 
 	48, 50, 52, 54, 56, 60, 64, 66, 70, 72, 78, 80, 84, 88, 90, 96, 98, 100, 104, 
@@ -299,6 +303,8 @@ int CGenMathFFT2D::Make2DFFT(CGenMathFFT2DInfo& FFT2DInfo, fftwf_plan* pPrecreat
 int CGenMathFFT2D::Make2DFFT(CGenMathFFT2DInfo& FFT2DInfo, fftwnd_plan* pPrecreatedPlan2DFFT) //OC27102018
 #endif
 {// Assumes Nx, Ny even !
+	CSRWLProfScope profScope(srwlProfFFT2D, ((long long)FFT2DInfo.Nx)*((long long)FFT2DInfo.Ny)*((FFT2DInfo.howMany > 1)? FFT2DInfo.howMany : 1)*((FFT2DInfo.pData != 0)? 2*sizeof(float) : 2*sizeof(double)));
+
 	const double RelShiftTol = 1.E-06;
 
 		//debug
@@ -576,7 +582,7 @@ int CGenMathFFT2D::Make2DFFT(CGenMathFFT2DInfo& FFT2DInfo, fftwnd_plan* pPrecrea
 				long iFFT = Nx * Ny * iHowMany;
 				if(DataToFFT != 0)
 				{
-					if(pPrecreatedPlan2DFFT == 0) Plan2DFFT = fftwf_plan_dft_2d(Ny, Nx, DataToFFT + iFFT, DataToFFT + iFFT, FFTW_FORWARD, FFTW_ESTIMATE);
+					if(pPrecreatedPlan2DFFT == 0) { std::lock_guard<std::mutex> lck(m_mtxPlan); Plan2DFFT = fftwf_plan_dft_2d(Ny, Nx, DataToFFT + iFFT, DataToFFT + iFFT, FFTW_FORWARD, FFTW_ESTIMATE);}
 					else Plan2DFFT = *pPrecreatedPlan2DFFT;
 					if(Plan2DFFT == 0) return ERROR_IN_FFT;
 
@@ -584,7 +590,7 @@ int CGenMathFFT2D::Make2DFFT(CGenMathFFT2DInfo& FFT2DInfo, fftwnd_plan* pPrecrea
 				}
 				else if(dDataToFFT != 0)
 				{
-					if(pdPrecreatedPlan2DFFT == 0) dPlan2DFFT = fftw_plan_dft_2d(Ny, Nx, dDataToFFT + iFFT, dDataToFFT + iFFT, FFTW_FORWARD, FFTW_ESTIMATE);
+					if(pdPrecreatedPlan2DFFT == 0) { std::lock_guard<std::mutex> lck(m_mtxPlan); dPlan2DFFT = fftw_plan_dft_2d(Ny, Nx, dDataToFFT + iFFT, dDataToFFT + iFFT, FFTW_FORWARD, FFTW_ESTIMATE);}
 					else dPlan2DFFT = *pdPrecreatedPlan2DFFT;
 					if(dPlan2DFFT == 0) return ERROR_IN_FFT;
 
@@ -593,7 +599,7 @@ int CGenMathFFT2D::Make2DFFT(CGenMathFFT2DInfo& FFT2DInfo, fftwnd_plan* pPrecrea
 			}
 
 #else
-			if(pPrecreatedPlan2DFFT == 0) Plan2DFFT = fftw2d_create_plan(Ny, Nx, FFTW_FORWARD, FFTW_IN_PLACE);
+			if(pPrecreatedPlan2DFFT == 0) { std::lock_guard<std::mutex> lck(m_mtxPlan); Plan2DFFT = fftw2d_create_plan(Ny, Nx, FFTW_FORWARD, FFTW_IN_PLACE);}
 			else Plan2DFFT = *pPrecreatedPlan2DFFT;
 			if(Plan2DFFT == 0) return ERROR_IN_FFT;
 			fftwnd(Plan2DFFT, 1, DataToFFT, 1, 0, DataToFFT, 1, 0);
@@ -721,7 +727,7 @@ int CGenMathFFT2D::Make2DFFT(CGenMathFFT2DInfo& FFT2DInfo, fftwnd_plan* pPrecrea
 				long iFFT = Nx * Ny * iHowMany;
 				if(DataToFFT != 0)
 				{
-					if(pPrecreatedPlan2DFFT == 0) Plan2DFFT = fftwf_plan_dft_2d(Ny, Nx, DataToFFT + iFFT, DataToFFT + iFFT, FFTW_BACKWARD, FFTW_ESTIMATE);
+					if(pPrecreatedPlan2DFFT == 0) { std::lock_guard<std::mutex> lck(m_mtxPlan); Plan2DFFT = fftwf_plan_dft_2d(Ny, Nx, DataToFFT + iFFT, DataToFFT + iFFT, FFTW_BACKWARD, FFTW_ESTIMATE);}
 					else Plan2DFFT = *pPrecreatedPlan2DFFT;
 					if(Plan2DFFT == 0) return ERROR_IN_FFT;
 					RotateDataAfter2DFFT(DataToFFT);
@@ -730,7 +736,7 @@ int CGenMathFFT2D::Make2DFFT(CGenMathFFT2DInfo& FFT2DInfo, fftwnd_plan* pPrecrea
 				}
 				else if(dDataToFFT != 0)
 				{
-					if(pdPrecreatedPlan2DFFT == 0) dPlan2DFFT = fftw_plan_dft_2d(Ny, Nx, dDataToFFT + iFFT, dDataToFFT + iFFT, FFTW_BACKWARD, FFTW_ESTIMATE);
+					if(pdPrecreatedPlan2DFFT == 0) { std::lock_guard<std::mutex> lck(m_mtxPlan); dPlan2DFFT = fftw_plan_dft_2d(Ny, Nx, dDataToFFT + iFFT, dDataToFFT + iFFT, FFTW_BACKWARD, FFTW_ESTIMATE);}
 					else dPlan2DFFT = *pdPrecreatedPlan2DFFT;
 					if(dPlan2DFFT == 0) return ERROR_IN_FFT;
 					RotateDataAfter2DFFT(dDataToFFT);
@@ -739,7 +745,7 @@ int CGenMathFFT2D::Make2DFFT(CGenMathFFT2DInfo& FFT2DInfo, fftwnd_plan* pPrecrea
 				}
 			}
 #else
-			if(pPrecreatedPlan2DFFT == 0) Plan2DFFT = fftw2d_create_plan(Ny, Nx, FFTW_BACKWARD, FFTW_IN_PLACE);
+			if(pPrecreatedPlan2DFFT == 0) { std::lock_guard<std::mutex> lck(m_mtxPlan); Plan2DFFT = fftw2d_create_plan(Ny, Nx, FFTW_BACKWARD, FFTW_IN_PLACE);}
 			else Plan2DFFT = *pPrecreatedPlan2DFFT;
 			if(Plan2DFFT == 0) return ERROR_IN_FFT;
 			RotateDataAfter2DFFT(DataToFFT);
@@ -871,14 +877,14 @@ int CGenMathFFT2D::Make2DFFT(CGenMathFFT2DInfo& FFT2DInfo, fftwnd_plan* pPrecrea
 #if _FFTW3 //OC28012019
 		if(DataToFFT != 0)
 		{
-			if(pPrecreatedPlan2DFFT == 0) fftwf_destroy_plan(Plan2DFFT);
+			if(pPrecreatedPlan2DFFT == 0) { std::lock_guard<std::mutex> lck(m_mtxPlan); fftwf_destroy_plan(Plan2DFFT);}
 		}
 		else if(dDataToFFT != 0) //OC03022019
 		{
-			if(pdPrecreatedPlan2DFFT == 0) fftw_destroy_plan(dPlan2DFFT);
+			if(pdPrecreatedPlan2DFFT == 0) { std::lock_guard<std::mutex> lck(m_mtxPlan); fftw_destroy_plan(dPlan2DFFT);}
 		}
 #else
-		if(pPrecreatedPlan2DFFT == 0) fftwnd_destroy_plan(Plan2DFFT);
+		if(pPrecreatedPlan2DFFT == 0) { std::lock_guard<std::mutex> lck(m_mtxPlan); fftwnd_destroy_plan(Plan2DFFT);}
 #endif
 	}
 
@@ -899,6 +905,8 @@ int CGenMathFFT2D::Make2DFFT(CGenMathFFT2DInfo& FFT2DInfo, fftwnd_plan* pPrecrea
 //int CGenMathFFT1D::Make1DFFT(CGenMathFFT1DInfo& FFT1DInfo, gpuUsageArg *pGpuUsage) //HG20012022
 int CGenMathFFT1D::Make1DFFT(CGenMathFFT1DInfo& FFT1DInfo, void* pvGPU) //OC05092023
 {// Assumes Nx, Ny even !
+	CSRWLProfScope profScope(srwlProfFFT1D, ((long long)FFT1DInfo.Nx)*((long long)FFT1DInfo.HowMany)*((FFT1DInfo.pInData != 0)? 2*sizeof(float) : 2*sizeof(double))*(((FFT1DInfo.pInData2 != 0) || (FFT1DInfo.pdInData2 != 0))? 2 : 1));
+
 	//Added by S.Yakubov (for profiling?) at parallelizing SRW via OpenMP:
 	//double start;
 	//get_walltime (&start);
@@ -925,10 +933,55 @@ int CGenMathFFT1D::Make1DFFT(CGenMathFFT1DInfo& FFT1DInfo, void* pvGPU) //OC0509
 #ifdef _OFFLOAD_GPU //OC19022024
 	TGPUUsageArg parGPU(pvGPU);
 	TGPUUsageArg *pGPU = &parGPU;
+
+	if(CAuxGPU::GPUEnabled(pGPU) && ((FFT1DInfo.pInData2 != 0) || (FFT1DInfo.pdInData2 != 0)))
+	{//on GPU, the second data set is transformed by a separate call
+		CGenMathFFT1DInfo FFT1DInfo1 = FFT1DInfo, FFT1DInfo2 = FFT1DInfo;
+		FFT1DInfo2.pInData = FFT1DInfo.pInData2; FFT1DInfo2.pOutData = FFT1DInfo.pOutData2;
+		FFT1DInfo2.pdInData = FFT1DInfo.pdInData2; FFT1DInfo2.pdOutData = FFT1DInfo.pdOutData2;
+		FFT1DInfo1.pInData2 = FFT1DInfo1.pOutData2 = FFT1DInfo2.pInData2 = FFT1DInfo2.pOutData2 = 0;
+		FFT1DInfo1.pdInData2 = FFT1DInfo1.pdOutData2 = FFT1DInfo2.pdInData2 = FFT1DInfo2.pdOutData2 = 0;
+		int result = 0;
+		if(result = Make1DFFT(FFT1DInfo1, pvGPU)) return result;
+		if(result = Make1DFFT(FFT1DInfo2, pvGPU)) return result;
+		FFT1DInfo.xStepTr = FFT1DInfo1.xStepTr; FFT1DInfo.xStartTr = FFT1DInfo1.xStartTr;
+		return 0;
+	}
 #endif
 
+	//Second data set has to be transformed in place or out of place, as the first one (checked before any allocation)
+	if((FFT1DInfo.pInData2 != 0) && (FFT1DInfo.pOutData2 != 0) && ((FFT1DInfo.pInData2 == FFT1DInfo.pOutData2) != (FFT1DInfo.pInData == FFT1DInfo.pOutData))) return ERROR_IN_FFT;
+	if((FFT1DInfo.pdInData2 != 0) && (FFT1DInfo.pdOutData2 != 0) && ((FFT1DInfo.pdInData2 == FFT1DInfo.pdOutData2) != (FFT1DInfo.pdInData == FFT1DInfo.pdOutData))) return ERROR_IN_FFT;
+
 	m_ArrayShiftX = 0;
 	m_dArrayShiftX = 0;
+	struct CArrayShiftXDel { //releases auxiliary shift arrays at any return
+		CGenMathFFT1D& FFT;
+#ifdef _OFFLOAD_GPU
+		TGPUUsageArg *pGPU;
+#endif
+		~CArrayShiftXDel()
+		{
+			if(FFT.m_ArrayShiftX != 0)
+			{
+#ifdef _OFFLOAD_GPU //OC06092023 (to avoid #include "auxgpu.h" for CPU)
+				FFT.m_ArrayShiftX = (float*)CAuxGPU::ToHostAndFree(pGPU, FFT.m_ArrayShiftX, (FFT.Nx << 1) * sizeof(float), true); //OC19022024
+#endif
+				delete[] FFT.m_ArrayShiftX; FFT.m_ArrayShiftX = 0;
+			}
+			if(FFT.m_dArrayShiftX != 0)
+			{
+#ifdef _OFFLOAD_GPU //OC06092023 (to avoid #include "auxgpu.h" for CPU)
+				FFT.m_dArrayShiftX = (double*)CAuxGPU::ToHostAndFree(pGPU, FFT.m_dArrayShiftX, (FFT.Nx << 1) * sizeof(double), true); //OC19022024
+#endif
+				delete[] FFT.m_dArrayShiftX; FFT.m_dArrayShiftX = 0;
+			}
+		}
+#ifdef _OFFLOAD_GPU
+	} ArrayShiftXDel = { *this, pGPU };
+#else
+	} ArrayShiftXDel = { *this };
+#endif
 	if(NeedsShiftBeforeX || NeedsShiftAfterX)
 	{
 		if(FFT1DInfo.pInData != 0)
@@ -961,13 +1014,26 @@ int CGenMathFFT1D::Make1DFFT(CGenMathFFT1DInfo& FFT1DInfo, void* pvGPU) //OC0509
 
 	fftw_plan dPlan1DFFT;
 	fftw_complex* dDataToFFT = 0, * dOutDataFFT = 0; //, *pdOutDataFFT=0;
+
+	fftwf_complex *DataToFFT2 = 0, *OutDataFFT2 = 0; //second data set (processed on CPU only)
+	fftw_complex *dDataToFFT2 = 0, *dOutDataFFT2 = 0;
 #else //OC12032024
 	fftw_plan Plan1DFFT; //OC12032024 (moved to this scope)
 	FFTW_COMPLEX* DataToFFT = 0;
 	FFTW_COMPLEX* OutDataFFT = 0;
 	FFTW_COMPLEX* pOutDataFFT = 0;
+
+	FFTW_COMPLEX *DataToFFT2 = 0, *OutDataFFT2 = 0; //second data set
 #endif
 
+	//Data rotation, sign repair, normalization and shifts are done on CPU in one pass per vector (see ApplyCoefsPerVector);
+	//the corresponding auxiliary complex multipliers:
+	std::vector<float> vCoef; //released at any return
+	std::vector<double> vCoefD;
+	float *arCoef = 0;
+	double *arCoefD = 0;
+	bool useCPU = true;
+
 //HG20012022
 //#ifdef _DEBUG
 //	if (pGpuUsage != NULL)
@@ -979,6 +1045,7 @@ int CGenMathFFT1D::Make1DFFT(CGenMathFFT1DInfo& FFT1DInfo, void* pvGPU) //OC0509
 	//GPU_COND(pvGPU, //OC06092023
 	//GPU_COND(pGpuUsage, //HG20012022
 	{
+		useCPU = false;
 		if((FFT1DInfo.pInData != 0) && (FFT1DInfo.pOutData != 0))
 		{
 			DataToFFT = (fftwf_complex*)CAuxGPU::ToDevice(pGPU, FFT1DInfo.pInData, FFT1DInfo.Nx * FFT1DInfo.HowMany * 2 * sizeof(float)); //OC19022024
@@ -1007,12 +1074,26 @@ int CGenMathFFT1D::Make1DFFT(CGenMathFFT1DInfo& FFT1DInfo, void* pvGPU) //OC0509
 		DataToFFT = (fftwf_complex*)(FFT1DInfo.pInData);
 		OutDataFFT = (fftwf_complex*)(FFT1DInfo.pOutData);
 		//pOutDataFFT = OutDataFFT; //OC03092016 to be used solely in fftw call
+
+		if((FFT1DInfo.pInData2 != 0) && (FFT1DInfo.pOutData2 != 0))
+		{
+			DataToFFT2 = (fftwf_complex*)(FFT1DInfo.pInData2);
+			OutDataFFT2 = (fftwf_complex*)(FFT1DInfo.pOutData2);
+		}
+		vCoef.resize(Nx << 1); arCoef = &(vCoef[0]);
 	}
 	else if((FFT1DInfo.pdInData != 0) && (FFT1DInfo.pdOutData != 0))
 	{
 		dDataToFFT = (fftw_complex*)(FFT1DInfo.pdInData);
 		dOutDataFFT = (fftw_complex*)(FFT1DInfo.pdOutData);
 		//pdOutDataFFT = dOutDataFFT;
+
+		if((FFT1DInfo.pdInData2 != 0) && (FFT1DInfo.pdOutData2 != 0))
+		{
+			dDataToFFT2 = (fftw_complex*)(FFT1DInfo.pdInData2);
+			dOutDataFFT2 = (fftw_complex*)(FFT1DInfo.pdOutData2);
+		}
+		vCoefD.resize(Nx << 1); arCoefD = &(vCoefD[0]);
 	}
 #else
 	//fftw_plan Plan1DFFT; //OC12032024 (commented-out)
@@ -1022,6 +1103,13 @@ int CGenMathFFT1D::Make1DFFT(CGenMathFFT1DInfo& FFT1DInfo, void* pvGPU) //OC0509
 	//FFTW_COMPLEX* OutDataFFT = (FFTW_COMPLEX*)(FFT1DInfo.pOutData);
 	pOutDataFFT = OutDataFFT; //OC03092016 to be used solely in fftw call
 	//FFTW_COMPLEX* pOutDataFFT = OutDataFFT; //OC03092016 to be used solely in fftw call
+
+	if((FFT1DInfo.pInData2 != 0) && (FFT1DInfo.pOutData2 != 0))
+	{
+		DataToFFT2 = (FFTW_COMPLEX*)(FFT1DInfo.pInData2);
+		OutDataFFT2 = (FFTW_COMPLEX*)(FFT1DInfo.pOutData2);
+	}
+	vCoef.resize(Nx << 1); arCoef = &(vCoef[0]);
 	/**
 		Pointed-out by Sergey Yakubov (E-XFEL).
 		From FFTW 2.1.5 docs:
@@ -1068,13 +1156,28 @@ int CGenMathFFT1D::Make1DFFT(CGenMathFFT1DInfo& FFT1DInfo, void* pvGPU) //OC0509
 			//FillArrayShift(t0SignMult*x0_Before, FFT1DInfo.xStep);
 			if(m_ArrayShiftX != 0) FillArrayShift(t0SignMult * x0_Before, FFT1DInfo.xStep, m_ArrayShiftX);
 			else if(m_dArrayShiftX != 0) FillArrayShift(t0SignMult * x0_Before, FFT1DInfo.xStep, m_dArrayShiftX);
+			//the shift is applied below, together with rotation and sign repair (if any)
+		}
+	}
 
-			if(DataToFFT != 0) TreatShift(DataToFFT, FFT1DInfo.HowMany);
-
-#ifdef _FFTW3 //OC27022019
-			else if(dDataToFFT != 0) TreatShift(dDataToFFT, FFT1DInfo.HowMany);
-#endif
+	//On CPU: shift before FFT, as well as rotation and sign repair before backward FFT, in one pass per vector
+	char rotModeBefore = (FFT1DInfo.Dir > 0)? 0 : -1;
+	if(useCPU && (NeedsShiftBeforeX || (rotModeBefore != 0)))
+	{
+		if(arCoef != 0)
+		{
+			SetupCoefsFor1DFFT(arCoef, NeedsShiftBeforeX? m_ArrayShiftX : (float*)0, 1., rotModeBefore);
+			ApplyCoefsPerVector(FFT1DInfo.pInData, FFT1DInfo.HowMany, arCoef, (rotModeBefore != 0));
+			if(DataToFFT2 != 0) ApplyCoefsPerVector(FFT1DInfo.pInData2, FFT1DInfo.HowMany, arCoef, (rotModeBefore != 0));
+		}
+#ifdef _FFTW3
+		else if(arCoefD != 0)
+		{
+			SetupCoefsFor1DFFT(arCoefD, NeedsShiftBeforeX? m_dArrayShiftX : (double*)0, 1., rotModeBefore);
+			ApplyCoefsPerVector(FFT1DInfo.pdInData, FFT1DInfo.HowMany, arCoefD, (rotModeBefore != 0));
+			if(dDataToFFT2 != 0) ApplyCoefsPerVector(FFT1DInfo.pdInData2, FFT1DInfo.HowMany, arCoefD, (rotModeBefore != 0));
 		}
+#endif
 	}
 
 	//Added by S.Yakubov (for profiling?) at parallelizing SRW via OpenMP:
@@ -1148,15 +1251,25 @@ int CGenMathFFT1D::Make1DFFT(CGenMathFFT1DInfo& FFT1DInfo, void* pvGPU) //OC0509
 			if(DataToFFT != 0)
 			{
 				//Plan1DFFT = fftwf_plan_many_dft(1, arN, FFT1DInfo.HowMany, DataToFFT, NULL, 1, Nx, pOutDataFFT, NULL, 1, Nx, FFTW_FORWARD, flags); 
-				Plan1DFFT = fftwf_plan_many_dft(1, arN, FFT1DInfo.HowMany, DataToFFT, NULL, 1, Nx, OutDataFFT, NULL, 1, Nx, FFTW_FORWARD, flags); //OC02022019
+				{ std::lock_guard<std::mutex> lck(m_mtxPlan); Plan1DFFT = fftwf_plan_many_dft(1, arN, FFT1DInfo.HowMany, DataToFFT, NULL, 1, Nx, OutDataFFT, NULL, 1, Nx, FFTW_FORWARD, flags);} //OC02022019
 				if(Plan1DFFT == 0) return ERROR_IN_FFT;
 				fftwf_execute(Plan1DFFT);
+				if(DataToFFT2 != 0)
+				{
+					int res = Execute1DFFTPlanOnOtherData(Plan1DFFT, DataToFFT, OutDataFFT, DataToFFT2, OutDataFFT2, FFT1DInfo.HowMany, FFTW_FORWARD, flags);
+					if(res) { std::lock_guard<std::mutex> lck(m_mtxPlan); fftwf_destroy_plan(Plan1DFFT); return res;}
+				}
 			}
 			else if(dDataToFFT != 0) //OC02022019
 			{
-				dPlan1DFFT = fftw_plan_many_dft(1, arN, FFT1DInfo.HowMany, dDataToFFT, NULL, 1, Nx, dOutDataFFT, NULL, 1, Nx, FFTW_FORWARD, flags);
+				{ std::lock_guard<std::mutex> lck(m_mtxPlan); dPlan1DFFT = fftw_plan_many_dft(1, arN, FFT1DInfo.HowMany, dDataToFFT, NULL, 1, Nx, dOutDataFFT, NULL, 1, Nx, FFTW_FORWARD, flags);}
 				if(dPlan1DFFT == 0) return ERROR_IN_FFT;
 				fftw_execute(dPlan1DFFT);
+				if(dDataToFFT2 != 0)
+				{
+					int res = Execute1DFFTPlanOnOtherData(dPlan1DFFT, dDataToFFT, dOutDataFFT, dDataToFFT2, dOutDataFFT2, FFT1DInfo.HowMany, FFTW_FORWARD, flags);
+					if(res) { std::lock_guard<std::mutex> lck(m_mtxPlan); fftw_destroy_plan(dPlan1DFFT); return res;}
+				}
 			}
 
 #else //ifndef _FFTW3
@@ -1165,7 +1278,7 @@ int CGenMathFFT1D::Make1DFFT(CGenMathFFT1DInfo& FFT1DInfo, void* pvGPU) //OC0509
 				flags |= FFTW_IN_PLACE;
 				pOutDataFFT = 0; //OC03092016 (see FFTW 2.1.5 doc clause above)
 			}
-			Plan1DFFT = fftw_create_plan(Nx, FFTW_FORWARD, flags);
+			{ std::lock_guard<std::mutex> lck(m_mtxPlan); Plan1DFFT = fftw_create_plan(Nx, FFTW_FORWARD, flags);}
 			if(Plan1DFFT == 0) return ERROR_IN_FFT;
 
 			//Added by S.Yakubov (for profiling?) at parallelizing SRW via OpenMP:
@@ -1174,14 +1287,19 @@ int CGenMathFFT1D::Make1DFFT(CGenMathFFT1DInfo& FFT1DInfo, void* pvGPU) //OC0509
 #ifndef _WITH_OMP //OC27102018
 		//fftw(Plan1DFFT, FFT1DInfo.HowMany, DataToFFT, 1, Nx, OutDataFFT, 1, Nx);
 			fftw(Plan1DFFT, FFT1DInfo.HowMany, DataToFFT, 1, Nx, pOutDataFFT, 1, Nx); //OC03092016
+			if(DataToFFT2 != 0) fftw(Plan1DFFT, FFT1DInfo.HowMany, DataToFFT2, 1, Nx, (pOutDataFFT != 0)? OutDataFFT2 : 0, 1, Nx); //second data set is in-place if the first one is
 #else //OC27102018
 		//SY: split one call into many (for OpenMP)
+			int nTot = (DataToFFT2 != 0)? (int)(FFT1DInfo.HowMany << 1) : (int)FFT1DInfo.HowMany;
 #pragma omp parallel for if (omp_get_num_threads()==1) // to avoid nested multi-threading (just in case)
-			for(int i = 0; i < FFT1DInfo.HowMany; i++)
+			for(int i = 0; i < nTot; i++)
 			{
+				FFTW_COMPLEX *pIn = DataToFFT, *pOut = OutDataFFT;
+				long long ii = i;
+				if(i >= FFT1DInfo.HowMany) { pIn = DataToFFT2; pOut = OutDataFFT2; ii -= FFT1DInfo.HowMany;}
 				//SY: do not use OutDataFFT as scratch space if in-place
-				if(DataToFFT == OutDataFFT) fftw_one(Plan1DFFT, DataToFFT + i * Nx, 0);
-				else fftw_one(Plan1DFFT, DataToFFT + i * Nx, OutDataFFT + i * Nx);
+				if(pIn == pOut) fftw_one(Plan1DFFT, pIn + ii * Nx, 0);
+				else fftw_one(Plan1DFFT, pIn + ii * Nx, pOut + ii * Nx);
 			}
 #endif
 #endif
@@ -1212,19 +1330,7 @@ int CGenMathFFT1D::Make1DFFT(CGenMathFFT1DInfo& FFT1DInfo, void* pvGPU) //OC0509
 		}//)
 		else 
 #endif
-		{
-			if(OutDataFFT != 0)
-			{
-				RepairSignAfter1DFFT(OutDataFFT, FFT1DInfo.HowMany);
-				RotateDataAfter1DFFT(OutDataFFT, FFT1DInfo.HowMany);
-			}
-#ifdef _FFTW3 //OC27022019
-			else if(dOutDataFFT != 0)
-			{
-				RepairSignAfter1DFFT(dOutDataFFT, FFT1DInfo.HowMany);
-				RotateDataAfter1DFFT(dOutDataFFT, FFT1DInfo.HowMany);
-			}
-#endif
+		{//On CPU, sign repair and rotation are done below, together with normalization and shift (if any)
 		}
 	}
 	else
@@ -1302,20 +1408,26 @@ int CGenMathFFT1D::Make1DFFT(CGenMathFFT1DInfo& FFT1DInfo, void* pvGPU) //OC0509
 			if(DataToFFT != 0)
 			{
 				//Plan1DFFT = fftwf_plan_many_dft(1, arN, FFT1DInfo.HowMany, DataToFFT, NULL, 1, Nx, pOutDataFFT, NULL, 1, Nx, FFTW_BACKWARD, flags); 
-				Plan1DFFT = fftwf_plan_many_dft(1, arN, FFT1DInfo.HowMany, DataToFFT, NULL, 1, Nx, OutDataFFT, NULL, 1, Nx, FFTW_BACKWARD, flags); //OC02022019
+				{ std::lock_guard<std::mutex> lck(m_mtxPlan); Plan1DFFT = fftwf_plan_many_dft(1, arN, FFT1DInfo.HowMany, DataToFFT, NULL, 1, Nx, OutDataFFT, NULL, 1, Nx, FFTW_BACKWARD, flags);} //OC02022019
 				if(Plan1DFFT == 0) return ERROR_IN_FFT;
-				RotateDataAfter1DFFT(DataToFFT, FFT1DInfo.HowMany);
-				RepairSignAfter1DFFT(DataToFFT, FFT1DInfo.HowMany);
-
+				//(rotation and sign repair were done above, together with shift)
 				fftwf_execute(Plan1DFFT);
+				if(DataToFFT2 != 0)
+				{
+					int res = Execute1DFFTPlanOnOtherData(Plan1DFFT, DataToFFT, OutDataFFT, DataToFFT2, OutDataFFT2, FFT1DInfo.HowMany, FFTW_BACKWARD, flags);
+					if(res) { std::lock_guard<std::mutex> lck(m_mtxPlan); fftwf_destroy_plan(Plan1DFFT); return res;}
+				}
 			}
 			else if(dDataToFFT != 0) //OC02022019
 			{
-				dPlan1DFFT = fftw_plan_many_dft(1, arN, FFT1DInfo.HowMany, dDataToFFT, NULL, 1, Nx, dOutDataFFT, NULL, 1, Nx, FFTW_BACKWARD, flags);
+				{ std::lock_guard<std::mutex> lck(m_mtxPlan); dPlan1DFFT = fftw_plan_many_dft(1, arN, FFT1DInfo.HowMany, dDataToFFT, NULL, 1, Nx, dOutDataFFT, NULL, 1, Nx, FFTW_BACKWARD, flags);}
 				if(dPlan1DFFT == 0) return ERROR_IN_FFT;
-				RotateDataAfter1DFFT(dDataToFFT, FFT1DInfo.HowMany);
-				RepairSignAfter1DFFT(dDataToFFT, FFT1DInfo.HowMany);
 				fftw_execute(dPlan1DFFT);
+				if(dDataToFFT2 != 0)
+				{
+					int res = Execute1DFFTPlanOnOtherData(dPlan1DFFT, dDataToFFT, dOutDataFFT, dDataToFFT2, dOutDataFFT2, FFT1DInfo.HowMany, FFTW_BACKWARD, flags);
+					if(res) { std::lock_guard<std::mutex> lck(m_mtxPlan); fftw_destroy_plan(dPlan1DFFT); return res;}
+				}
 			}
 #else //ifndef _FFTW3
 			if(DataToFFT == OutDataFFT)
@@ -1323,28 +1435,29 @@ int CGenMathFFT1D::Make1DFFT(CGenMathFFT1DInfo& FFT1DInfo, void* pvGPU) //OC0509
 				flags |= FFTW_IN_PLACE;
 				pOutDataFFT = 0; //OC03092016 (see FFTW 2.1.5 doc clause above)
 			}
-			Plan1DFFT = fftw_create_plan(Nx, FFTW_BACKWARD, flags);
+			{ std::lock_guard<std::mutex> lck(m_mtxPlan); Plan1DFFT = fftw_create_plan(Nx, FFTW_BACKWARD, flags);}
 			if(Plan1DFFT == 0) return ERROR_IN_FFT;
 
 			//Added by S.Yakubov (for profiling?) at parallelizing SRW via OpenMP:
 			//srwlPrintTime("::Make1DFFT : fft create plan dir<0",&start);
 
-			RotateDataAfter1DFFT(DataToFFT, FFT1DInfo.HowMany);
-			//srwlPrintTime("::Make1DFFT : rotate dir<0",&start);
-
-			RepairSignAfter1DFFT(DataToFFT, FFT1DInfo.HowMany);
-			//srwlPrintTime("::Make1DFFT : repair dir<0",&start);
+			//(rotation and sign repair were done above, together with shift)
 
 #ifndef _WITH_OMP //OC27102018
 		//fftw(Plan1DFFT, FFT1DInfo.HowMany, DataToFFT, 1, Nx, OutDataFFT, 1, Nx);
 			fftw(Plan1DFFT, FFT1DInfo.HowMany, DataToFFT, 1, Nx, pOutDataFFT, 1, Nx); //OC03092016
+			if(DataToFFT2 != 0) fftw(Plan1DFFT, FFT1DInfo.HowMany, DataToFFT2, 1, Nx, (pOutDataFFT != 0)? OutDataFFT2 : 0, 1, Nx); //second data set is in-place if the first one is
 #else //OC27102018
 		//SY: split one call into many (for OpenMP)
+			int nTot = (DataToFFT2 != 0)? (int)(FFT1DInfo.HowMany << 1) : (int)FFT1DInfo.HowMany;
 #pragma omp parallel for if(omp_get_num_threads()==1) // to avoid nested multi-threading (just in case)
-			for(int i = 0; i < FFT1DInfo.HowMany; i++)
+			for(int i = 0; i < nTot; i++)
 			{
-				if(DataToFFT == OutDataFFT) fftw_one(Plan1DFFT, DataToFFT + i * Nx, 0);
-				else fftw_one(Plan1DFFT, DataToFFT + i * Nx, OutDataFFT + i * Nx);
+				FFTW_COMPLEX *pIn = DataToFFT, *pOut = OutDataFFT;
+				long long ii = i;
+				if(i >= FFT1DInfo.HowMany) { pIn = DataToFFT2; pOut = OutDataFFT2; ii -= FFT1DInfo.HowMany;}
+				if(pIn == pOut) fftw_one(Plan1DFFT, pIn + ii * Nx, 0);
+				else fftw_one(Plan1DFFT, pIn + ii * Nx, pOut + ii * Nx);
 			}
 #endif
 #endif //_FFTW3
@@ -1369,10 +1482,27 @@ int CGenMathFFT1D::Make1DFFT(CGenMathFFT1DInfo& FFT1DInfo, void* pvGPU) //OC0509
 		}//)
 		else 
 #endif
-		{
-			if(OutDataFFT != 0) NormalizeDataAfter1DFFT(OutDataFFT, FFT1DInfo.HowMany, Mult);
-#ifdef _FFTW3 //OC27022019
-			else if(dOutDataFFT != 0) NormalizeDataAfter1DFFT(dOutDataFFT, FFT1DInfo.HowMany, Mult);
+		{//On CPU: sign repair and rotation (after forward FFT), normalization and shift after FFT, in one pass per vector
+			if(NeedsShiftAfterX)
+			{
+				if(m_ArrayShiftX != 0) FillArrayShift(t0SignMult * x0_After, FFT1DInfo.xStepTr, m_ArrayShiftX);
+				else if(m_dArrayShiftX != 0) FillArrayShift(t0SignMult * x0_After, FFT1DInfo.xStepTr, m_dArrayShiftX);
+			}
+
+			char rotModeAfter = (FFT1DInfo.Dir > 0)? 1 : 0;
+			if(arCoef != 0)
+			{
+				SetupCoefsFor1DFFT(arCoef, NeedsShiftAfterX? m_ArrayShiftX : (float*)0, Mult, rotModeAfter);
+				ApplyCoefsPerVector(FFT1DInfo.pOutData, FFT1DInfo.HowMany, arCoef, (rotModeAfter != 0));
+				if(OutDataFFT2 != 0) ApplyCoefsPerVector(FFT1DInfo.pOutData2, FFT1DInfo.HowMany, arCoef, (rotModeAfter != 0));
+			}
+#ifdef _FFTW3
+			else if(arCoefD != 0)
+			{
+				SetupCoefsFor1DFFT(arCoefD, NeedsShiftAfterX? m_dArrayShiftX : (double*)0, Mult, rotModeAfter);
+				ApplyCoefsPerVector(FFT1DInfo.pdOutData, FFT1DInfo.HowMany, arCoefD, (rotModeAfter != 0));
+				if(dOutDataFFT2 != 0) ApplyCoefsPerVector(FFT1DInfo.pdOutData2, FFT1DInfo.HowMany, arCoefD, (rotModeAfter != 0));
+			}
 #endif
 		}
 	}
@@ -1396,15 +1526,7 @@ int CGenMathFFT1D::Make1DFFT(CGenMathFFT1DInfo& FFT1DInfo, void* pvGPU) //OC0509
 		}//)
 		else 
 #endif
-		{
-			//FillArrayShift(t0SignMult*x0_After, FFT1DInfo.xStepTr);
-			if(m_ArrayShiftX != 0) FillArrayShift(t0SignMult * x0_After, FFT1DInfo.xStepTr, m_ArrayShiftX); //OC02022019
-			else if(m_dArrayShiftX != 0) FillArrayShift(t0SignMult * x0_After, FFT1DInfo.xStepTr, m_dArrayShiftX);
-
-			if(OutDataFFT != 0) TreatShift(OutDataFFT, FFT1DInfo.HowMany);
-#ifdef _FFTW3 //OC27022019
-			else if(dOutDataFFT != 0) TreatShift(dOutDataFFT, FFT1DInfo.HowMany);
-#endif
+		{//On CPU, the shift was applied above, together with normalization
 		}
 	}
 
@@ -1412,6 +1534,14 @@ int CGenMathFFT1D::Make1DFFT(CGenMathFFT1DInfo& FFT1DInfo, void* pvGPU) //OC0509
 	{
 		int result = ProcessSharpEdges(FFT1DInfo);
 		if(result) return result;
+
+		if(((FFT1DInfo.pInData2 != 0) && (FFT1DInfo.pOutData2 != 0)) || ((FFT1DInfo.pdInData2 != 0) && (FFT1DInfo.pdOutData2 != 0)))
+		{
+			CGenMathFFT1DInfo FFT1DInfo2 = FFT1DInfo;
+			FFT1DInfo2.pInData = FFT1DInfo.pInData2; FFT1DInfo2.pOutData = FFT1DInfo.pOutData2;
+			FFT1DInfo2.pdInData = FFT1DInfo.pdInData2; FFT1DInfo2.pdOutData = FFT1DInfo.pdOutData2;
+			if(result = ProcessSharpEdges(FFT1DInfo2)) return result;
+		}
 	}
 
 #ifdef _OFFLOAD_GPU //OC06092023 (to avoid #include "auxgpu.h" for CPU)
@@ -1443,8 +1573,8 @@ int CGenMathFFT1D::Make1DFFT(CGenMathFFT1DInfo& FFT1DInfo, void* pvGPU) //OC0509
 		//OC27102018: thread safety issue?
 #ifdef _FFTW3 //OC29012019
 
-		if(DataToFFT != 0) fftwf_destroy_plan(Plan1DFFT);
-		else if(dDataToFFT != 0) fftw_destroy_plan(dPlan1DFFT);
+		if(DataToFFT != 0) { std::lock_guard<std::mutex> lck(m_mtxPlan); fftwf_destroy_plan(Plan1DFFT);}
+		else if(dDataToFFT != 0) { std::lock_guard<std::mutex> lck(m_mtxPlan); fftw_destroy_plan(dPlan1DFFT);}
 
 #ifdef _WITH_OMP 
 
@@ -1454,34 +1584,55 @@ int CGenMathFFT1D::Make1DFFT(CGenMathFFT1DInfo& FFT1DInfo, void* pvGPU) //OC0509
 #endif
 #else //ifndef _FFTW3
 
-		fftw_destroy_plan(Plan1DFFT);
+		{ std::lock_guard<std::mutex> lck(m_mtxPlan); fftw_destroy_plan(Plan1DFFT);}
 
 #endif
 	}
 
-	if(m_ArrayShiftX != 0)
+	//m_ArrayShiftX, m_dArrayShiftX are released by ArrayShiftXDel
+
+	//Added by S.Yakubov (for profiling?) at parallelizing SRW via OpenMP:
+	//srwlPrintTime("::Make1DFFT : after fft ",&start);
+	return 0;
+}
+
+//*************************************************************************
+
+#ifdef _FFTW3
+int CGenMathFFT1D::Execute1DFFTPlanOnOtherData(fftwf_plan Plan, fftwf_complex* pInRef, fftwf_complex* pOutRef, fftwf_complex* pIn, fftwf_complex* pOut, long HowMany, int Sign, unsigned flags)
+{//Executes existing plan on other data of the same layout, if the alignment of arrays allows for this; otherwise creates a dedicated plan
+	if((fftwf_alignment_of((float*)pIn) == fftwf_alignment_of((float*)pInRef)) && (fftwf_alignment_of((float*)pOut) == fftwf_alignment_of((float*)pOutRef)))
 	{
-#ifdef _OFFLOAD_GPU //OC06092023 (to avoid #include "auxgpu.h" for CPU)
-		m_ArrayShiftX = (float*)CAuxGPU::ToHostAndFree(pGPU, m_ArrayShiftX, (Nx << 1) * sizeof(float), true); //OC19022024
-		//m_ArrayShiftX = (float*)CAuxGPU::ToHostAndFree((TGPUUsageArg*)pvGPU, m_ArrayShiftX, (Nx << 1) * sizeof(float), true); //OC06092023
-		//m_ArrayShiftX = (float*)CAuxGPU::ToHostAndFree(pGpuUsage, m_ArrayShiftX, (Nx << 1) * sizeof(float), true);
-#endif
-		delete[] m_ArrayShiftX;
+		fftwf_execute_dft(Plan, pIn, pOut);
+		return 0;
 	}
-	if(m_dArrayShiftX != 0)
+	int arN[] = { (int)Nx };
+	fftwf_plan PlanAux;
+	{ std::lock_guard<std::mutex> lck(m_mtxPlan); PlanAux = fftwf_plan_many_dft(1, arN, HowMany, pIn, NULL, 1, Nx, pOut, NULL, 1, Nx, Sign, flags);}
+	if(PlanAux == 0) return ERROR_IN_FFT;
+	fftwf_execute(PlanAux);
+	{ std::lock_guard<std::mutex> lck(m_mtxPlan); fftwf_destroy_plan(PlanAux);}
+	return 0;
+}
+
+//*************************************************************************
+
+int CGenMathFFT1D::Execute1DFFTPlanOnOtherData(fftw_plan Plan, fftw_complex* pInRef, fftw_complex* pOutRef, fftw_complex* pIn, fftw_complex* pOut, long HowMany, int Sign, unsigned flags)
+{
+	if((fftw_alignment_of((double*)pIn) == fftw_alignment_of((double*)pInRef)) && (fftw_alignment_of((double*)pOut) == fftw_alignment_of((double*)pOutRef)))
 	{
-#ifdef _OFFLOAD_GPU //OC06092023 (to avoid #include "auxgpu.h" for CPU)
-		m_dArrayShiftX = (double*)CAuxGPU::ToHostAndFree(pGPU, m_dArrayShiftX, (Nx << 1) * sizeof(double), true); //OC19022024
-		//m_dArrayShiftX = (double*)CAuxGPU::ToHostAndFree((TGPUUsageArg*)pvGPU, m_dArrayShiftX, (Nx << 1) * sizeof(double), true); //OC06092023
-		//m_dArrayShiftX = (double*)CAuxGPU::ToHostAndFree(pGpuUsage, m_dArrayShiftX, (Nx << 1) * sizeof(double), true);
-#endif
-		delete[] m_dArrayShiftX;
+		fftw_execute_dft(Plan, pIn, pOut);
+		return 0;
 	}
-
-	//Added by S.Yakubov (for profiling?) at parallelizing SRW via OpenMP:
-	//srwlPrintTime("::Make1DFFT : after fft ",&start);
+	int arN[] = { (int)Nx };
+	fftw_plan PlanAux;
+	{ std::lock_guard<std::mutex> lck(m_mtxPlan); PlanAux = fftw_plan_many_dft(1, arN, HowMany, pIn, NULL, 1, Nx, pOut, NULL, 1, Nx, Sign, flags);}
+	if(PlanAux == 0) return ERROR_IN_FFT;
+	fftw_execute(PlanAux);
+	{ std::lock_guard<std::mutex> lck(m_mtxPlan); fftw_destroy_plan(PlanAux);}
 	return 0;
 }
+#endif
 
 //*************************************************************************
 
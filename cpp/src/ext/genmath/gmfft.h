@@ -38,6 +38,7 @@
 
 //#include <cmath>
 #include <math.h>
+#include <mutex>
 
 #ifndef _GM_WITHOUT_BASE
 #include "gmobj.h"
@@ -66,6 +67,8 @@ class CGenMathFFT //{
 
 protected:
 
+	static std::mutex m_mtxPlan; //FFTW planner is not thread-safe: creation / destruction of plans is serialized
+
 	static long GoodNumbers[];
 	static long LenGoodNumbers;
 	static long GoodNum100s[];
@@ -77,6 +80,8 @@ protected:
 
 public:
 
+	static std::mutex& MutexPlan() { return m_mtxPlan;} //to be locked at creation / destruction of FFTW plans outside this class
+
 	double HalfPI, PI, TwoPI, ThreePIdTwo, One_dTwoPI; // Constants
 
 	CGenMathFFT()
@@ -520,6 +525,11 @@ public:
 struct CGenMathFFT1DInfo {
 	float *pInData, *pOutData;
 	double *pdInData, *pdOutData; //OC31012019
+	//Optional second data set of the same layout (e.g. other polarization component of a wavefront),
+	//transformed with the same plan and auxiliary arrays as the first one; 
+	//it should be "in-place" or "out-of-place" in the same way as the first data set:
+	float *pInData2, *pOutData2;
+	double *pdInData2, *pdOutData2;
 
 	char Dir; // >0: forward; <0: backward
 	double xStep, xStart;
@@ -546,6 +556,10 @@ struct CGenMathFFT1DInfo {
 		pOutData = 0;
 		pdInData = 0;
 		pdOutData = 0;
+		pInData2 = 0;
+		pOutData2 = 0;
+		pdInData2 = 0;
+		pdOutData2 = 0;
 	}
 };
 
@@ -627,6 +641,10 @@ public:
 
 	int Make1DFFT(CGenMathFFT1DInfo& FFT1DInfo, void* pvGPU=0); //OC05092023
 	int Make1DFFT_InPlace(CGenMathFFT1DInfo& FFT1DInfo, void* pvGPU=0); //OC05092023
+#ifdef _FFTW3
+	int Execute1DFFTPlanOnOtherData(fftwf_plan Plan, fftwf_complex* pInRef, fftwf_complex* pOutRef, fftwf_complex* pIn, fftwf_complex* pOut, long HowMany, int Sign, unsigned flags);
+	int Execute1DFFTPlanOnOtherData(fftw_plan Plan, fftw_complex* pInRef, fftw_complex* pOutRef, fftw_complex* pIn, fftw_complex* pOut, long HowMany, int Sign, unsigned flags);
+#endif
 
 //#ifndef _OFFLOAD_GPU //OC05092023
 //	int Make1DFFT(CGenMathFFT1DInfo& FFT1DInfo);
@@ -694,6 +712,69 @@ public:
 		CosAndSin(-q*t0TwoPI, *tm, *(tm+1));
 	}
 
+	template <class T> void SetupCoefsFor1DFFT(T* arCoef, const T* arShiftX, double Mult, char rotMode)
+	{//Sets up complex multipliers to be applied to all vectors in one pass by ApplyCoefsPerVector.
+	 //rotMode: 0- no rotation (only shift and/or normalization);
+	 //-1- rotation followed by sign repair (before backward FFT; shift, if any, is applied prior to rotation);
+	 //1- sign repair followed by rotation (after forward FFT; shift, if any, is applied after rotation).
+	 //Assumes Nx even !
+		T *tCoef = arCoef;
+		for(long j=0; j<Nx; j++)
+		{
+			long jRot = (rotMode != 0)? ((j < HalfNx)? (j + HalfNx) : (j - HalfNx)) : j;
+			long jSign = (rotMode < 0)? j : jRot;
+			long jShift = (rotMode < 0)? jRot : j;
+
+			double Mlt = ((rotMode != 0) && (jSign & 1))? -Mult : Mult;
+			if(arShiftX != 0)
+			{
+				const T *tShift = arShiftX + (jShift << 1);
+				*(tCoef++) = (T)(Mlt*(*tShift)); *(tCoef++) = (T)(Mlt*(*(tShift + 1)));
+			}
+			else
+			{
+				*(tCoef++) = (T)Mlt; *(tCoef++) = 0;
+			}
+		}
+	}
+
+	template <class T> void ApplyCoefsPerVector(T* pData, long HowMany, const T* arCoef, bool Rotate)
+	{//Multiplies each of HowMany contiguous complex vectors of length Nx by arCoef, swapping the vector halves on the way if Rotate.
+	 //Processes one vector at a time (cache-friendly), in parallel over vectors.
+	 //Assumes Nx even !
+		long long PerVect = ((long long)Nx) << 1;
+		long long HalfPerVect = ((long long)HalfNx) << 1;
+#ifdef _WITH_OMP
+		#pragma omp parallel for if(omp_get_num_threads()==1) //to avoid nested multi-threading
+#endif
+		for(long k=0; k<HowMany; k++)
+		{
+			T *t1 = pData + k*PerVect;
+			if(Rotate)
+			{
+				T *t2 = t1 + HalfPerVect;
+				const T *c1 = arCoef, *c2 = arCoef + HalfPerVect;
+				for(long j=0; j<HalfNx; j++)
+				{
+					T re1 = *t1, im1 = *(t1 + 1), re2 = *t2, im2 = *(t2 + 1);
+					*t1 = re2*(*c1) - im2*(*(c1 + 1)); *(t1 + 1) = re2*(*(c1 + 1)) + im2*(*c1);
+					*t2 = re1*(*c2) - im1*(*(c2 + 1)); *(t2 + 1) = re1*(*(c2 + 1)) + im1*(*c2);
+					t1 += 2; t2 += 2; c1 += 2; c2 += 2;
+				}
+			}
+			else
+			{
+				const T *c = arCoef;
+				for(long j=0; j<Nx; j++)
+				{
+					T re = *t1, im = *(t1 + 1);
+					*t1 = re*(*c) - im*(*(c + 1)); *(t1 + 1) = re*(*(c + 1)) + im*(*c);
+					t1 += 2; c += 2;
+				}
+			}
+		}
+	}
+
 #ifdef _FFTW3 //OC29012019
 	void TreatShift(fftwf_complex* pData, long HowMany)
 	{
@@ -778,6 +778,41 @@ public:
 		}
 		else return 0;
 	}
+
+	static int InterpOnRegMesh2dWeights(double x, double y, double x_min, double x_step, long long nx, double y_min, double y_step, long long ny, long long* arInd, double* arW, char ord=3)
+	{//Indexes and weights of mesh values used by InterpOnRegMesh2d at (x, y): the interpolated value is sum(arW[i]*ar_f[arInd[i]]), i < returned number of values (<= 16);
+	 //the weights are obtained by interpolating unit values on the same stencil
+		if((x_step == 0) || (y_step == 0) || (ord < 1) || (ord > 3) || (nx <= ord) || (ny <= ord)) throw CAN_NOT_FIND_IND_FOR_INTERP;
+		const double truncTol = 1.e-12; //same as in InterpOnRegMesh2d
+
+		long long ix0 = (long long)((x - x_min)/x_step + truncTol);
+		long long iy0 = (long long)((y - y_min)/y_step + truncTol);
+		long long ixMin = (ord == 1)? 0 : 1, ixMax = (ord == 3)? nx - 3 : nx - 2;
+		long long iyMin = (ord == 1)? 0 : 1, iyMax = (ord == 3)? ny - 3 : ny - 2;
+		if(ix0 < ixMin) ix0 = ixMin; else if(ix0 > ixMax) ix0 = ixMax;
+		if(iy0 < iyMin) iy0 = iyMin; else if(iy0 > iyMax) iy0 = iyMax;
+		long long ixs = ix0 - ixMin, iys = iy0 - iyMin; //first node of the stencil
+		long long n = ord + 1; //stencil size in each dimension
+
+		double arUnitF[16];
+		for(int i=0; i<16; i++) arUnitF[i] = 0.;
+		double xsMin = x_min + ixs*x_step, ysMin = y_min + iys*y_step;
+		int nRes = 0;
+		for(long long iy=0; iy<n; iy++)
+		{
+			for(long long ix=0; ix<n; ix++)
+			{
+				long long i = iy*n + ix;
+				arUnitF[i] = 1.;
+				double w = InterpOnRegMesh2d(x, y, xsMin, x_step, n, ysMin, y_step, n, arUnitF, ord);
+				arUnitF[i] = 0.;
+				if(w == 0.) continue;
+				arInd[nRes] = (iys + iy)*nx + ixs + ix;
+				arW[nRes++] = w;
+			}
+		}
+		return nRes;
+	}
 };
 
 //-------------------------------------------------------------------------
@@ -202,6 +202,32 @@ public:
 		return res;
 	}
 
+	static void Integ1D_FuncDefByArrayWeights(double* arW, long long Np, double Step)
+	{//Weights such that Integ1D_FuncDefByArray(FuncArr, Np, Step) = sum(arW[i]*FuncArr[i]), i < Np
+		if(arW == 0) return;
+		for(long long i=0; i<Np; i++) arW[i] = 0.;
+		if((Np < 2) || (Step == 0)) return;
+		if(Np == 2) { arW[0] = arW[1] = 0.5*Step; return;}
+
+		long long NpSim = Np;
+		bool NpIsEven = (Np == ((Np >> 1) << 1));
+		if(NpIsEven) NpSim--;
+
+		//Simpson part (same points as in Integ1D_FuncDefByArray)
+		double StepD3 = Step/3.;
+		arW[0] = StepD3;
+		long long j = 1;
+		for(long long i = 1; i < ((NpSim - 3) >> 1); i++)
+		{
+			arW[j++] += 4.*StepD3;
+			arW[j++] += 2.*StepD3;
+		}
+		arW[j++] += 4.*StepD3;
+		arW[j] += StepD3;
+
+		if(NpIsEven) { arW[NpSim - 1] += 0.5*Step; arW[NpSim] += 0.5*Step;} //Last step is "trapethoidal"
+	}
+
 	//template <class T> static double Integ2D_FuncDefByArray(T* arFlatFunc, long np1, long np2, double step1, double step2)
 	template <class T> static double Integ2D_FuncDefByArray(T* arFlatFunc, long long np1, long long np2, double step1, double step2)
 	{
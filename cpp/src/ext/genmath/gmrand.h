@@ -16,6 +16,11 @@
 
 #include <time.h>
 #include <cstdlib>
+#include <cmath>
+
+#ifdef _WITH_OMP //Pre-processor definition for compiling with OpenMP library
+#include "omp.h"
+#endif
 
 //*************************************************************************
 
@@ -37,6 +42,8 @@ class CGenMathRandLPTau {
 	long long iQ, mQ;
 	long long MaskArr[30], *MaskArrTrav;
 
+	unsigned long long m_arDirNum[6][52]; //direction numbers (scaled by 2^52) for direct, index-based generation (LPTauQuick)
+
 public:
 	CGenMathRandLPTau()
 	{
@@ -98,9 +105,35 @@ public:
 		MaskArrTrav = MaskArr;
 		iQ = 0; mQ = 1;
 
+		SetupDirNum();
+
 		srand(1);
 	}
 
+	void SetupDirNum()
+	{//Extends the tabulated 20 direction numbers (NR) to 52 bits using the recurrences of the corresponding primitive polynomials,
+	 //which reproduce the tabulated values; arPolDeg, arPolCoef: degrees and inner coefficients of these polynomials
+		const int arPolDeg[] = {0, 1, 2, 3, 3, 4};
+		const int arPolCoef[] = {0, 0, 1, 1, 2, 1};
+		for(int j=0; j<6; j++)
+		{
+			unsigned long long arM[52];
+			int s = arPolDeg[j], a = arPolCoef[j];
+			for(int k=0; k<52; k++)
+			{
+				if(k < 20) arM[k] = (unsigned long long)NR[j][k];
+				else if(s == 0) arM[k] = 1;
+				else
+				{
+					unsigned long long m = arM[k - s] ^ (arM[k - s] << s);
+					for(int i=1; i<s; i++) if((a >> (s - 1 - i)) & 1) m ^= (arM[k - i] << i);
+					arM[k] = m;
+				}
+				m_arDirNum[j][k] = arM[k] << (51 - k);
+			}
+		}
+	}
+
 /**
 	void LPTauSlow(int n, double* Q)
 	{
@@ -150,8 +183,22 @@ public:
 	//double D(double x) { return x - long(x);}
 	double D(double x) { return x - ((long long)(x));}
 
-	void LPTauQuick(long i, int n, double q)
-	{
+	void LPTauQuick(long long i, int n, double* Q) const
+	{//Returns n <= 6 components of the i-th LPTau point (0 < i < 2^52) directly from its index;
+	 //for i < 2^20, the result is the same as that of i-th call to LPTauSlow
+		const double inv2e52 = 1./4503599627370496.;
+		if(n > 6) n = 6;
+		for(int j=0; j<n; j++)
+		{
+			const unsigned long long *pDirNum = m_arDirNum[j];
+			unsigned long long q = 0;
+			for(unsigned long long ii=(unsigned long long)i; ii!=0; ii>>=1)
+			{
+				if(ii & 1) q ^= *pDirNum;
+				pDirNum++;
+			}
+			Q[j] = q*inv2e52;
+		}
 	}
 
 	void SimpleRand(int n, double* Q)
@@ -389,4 +436,141 @@ public:
 
 //*************************************************************************
 
+class CGenMathRandCntr {
+//Counter-based pseudo-random generator: the number with index cnt in the stream defined by seed is obtained by hashing (SplitMix64 mixing function),
+//so that any element of any stream can be obtained directly, without generating the preceding ones
+	
+	unsigned long long m_key;
+
+public:
+
+	CGenMathRandCntr(unsigned long long seed =0)
+	{
+		SetSeed(seed);
+	}
+
+	void SetSeed(unsigned long long seed)
+	{
+		m_key = Mix(seed + 0x9E3779B97F4A7C15ULL);
+	}
+
+	static unsigned long long Mix(unsigned long long x)
+	{
+		x = (x ^ (x >> 30))*0xBF58476D1CE4E5B9ULL;
+		x = (x ^ (x >> 27))*0x94D049BB133111EBULL;
+		return x ^ (x >> 31);
+	}
+
+	double RandStd(unsigned long long cnt) const
+	{// Returns standard random number (>0 and <1)
+		unsigned long long x = Mix(m_key + (cnt + 1)*0x9E3779B97F4A7C15ULL);
+		return ((x >> 11) + 0.5)*(1./9007199254740992.);
+	}
+
+	void RandStdN(unsigned long long cnt, int n, double* Q) const
+	{// Returns n standard random numbers with indexes cnt, cnt+1, ... cnt+n-1
+		for(int i=0; i<n; i++) Q[i] = RandStd(cnt + i);
+	}
+};
+
+//*************************************************************************
+
+class CGenMathRandGaussSampler {
+//Generates points of a correlated n-dimensional (n <= 6) Gaussian distribution, defined by mean values and covariance matrix.
+//The i-th point depends only on i (and on seed), not on the order of generation or on number of threads, so that the points can be
+//generated in blocks, by different threads / processes, with the results being bit-reproducible.
+
+	int m_nDim;
+	double m_arMean[6];
+	double m_arL[36]; //lower-triangular factor of covariance matrix: Cov = L*Transp(L)
+	char m_randMode; //1- LPTau (quasi-random), 2- counter-based pseudo-random
+	CGenMathRandLPTau m_LPTau;
+	CGenMathRandCntr m_RandCntr;
+
+public:
+
+	CGenMathRandGaussSampler()
+	{
+		m_nDim = 0; m_randMode = 1;
+	}
+
+	bool Setup(int nDim, const double* arMean, const double* arCov, char randMode =1, unsigned long long seed =0)
+	{//arCov is nDim x nDim symmetric matrix (row by row); returns false if it is not positive semi-definite.
+	 //Zero variances (/degenerate directions) are allowed: the corresponding coordinates are then set to mean values (/linear combinations of other ones).
+		if((nDim <= 0) || (nDim > 6) || (arCov == 0) || ((randMode != 1) && (randMode != 2))) return false;
+		m_nDim = nDim;
+		m_randMode = randMode;
+		m_RandCntr.SetSeed(seed);
+
+		for(int i=0; i<nDim; i++) m_arMean[i] = (arMean != 0)? arMean[i] : 0.;
+		for(int i=0; i<36; i++) m_arL[i] = 0.;
+
+		//Cholesky decomposition, tolerating zero pivots
+		for(int j=0; j<nDim; j++)
+		{
+			double *pLj = m_arL + j*6;
+			double d = arCov[j*nDim + j];
+			for(int k=0; k<j; k++) d -= pLj[k]*pLj[k];
+
+			double relTol = 1.e-12*fabs(arCov[j*nDim + j]);
+			if(d < -relTol) return false;
+			if(d <= relTol)
+			{//degenerate direction
+				for(int i=j+1; i<nDim; i++)
+				{
+					double *pLi = m_arL + i*6;
+					double c = arCov[i*nDim + j];
+					for(int k=0; k<j; k++) c -= pLi[k]*pLj[k];
+					if(fabs(c) > 1.e-06*sqrt(fabs(arCov[i*nDim + i]*arCov[j*nDim + j])) + 1.e-300) return false;
+				}
+				continue;
+			}
+			double Ljj = sqrt(d), invLjj = 1./Ljj;
+			pLj[j] = Ljj;
+			for(int i=j+1; i<nDim; i++)
+			{
+				double *pLi = m_arL + i*6;
+				double c = arCov[i*nDim + j];
+				for(int k=0; k<j; k++) c -= pLi[k]*pLj[k];
+				pLi[j] = c*invLjj;
+			}
+		}
+		return true;
+	}
+
+	void GetPoint(long long i, double* arP) const
+	{//i >= 0
+		const double TwoPI = 6.28318530717959;
+		double g[6];
+		int nDimEven = ((m_nDim + 1) >> 1) << 1;
+		if(m_randMode == 1) m_LPTau.LPTauQuick(i + 1, nDimEven, g); //point 0 (all zeros) of the LPTau sequence is skipped
+		else m_RandCntr.RandStdN(((unsigned long long)i)*6, nDimEven, g);
+
+		double arNorm[6];
+		for(int k=0; k<nDimEven; k+=2)
+		{
+			double a = sqrt(-2.*log(g[k])), ph = TwoPI*g[k + 1];
+			arNorm[k] = a*cos(ph); arNorm[k + 1] = a*sin(ph);
+		}
+
+		for(int k=0; k<m_nDim; k++)
+		{
+			const double *pLk = m_arL + k*6;
+			double v = m_arMean[k];
+			for(int j=0; j<=k; j++) v += pLk[j]*arNorm[j];
+			arP[k] = v;
+		}
+	}
+
+	void GetPoints(long long iStart, long long nPt, double* arP) const
+	{//Fills arP with nPt points (iStart, ... iStart + nPt - 1), m_nDim values per point
+#ifdef _WITH_OMP
+		#pragma omp parallel for schedule(static)
+#endif
+		for(long long i=0; i<nPt; i++) GetPoint(iStart + i, arP + i*m_nDim);
+	}
+};
+
+//*************************************************************************
+
 #endif
@@ -73,6 +73,7 @@ int (*pgWfrExtModifFunc)(int Action, srTSRWRadInData* pWfrIn, char PolComp);
 int (*pgOptElemGetInfByNameFunc)(const char* sNameOptElem, char** pDescrStr, int* LenDescr, void*);
 
 int (*gpWfrModifFunc)(int action, SRWLWfr* pWfrIn, char pol) = 0; //from SRWLIB, to allow for compiling
+thread_local SRWLContext* gpCurCtx = 0; //from SRWLIB, to allow for compiling
 
 //-------------------------------------------------------------------------
 
@@ -20,11 +20,17 @@
 
 vector<string> CErrWarn::error;
 vector<string> CErrWarn::warning;
+mutex CErrWarn::m_mtx;
+thread_local vector<int>* CErrWarn::m_pThreadWarnNos = 0;
+thread_local vector<int> CErrWarn::m_OwnWarnNos;
 
 //-------------------------------------------------------------------------
 
 CErrWarn::CErrWarn()
 {
+	lock_guard<mutex> lck(m_mtx);
+	if(!error.empty()) return; //the tables are static: filled only once
+
 //string CErrWarn::error[] = {
 	error.push_back("Wrong error number"); //to check if and how this is used in SRW for Igor
 
@@ -256,6 +262,8 @@ CErrWarn::CErrWarn()
 
 	error.push_back("Incorrect hyperboloidal mirror parameters: p, q, grazing angle and sagital radius should be positive.\0"); //#196
 
+	error.push_back("Incorrect input parameters for sampling of particle beam phase-space coordinates (the second-order moments should form a positive semi-definite matrix).\0"); //#197
+
 //};
 
 //string CErrWarn::warning[] = {
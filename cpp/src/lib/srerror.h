@@ -16,8 +16,13 @@
 
 #include <string>
 #include <vector>
+#include <mutex>
 #include "srercode.h"
 
+#ifdef _WITH_OMP
+#include "omp.h"
+#endif
+
 //using namespace std;
 #include "stlstart.h"
 
@@ -33,9 +38,27 @@ protected:
 	//static string warning[];
 	static vector<string> error;
 	static vector<string> warning;
+	static mutex m_mtx; //guards filling of the message tables and the lists of warnings (which can be appended from different threads)
 
 public:
 
+	static thread_local vector<int>* m_pThreadWarnNos; //if set (see srwlUtiCtxSetCurrent), warnings issued by the calling thread go there
+	static thread_local vector<int> m_OwnWarnNos; //warnings of a thread which has no context bound (in SRWLIB)
+
+	static vector<int>* ThreadWarnNos(vector<int>* pWarnMesNos)
+	{//list of warnings of the calling thread; worker threads of parallel regions get the list of the thread which started the region via CErrWarnBind,
+	 //otherwise (regions not expected to issue warnings) they use the process-wide one
+		if(m_pThreadWarnNos != 0) return m_pThreadWarnNos;
+#if defined(SRWLIB_STATIC) || defined(SRWLIB_SHARED)
+#ifdef _WITH_OMP
+		if(omp_get_thread_num() != 0) return pWarnMesNos;
+#endif
+		return &m_OwnWarnNos;
+#else
+		return pWarnMesNos;
+#endif
+	}
+
 	CErrWarn();
 	
 	static int GetErrorSize(int ErrNo)
@@ -71,6 +94,8 @@ public:
 	//static void AddWarningMessage(srTIntVect* pWarnMesNos, int WarnNo)
 	static void AddWarningMessage(vector<int>* pWarnMesNos, int WarnNo)
 	{
+		pWarnMesNos = ThreadWarnNos(pWarnMesNos);
+		lock_guard<mutex> lck(m_mtx);
 		//for(srTIntVect::iterator iter = pWarnMesNos->begin(); iter != pWarnMesNos->end(); ++iter)
 		for(vector<int>::iterator iter = pWarnMesNos->begin(); iter != pWarnMesNos->end(); ++iter)
 		{
@@ -79,9 +104,49 @@ public:
 		pWarnMesNos->push_back(WarnNo);
 	}
 
+	static int ExtractFirstWarning(vector<int>* pWarnMesNos)
+	{//returns first accumulated warning (or 0) and clears the list; a thread bound to a context only gets its own warnings,
+	 //other threads get their own warnings first, then those of the process-wide list
+		bool isBound = (m_pThreadWarnNos != 0);
+		vector<int> *pThreadWarnNos = ThreadWarnNos(pWarnMesNos);
+		lock_guard<mutex> lck(m_mtx);
+		if(pThreadWarnNos->empty() && !isBound) pThreadWarnNos = pWarnMesNos;
+		if(pThreadWarnNos->empty()) return 0;
+		int WarnNo = (*pThreadWarnNos)[0];
+		pThreadWarnNos->erase(pThreadWarnNos->begin(), pThreadWarnNos->end());
+		return WarnNo;
+	}
+
 	static int ValidateArray(void* Arr, int nElem);
 };
 
 //-------------------------------------------------------------------------
 
+class CErrWarnBind {
+//To be passed as firstprivate to parallel regions which may issue warnings: each copy binds the thread where it is made
+//to the list of warnings of the thread that created the original object (i.e. started the region), until the copy is destroyed
+	vector<int>* m_pWarnNos;
+	vector<int>* m_pPrevWarnNos;
+
+public:
+
+	CErrWarnBind(vector<int>* pWarnMesNos)
+	{
+		m_pWarnNos = CErrWarn::ThreadWarnNos(pWarnMesNos);
+		m_pPrevWarnNos = CErrWarn::m_pThreadWarnNos;
+	}
+	CErrWarnBind(const CErrWarnBind& b)
+	{
+		m_pWarnNos = b.m_pWarnNos;
+		m_pPrevWarnNos = CErrWarn::m_pThreadWarnNos;
+		CErrWarn::m_pThreadWarnNos = m_pWarnNos;
+	}
+	~CErrWarnBind()
+	{
+		CErrWarn::m_pThreadWarnNos = m_pPrevWarnNos;
+	}
+};
+
+//-------------------------------------------------------------------------
+
 #endif
@@ -29,6 +29,9 @@ struct srTParPrecElecFld {
 	double NxNzOversamplingFactor; //active if > 0
 	bool ShowProgrIndic;
 	char CalcTerminTerms;
+	double PerLen, sPerStart; //period length and start position of periodic part of the field (used by "periodic" integration method)
+	long nPer; //number of periods in the periodic part
+	int nPerSamp; //initial number of periods at which single-period integrals are computed directly
 
 	//srTParPrecElecFld(int In_CreateNewWfrObj, int In_IntegMethNo, double In_RelPrecOrStep, double In_sStartInt, double In_sEndInt, double In_NxNzOversamplingFactor)
 	//srTParPrecElecFld(int In_IntegMethNo, double In_RelPrecOrStep, double In_sStartInt, double In_sEndInt, double In_NxNzOversamplingFactor, bool In_ShowProgrIndic = true)
@@ -41,6 +44,7 @@ struct srTParPrecElecFld {
         NxNzOversamplingFactor = In_NxNzOversamplingFactor;
 		ShowProgrIndic = In_ShowProgrIndic;
 		CalcTerminTerms = In_CalcTerminTerms;
+		PerLen = sPerStart = 0.; nPer = 0; nPerSamp = 0;
 	}
 };
 
@@ -95,15 +99,20 @@ struct srTParPrecPowDens {
 	double PrecFact;
 	int MethNo, UseSpecIntLim; 
 	double sIntStart, sIntFin;
+	double AdaptRelTol; //relative tolerance of adaptive observation mesh refinement (0 means uniform mesh)
+	long long NpComp; //output: number of observation points at which power density was actually computed
+	int NumLevComp; //output: number of mesh refinement levels used
 
 	//srTParPrecPowDens(int In_CreateNewPowDensObj, int In_MethNo, double In_PrecFact)
-	srTParPrecPowDens(int In_MethNo, double In_PrecFact, int In_UseSpecIntLim, double In_sIntStart, double In_sIntFin)
+	srTParPrecPowDens(int In_MethNo, double In_PrecFact, int In_UseSpecIntLim, double In_sIntStart, double In_sIntFin, double In_AdaptRelTol =0)
 	{
         //CreateNewPowDensObj = In_CreateNewPowDensObj; //0- don't create, otherwise - create
         MethNo = In_MethNo; 
         PrecFact = In_PrecFact;
 		UseSpecIntLim = In_UseSpecIntLim;
 		sIntStart = In_sIntStart; sIntFin = In_sIntFin;
+		AdaptRelTol = In_AdaptRelTol;
+		NpComp = 0; NumLevComp = 0;
 	}
 };
 
@@ -0,0 +1,63 @@
+/************************************************************************//**
+ * File: srwlctx.h
+ * Description: SRWLIB context: state of the library which would otherwise be process-global (header)
+ * Project: Synchrotron Radiation Workshop Library (SRWLib)
+ * First release: 2026
+ *
+ * SRW is Copyright (C) European Synchrotron Radiation Facility, Grenoble, France
+ * SRW C/C++ API (SRWLib) is Copyright (C) European XFEL, Hamburg, Germany
+ * All Rights Reserved
+ *
+ * @version see srwlUtiVerNo
+ ***************************************************************************/
+
+#ifndef __SRWLCTX_H
+#define __SRWLCTX_H
+
+#include "srwlib.h"
+#include "srprgind.h"
+
+#include <vector>
+
+//-------------------------------------------------------------------------
+
+typedef int (*TSRWLWfrModifFunc)(int action, SRWLWfr* pWfrIn, char pol);
+typedef char* (*TSRWLAllocArrayFunc)(char type, long long len);
+
+//Process-wide call-back functions (used when no context is bound to the calling thread, or when the context does not define them);
+//process-wide progress indicator function and abort request are kept in srTCompProgressIndicator::m_GlobCtrl (the function to call is resolved in srTCompProgressIndicator::CallExtFunc)
+extern TSRWLWfrModifFunc gpWfrModifFunc;
+extern TSRWLAllocArrayFunc gpAllocArrayFunc;
+
+//-------------------------------------------------------------------------
+
+struct SRWLStructContext {
+	std::vector<int> vWarnNos; //warnings accumulated by calls made in this context
+	TSRWLWfrModifFunc pWfrModifFunc;
+	TSRWLAllocArrayFunc pAllocArrayFunc;
+	srTCompCtrl CompCtrl; //progress indicator function and abort request for computations made in this context
+
+	SRWLStructContext()
+	{
+		pWfrModifFunc = 0; pAllocArrayFunc = 0;
+	}
+};
+
+//Context bound to the calling thread by srwlUtiCtxSetCurrent (0 if none)
+extern thread_local SRWLContext* gpCurCtx;
+
+//-------------------------------------------------------------------------
+
+inline TSRWLWfrModifFunc srwlCurWfrModifFunc()
+{
+	return ((gpCurCtx != 0) && (gpCurCtx->pWfrModifFunc != 0))? gpCurCtx->pWfrModifFunc : gpWfrModifFunc;
+}
+
+inline TSRWLAllocArrayFunc srwlCurAllocArrayFunc()
+{
+	return ((gpCurCtx != 0) && (gpCurCtx->pAllocArrayFunc != 0))? gpCurCtx->pAllocArrayFunc : gpAllocArrayFunc;
+}
+
+//-------------------------------------------------------------------------
+
+#endif
@@ -13,6 +13,8 @@
  ***************************************************************************/
 
 #include "srwlib.h"
+#include "srwlctx.h"
+#include "srwlprof.h"
 #include "srerror.h"
 #include "srmagfld.h"
 #include "srmagcnt.h"
@@ -28,6 +30,7 @@
 #include "srpowden.h"
 #include "srisosrc.h"
 #include "srmatsta.h"
+#include "gmrand.h"
 
 #ifdef _OFFLOAD_GPU
 #include "auxgpu.h" //OC27072023
@@ -55,7 +58,8 @@ int (*pgOptElemGetInfByNameFunc)(const char* sNameOptElem, char** pDescrStr, int
 
 int (*gpWfrModifFunc)(int action, SRWLWfr* pWfrIn, char pol) = 0;
 char* (*gpAllocArrayFunc)(char type, long long len) = 0; //OC15082018
-int (*gpCompProgressIndicFunc)(double curVal) = 0;
+
+thread_local SRWLContext* gpCurCtx = 0;
 
 //-------------------------------------------------------------------------
 // Auxiliary Functions
@@ -63,12 +67,8 @@ int (*gpCompProgressIndicFunc)(double curVal) = 0;
 
 void UtiWarnCheck()
 {
-	if(!gVectWarnNos.empty())
-	{
-		int CurWarnNo = gVectWarnNos[0];
-        gVectWarnNos.erase(gVectWarnNos.begin(), gVectWarnNos.end());
-		throw CurWarnNo;
-	}
+	int CurWarnNo = CErrWarn::ExtractFirstWarning(&gVectWarnNos); //from the context of the calling thread, if any
+	if(CurWarnNo != 0) throw CurWarnNo;
 }
 
 //-------------------------------------------------------------------------
@@ -101,14 +101,16 @@ EXP int CALL srwlUtiVerNo(char* verNoStr, int code)
 EXP void CALL srwlUtiSetWfrModifFunc(int (*pExtFunc)(int action, SRWLWfr* pWfrIn, char pol))
 {
 	//if(pExtFunc != 0) gpWfrModifFunc = pExtFunc;
-	gpWfrModifFunc = pExtFunc;
+	if(gpCurCtx != 0) gpCurCtx->pWfrModifFunc = pExtFunc;
+	else gpWfrModifFunc = pExtFunc;
 }
 
 //-------------------------------------------------------------------------
 
 EXP void CALL srwlUtiSetAllocArrayFunc(char* (*pExtFunc)(char type, long long len)) //OC15082018
 {
-	gpAllocArrayFunc = pExtFunc;
+	if(gpCurCtx != 0) gpCurCtx->pAllocArrayFunc = pExtFunc;
+	else gpAllocArrayFunc = pExtFunc;
 }
 
 //-------------------------------------------------------------------------
@@ -116,7 +118,46 @@ EXP void CALL srwlUtiSetAllocArrayFunc(char* (*pExtFunc)(char type, long long le
 EXP void CALL srwlUtiSetProgrIndFunc(int (*pExtFunc)(double curVal))
 {
 	//if(pExtFunc != 0) gpCompProgressIndicFunc = pExtFunc;
-	gpCompProgressIndicFunc = pExtFunc;
+	if(gpCurCtx != 0) gpCurCtx->CompCtrl.pProgrIndFunc = pExtFunc;
+	else srTCompProgressIndicator::m_GlobCtrl.pProgrIndFunc = pExtFunc;
+}
+
+//-------------------------------------------------------------------------
+
+EXP int CALL srwlUtiCompAbort(SRWLContext* ctx, int on)
+{
+	srTCompCtrl &compCtrl = (ctx != 0)? ctx->CompCtrl : srTCompProgressIndicator::m_GlobCtrl;
+	compCtrl.AbortReq.store((on != 0)? 1 : 0);
+	return 0;
+}
+
+//-------------------------------------------------------------------------
+
+EXP int CALL srwlUtiCtxCreate(SRWLContext** pCtx)
+{
+	if(pCtx == 0) return SRWL_NO_FUNC_ARG_DATA;
+	*pCtx = new SRWLContext();
+	return 0;
+}
+
+//-------------------------------------------------------------------------
+
+EXP int CALL srwlUtiCtxDelete(SRWLContext* ctx)
+{
+	if(ctx == 0) return SRWL_NO_FUNC_ARG_DATA;
+	if(gpCurCtx == ctx) srwlUtiCtxSetCurrent(0);
+	delete ctx;
+	return 0;
+}
+
+//-------------------------------------------------------------------------
+
+EXP int CALL srwlUtiCtxSetCurrent(SRWLContext* ctx)
+{
+	gpCurCtx = ctx;
+	CErrWarn::m_pThreadWarnNos = (ctx != 0)? &(ctx->vWarnNos) : 0;
+	srTCompProgressIndicator::m_pThreadCtrl = (ctx != 0)? &(ctx->CompCtrl) : 0;
+	return 0;
 }
 
 //-------------------------------------------------------------------------
@@ -145,6 +186,55 @@ EXP int CALL srwlUtiGetErrText(char* t, int errNo)
 
 //-------------------------------------------------------------------------
 
+EXP int CALL srwlUtiProfProc(int op)
+{
+	CSRWLProf &prof = CSRWLProf::Inst();
+	if(op == 0) prof.m_isOn = false;
+	else if(op == 1) prof.m_isOn = true;
+	else if(op == 2) prof.Reset();
+	return 0;
+}
+
+//-------------------------------------------------------------------------
+
+EXP int CALL srwlUtiProfGet(double* arRes, int* pnNodes)
+{
+	if(pnNodes == 0) return SRWL_NO_FUNC_ARG_DATA;
+
+	CSRWLProf &prof = CSRWLProf::Inst();
+	int nNodes = prof.m_nNodes.load() - 1; //root is not returned
+	if(arRes != 0)
+	{
+		if(nNodes > *pnNodes) nNodes = *pnNodes;
+		double *t = arRes;
+		for(int i=1; i<=nNodes; i++)
+		{
+			CSRWLProf::TNode &node = prof.m_arNodes[i];
+			*(t++) = node.iParent - 1;
+			*(t++) = node.iStage;
+			*(t++) = (double)node.nCalls.load();
+			*(t++) = 1.e-09*node.nsTot.load();
+			*(t++) = 1.e-09*node.nsChild.load();
+			*(t++) = (double)node.nBytes.load();
+		}
+	}
+	*pnNodes = nNodes;
+	return 0;
+}
+
+//-------------------------------------------------------------------------
+
+EXP int CALL srwlUtiProfGetStageName(char* t, int iStage)
+{
+	if(t == 0) return SRWL_NO_FUNC_ARG_DATA;
+	const char *sName = CSRWLProf::StageName(iStage);
+	if(sName == 0) return SRWL_NO_FUNC_ARG_DATA;
+	strcpy(t, sName);
+	return 0;
+}
+
+//-------------------------------------------------------------------------
+
 bool TryToCopyMagFldInsteadOfInterp(SRWLMagFldC* pDispMagFld, SRWLMagFldC* pMagFld)
 {
 	if((pDispMagFld == 0) || (pMagFld == 0)) throw SRWL_NO_FUNC_ARG_DATA;
@@ -264,6 +354,59 @@ bool TryToCopyMagFldInsteadOfInterp(SRWLMagFldC* pDispMagFld, SRWLMagFldC* pMagF
 
 //-------------------------------------------------------------------------
 
+void AddMagFldDataChecksumToKey(double** arData, long long* arLen, int nData, vector<double>& vKeyPar)
+{//FNV-1a-type checksum over the data arrays (as for trajectories, see srTTrjDatCacheKey), added as two exactly representable halves
+	unsigned long long h = 14695981039346656037ULL;
+	for(int j=0; j<nData; j++)
+	{
+		const double *p = arData[j];
+		if(p == 0) continue;
+		for(long long i=0; i<arLen[j]; i++)
+		{
+			unsigned long long w;
+			memcpy(&w, p + i, sizeof(double));
+			h = (h ^ w)*1099511628211ULL;
+		}
+	}
+	vKeyPar.push_back((double)(h >> 32)); vKeyPar.push_back((double)(h & 0xFFFFFFFFULL));
+}
+
+//-------------------------------------------------------------------------
+
+bool SetupMagFldInterpPrepKey(SRWLMagFldC* pDispMagFld, SRWLMagFldC* pMagFld, vector<double>& vKeyPar, vector<const void*>& vKeyPtr)
+{//Identifies the mesh of resulting field and the container of tabulated fields, for finding prepared interpolation
+ //(data of 3D fields are identified by their pointers and checksums, so that modified data is not taken for the prepared one);
+ //returns false if the container includes fields other than 3D ones (such interpolation is not prepared)
+	vKeyPar.clear(); vKeyPtr.clear();
+	SRWLMagFldC* arC[] = {pDispMagFld, pMagFld};
+	for(int k=0; k<2; k++)
+	{
+		SRWLMagFldC *pC = arC[k];
+		vKeyPar.push_back(pC->nElem);
+		double* arArr[] = {pC->arXc, pC->arYc, pC->arZc, pC->arVx, pC->arVy, pC->arVz, pC->arAng};
+		for(int i=0; i<pC->nElem; i++)
+		{
+			if(pC->arMagFldTypes[i] != 'a') return false;
+			for(int j=0; j<7; j++) vKeyPar.push_back((arArr[j] != 0)? arArr[j][i] : 0.);
+
+			SRWLMagFld3D *pF = (SRWLMagFld3D*)(pC->arMagFld[i]);
+			vKeyPar.push_back(pF->nx); vKeyPar.push_back(pF->ny); vKeyPar.push_back(pF->nz);
+			vKeyPar.push_back(pF->rx); vKeyPar.push_back(pF->ry); vKeyPar.push_back(pF->rz);
+			vKeyPar.push_back(pF->nRep); vKeyPar.push_back(pF->interp);
+			vKeyPtr.push_back(pF->arX); vKeyPtr.push_back(pF->arY); vKeyPtr.push_back(pF->arZ);
+			if(k == 1) { vKeyPtr.push_back(pF->arBx); vKeyPtr.push_back(pF->arBy); vKeyPtr.push_back(pF->arBz);}
+
+			long long nTot = ((long long)(pF->nx))*((long long)(pF->ny))*((long long)(pF->nz));
+			double *arData[] = {pF->arX, pF->arY, pF->arZ, pF->arBx, pF->arBy, pF->arBz};
+			long long arLen[] = {pF->nx, pF->ny, pF->nz, nTot, nTot, nTot};
+			AddMagFldDataChecksumToKey(arData, arLen, (k == 1)? 6 : 3, vKeyPar); //field of the mesh container is the output
+		}
+	}
+	return true;
+}
+
+//-------------------------------------------------------------------------
+
 EXP int CALL srwlCalcMagFld(SRWLMagFldC* pDispMagFld, SRWLMagFldC* pMagFld, double* precPar)
 {
 	if((pDispMagFld == 0) || (pMagFld == 0)) return SRWL_NO_FUNC_ARG_DATA;
@@ -312,7 +455,13 @@ EXP int CALL srwlCalcMagFld(SRWLMagFldC* pDispMagFld, SRWLMagFldC* pMagFld, doub
 		
 		//int typeCalc = int(precPar[0]);
 		if(typeCalc == 0) magFld3d.tabulateB(&magCont);
-		else if((typeCalc > 0) && (typeCalc < 3)) magFld3d.tabInterpB(magCont, precPar, pMagFld->arPar1, pMagFld->arPar2, pMagFld->arPar3, pMagFld->arPar4);
+		else if((typeCalc > 0) && (typeCalc < 3))
+		{
+			vector<double> vKeyPar; vector<const void*> vKeyPtr;
+			CSmartPtr<srTMagFldInterpPrep> hPrep;
+			if(SetupMagFldInterpPrepKey(pDispMagFld, pMagFld, vKeyPar, vKeyPtr)) hPrep = srTMagFldInterpPrep::Find(vKeyPar, vKeyPtr);
+			magFld3d.tabInterpB(magCont, precPar, pMagFld->arPar1, pMagFld->arPar2, pMagFld->arPar3, pMagFld->arPar4, hPrep.ptr());
+		}
 
 		UtiWarnCheck();
 	}
@@ -400,6 +549,110 @@ EXP int CALL srwlCalcPartTrajFromKickMatr(SRWLPrtTrj* pTrj, SRWLKickM* arKickM,
 
 //-------------------------------------------------------------------------
 
+EXP int CALL srwlCalcPartTrajFromKickMatrMult(SRWLPrtTrj* arTrj, int nTrj, SRWLKickM* arKickM, int nKickM, double* precPar)
+{
+	if((arTrj == 0) || (nTrj <= 0) || (arKickM == 0) || (nKickM <= 0)) return SRWL_NO_FUNC_ARG_DATA;
+	for(int i=0; i<nTrj; i++)
+	{
+		SRWLPrtTrj &trj = arTrj[i];
+		if((trj.arX == 0) || (trj.arXp == 0) || (trj.arY == 0) || (trj.arYp == 0) || (trj.np <= 0)) return SRWL_INCORRECT_TRJ_STRUCT;
+	}
+
+	try 
+	{
+		double arDefPrecPar[] = {1};
+		srTGenTrjDat::CompTrjKickMatrMult(arTrj, nTrj, arKickM, nKickM, (precPar != 0)? precPar : arDefPrecPar);
+		UtiWarnCheck();
+	}
+	catch(int erNo) 
+	{ 
+		return erNo;
+	}
+	return 0;
+}
+
+//-------------------------------------------------------------------------
+
+EXP int CALL srwlUtiTrjPrep(SRWLPrtTrjPrep** pHndl, SRWLPrtTrj* pTrj)
+{
+	if((pHndl == 0) || (pTrj == 0)) return SRWL_NO_FUNC_ARG_DATA;
+	if((((pTrj->arX == 0) || (pTrj->arXp == 0)) && ((pTrj->arY == 0) || (pTrj->arYp == 0))) || (pTrj->np <= 0)) return SRWL_INCORRECT_TRJ_STRUCT;
+
+	try 
+	{
+		SRWLPrtTrjPrep *pPrep = new SRWLPrtTrjPrep();
+		try { pPrep->hTrjDat = srTTrjDatCache::Get(pTrj, true);}
+		catch(int) { delete pPrep; throw;}
+		*pHndl = pPrep;
+		UtiWarnCheck();
+	}
+	catch(int erNo) 
+	{ 
+		return erNo;
+	}
+	return 0;
+}
+
+//-------------------------------------------------------------------------
+
+EXP int CALL srwlUtiTrjPrepDel(SRWLPrtTrjPrep* hndl)
+{
+	if(hndl == 0) 
+	{
+		srTTrjDatCache::Clear();
+		return 0;
+	}
+	srTTrjDatCache::Unpin(hndl->hTrjDat.ptr());
+	delete hndl;
+	return 0;
+}
+
+//-------------------------------------------------------------------------
+
+EXP int CALL srwlUtiMagFldInterpPrep(SRWLMagFldInterpPrep** pHndl, SRWLMagFldC* pDispMagFld, SRWLMagFldC* pMagFld)
+{
+	if((pHndl == 0) || (pDispMagFld == 0) || (pMagFld == 0)) return SRWL_NO_FUNC_ARG_DATA;
+	if((pDispMagFld->nElem != 1) || (pDispMagFld->arMagFldTypes[0] != 'a')) return SRWL_INCORRECT_PARAM_FOR_MAG_FLD_COMP;
+	if(pMagFld->nElem <= 0) return SRWL_INCORRECT_PARAM_FOR_MAG_FLD_COMP;
+
+	try 
+	{
+		vector<double> vKeyPar; vector<const void*> vKeyPtr;
+		if(!SetupMagFldInterpPrepKey(pDispMagFld, pMagFld, vKeyPar, vKeyPtr)) return SRWL_INCORRECT_PARAM_FOR_MAG_FLD_COMP;
+
+		SRWLMagFldInterpPrep *pPrep = new SRWLMagFldInterpPrep();
+		pPrep->hPrep = srTMagFldInterpPrep::Find(vKeyPar, vKeyPtr);
+		if(pPrep->hPrep.ptr() == 0)
+		{//fields of the members are resampled later, when they are first used for interpolation
+			pPrep->hPrep = CSmartPtr<srTMagFldInterpPrep>(new srTMagFldInterpPrep(vKeyPar, vKeyPtr, pMagFld->nElem));
+		}
+		srTMagFldInterpPrep::Register(pPrep->hPrep);
+		*pHndl = pPrep;
+		UtiWarnCheck();
+	}
+	catch(int erNo) 
+	{ 
+		return erNo;
+	}
+	return 0;
+}
+
+//-------------------------------------------------------------------------
+
+EXP int CALL srwlUtiMagFldInterpPrepDel(SRWLMagFldInterpPrep* hndl)
+{
+	if(hndl == 0) 
+	{
+		srTMagFldInterpPrep::Clear();
+		return 0;
+	}
+	srTMagFldInterpPrep::Unregister(hndl->hPrep.ptr());
+	delete hndl;
+	return 0;
+}
+
+//-------------------------------------------------------------------------
+
 SRWLPrtTrj* SetupTrjFromMagFld(SRWLParticle* pPartInitCond, SRWLMagFldC* pMagFld, double* precPar)
 {//To be used by srwlCalcElecFieldSR, srwlCalcPowDenSR, and maybe other API functions
 	//if(precPar == 0) return 0;
@@ -500,7 +753,11 @@ EXP int CALL srwlCalcElecFieldSR(SRWLWfr* pWfr, SRWLPrtTrj* pTrj, SRWLMagFldC* p
 		//}
 		else pWfr->partBeam.partStatMom1 = pTrj->partInitCond;
 
-		srTTrjDat trjData(pTrj); //this calculates interpolating structure required for SR calculation
+		//Interpolating structure of a user-supplied trajectory is taken from cache (it is only computed if the trajectory was not used before);
+		//a shallow copy is used here, so that modifications of electron beam data do not affect the cached structure
+		CSmartPtr<srTTrjDat> hTrjDat = trjIsDefined? srTTrjDatCache::Get(pTrj) : CSmartPtr<srTTrjDat>(new srTTrjDat(pTrj));
+		srTTrjDat trjData(*(hTrjDat.ptr()));
+		trjData.m_doNotDeleteData = true;
 		trjData.EbmDat.SetCurrentAndMom2(pWfr->partBeam.Iavg, pWfr->partBeam.arStatMom2, 21);
 
 		srTSRWRadStructAccessData wfr(pWfr, &trjData, precPar); //ATTENTION: this may request for changing numbers of points in the wavefront mesh
@@ -516,6 +773,31 @@ EXP int CALL srwlCalcElecFieldSR(SRWLWfr* pWfr, SRWLPrtTrj* pTrj, SRWLMagFldC* p
 		//srTParPrecElecFld(int In_IntegMethNo, double In_RelPrecOrStep, double In_sStartInt, double In_sEndInt, double In_NxNzOversamplingFactor, bool In_ShowProgrIndic = true, char In_CalcTerminTerms = 1)
 		srTParPrecElecFld precElecFld((int)precPar[0], precPar[1], precPar[2], precPar[3], precPar[6], false, calcTerminTerms);
 
+		if((int)precPar[0] == 3)
+		{//"periodic" method: number of sample periods, and (optionally) period length, start position and number of periods of the periodic part
+			if(nPrecPar > 7) precElecFld.nPerSamp = (int)precPar[7];
+			if((nPrecPar > 10) && (precPar[8] > 0.) && (precPar[10] > 0.))
+			{
+				precElecFld.PerLen = precPar[8]; precElecFld.sPerStart = precPar[9]; precElecFld.nPer = (long)precPar[10];
+			}
+			else if(fldIsDefined)
+			{//taking the periodic part from the first undulator in the container, excluding one (end) period at each side
+				for(int i=0; i<pMagFld->nElem; i++)
+				{
+					if(pMagFld->arMagFldTypes[i] != 'u') continue;
+					SRWLMagFldU *pUnd = (SRWLMagFldU*)(pMagFld->arMagFld[i]);
+					double zc = (pMagFld->arZc != 0)? pMagFld->arZc[i] : 0.;
+					if((pUnd->per > 0.) && (pUnd->nPer > 2))
+					{
+						precElecFld.PerLen = pUnd->per;
+						precElecFld.nPer = pUnd->nPer - 2;
+						precElecFld.sPerStart = zc - (0.5*pUnd->nPer - 1.)*pUnd->per;
+					}
+					break;
+				}
+			}
+		}
+
         srTRadInt RadInt;
 		RadInt.ComputeElectricFieldFreqDomain(&trjData, &auxSmp, &precElecFld, &wfr, 0);
 		wfr.OutSRWRadPtrs(*pWfr);
@@ -570,6 +852,50 @@ EXP int CALL srwlCalcElecFieldGaussian(SRWLWfr* pWfr, SRWLGsnBm* pGsnBm, double*
 
 //-------------------------------------------------------------------------
 
+EXP int CALL srwlCalcElecFieldGaussianModes(SRWLWfr** arWfr, int nWfr, SRWLGsnBm* pGsnBm, int* arModeInds)
+{
+	if((arWfr == 0) || (nWfr <= 0) || (pGsnBm == 0) || (arModeInds == 0)) return SRWL_INCORRECT_PARAM_FOR_GAUS_BEAM_COMP;
+	for(int i=0; i<nWfr; i++) if(arWfr[i] == 0) return SRWL_INCORRECT_PARAM_FOR_GAUS_BEAM_COMP;
+
+	int locErNo = 0;
+	vector<srTSRWRadStructAccessData*> vpWfr;
+	try 
+	{
+		SRWLRadMesh &mesh0 = arWfr[0]->mesh;
+		for(int i=1; i<nWfr; i++)
+		{
+			SRWLRadMesh &mesh = arWfr[i]->mesh;
+			if((mesh.ne != mesh0.ne) || (mesh.nx != mesh0.nx) || (mesh.ny != mesh0.ny) || 
+			   (mesh.eStart != mesh0.eStart) || (mesh.eFin != mesh0.eFin) || (mesh.xStart != mesh0.xStart) || (mesh.xFin != mesh0.xFin) || 
+			   (mesh.yStart != mesh0.yStart) || (mesh.yFin != mesh0.yFin) || (mesh.zStart != mesh0.zStart) || 
+			   (arWfr[i]->presFT != arWfr[0]->presFT)) throw SRWL_INCORRECT_PARAM_FOR_GAUS_BEAM_COMP;
+		}
+
+		double arMom1[] = {pGsnBm->x, pGsnBm->xp, pGsnBm->y, pGsnBm->yp};
+		srTGsnBeam GsnBm(-1, pGsnBm->polar, pGsnBm->sigX, 0, pGsnBm->sigY, 0, pGsnBm->sigT, 1, arMom1, pGsnBm->z, pGsnBm->repRate, pGsnBm->pulseEn, pGsnBm->avgPhotEn);
+
+		double arPrecPar[] = {0}; //no change of mesh: the modes should stay on the same (input) mesh
+		for(int i=0; i<nWfr; i++)
+		{
+			srTSRWRadStructAccessData *pWfr = new srTSRWRadStructAccessData(arWfr[i], &GsnBm, arPrecPar);
+			vpWfr.push_back(pWfr);
+		}
+		srTWfrSmp auxSmp;
+		vpWfr[0]->SetObsParamFromWfr(auxSmp);
+
+		GsnBm.ComputeElectricFieldModes(&auxSmp, &vpWfr[0], arModeInds, nWfr);
+		for(int i=0; i<nWfr; i++) vpWfr[i]->OutSRWRadPtrs(*(arWfr[i]));
+
+		UtiWarnCheck();
+	}
+	catch(int erNo) 
+	{
+		locErNo = erNo;
+	}
+	for(int i=0; i<(int)vpWfr.size(); i++) delete vpWfr[i];
+	return locErNo;
+}
+
 EXP int CALL srwlCalcElecFieldPointSrc(SRWLWfr* pWfr, SRWLPtSrc* pPtSrc, double* precPar)
 {
 	if(pWfr == 0) return SRWL_INCORRECT_PARAM_FOR_SPHER_WAVE_COMP;
@@ -655,6 +981,13 @@ EXP int CALL srwlCalcStokesUR(SRWLStokes* pStokes, SRWLPartBeam* pElBeam, SRWLMa
 //-------------------------------------------------------------------------
 
 EXP int CALL srwlCalcPowDenSR(SRWLStokes* pStokes, SRWLPartBeam* pElBeam, SRWLPrtTrj* pTrj, SRWLMagFldC* pMagFld, double* precPar)
+{
+	return srwlCalcPowDenSRAdapt(pStokes, pElBeam, pTrj, pMagFld, precPar, 0.);
+}
+
+//-------------------------------------------------------------------------
+
+EXP int CALL srwlCalcPowDenSRAdapt(SRWLStokes* pStokes, SRWLPartBeam* pElBeam, SRWLPrtTrj* pTrj, SRWLMagFldC* pMagFld, double* precPar, double relTol, double* arStat)
 {
 	if((pStokes == 0) || (pElBeam == 0)) return SRWL_INCORRECT_PARAM_FOR_SR_POW_COMP;
 
@@ -701,7 +1034,9 @@ EXP int CALL srwlCalcPowDenSR(SRWLStokes* pStokes, SRWLPartBeam* pElBeam, SRWLPr
 		//	if(locErNo = srwlCalcPartTraj(pTrj, pMagFld, precParForTrj)) throw locErNo;
 		//}
 
-		srTTrjDat trjData(pTrj); //this calculates interpolating structure required for SR calculation
+		CSmartPtr<srTTrjDat> hTrjDat = trjIsDefined? srTTrjDatCache::Get(pTrj) : CSmartPtr<srTTrjDat>(new srTTrjDat(pTrj)); //see comment in srwlCalcElecFieldSR
+		srTTrjDat trjData(*(hTrjDat.ptr()));
+		trjData.m_doNotDeleteData = true;
 		trjData.EbmDat.SetCurrentAndMom2(pElBeam->Iavg, pElBeam->arStatMom2, 21);
 
 		//Default precision parameters:
@@ -710,6 +1045,7 @@ EXP int CALL srwlCalcPowDenSR(SRWLStokes* pStokes, SRWLPartBeam* pElBeam, SRWLPr
 		int useSpecIntLim = 0;
 		double sIntStart = 0;
 		double sIntFin = 0;
+		double adaptRelTol = (relTol > 0.)? relTol : 0.; //0 means uniform observation mesh
 		if(precPar != 0)
 		{
 			precFact = precPar[0];
@@ -718,7 +1054,7 @@ EXP int CALL srwlCalcPowDenSR(SRWLStokes* pStokes, SRWLPartBeam* pElBeam, SRWLPr
 			sIntStart = precPar[2];
 			sIntFin = precPar[3];
 		}
-		srTParPrecPowDens precPowDens(meth, precFact, useSpecIntLim, sIntStart, sIntFin);
+		srTParPrecPowDens precPowDens(meth, precFact, useSpecIntLim, sIntStart, sIntFin, adaptRelTol);
 		//srTWfrSmp wfrSmp(pStokes->zStart, pStokes->xStart, pStokes->xFin, pStokes->nx, pStokes->yStart, pStokes->yFin, pStokes->ny, 0, pStokes->eStart, pStokes->eFin, pStokes->ne, "eV");
 		SRWLStructRadMesh &mesh = pStokes->mesh;
 		//srTWfrSmp wfrSmp(mesh.zStart, mesh.xStart, mesh.xFin, mesh.nx, mesh.yStart, mesh.yFin, mesh.ny, 0, mesh.eStart, mesh.eFin, mesh.ne, "eV");
@@ -732,6 +1068,11 @@ EXP int CALL srwlCalcPowDenSR(SRWLStokes* pStokes, SRWLPartBeam* pElBeam, SRWLPr
 
 		srTRadIntPowerDensity RadIntPowDens;
 		RadIntPowDens.ComputePowerDensity(&trjData, &wfrSmp, &precPowDens, &pow);
+		if(arStat != 0) 
+		{//refinement statistics
+			arStat[0] = (double)precPowDens.NpComp;
+			arStat[1] = (double)precPowDens.NumLevComp;
+		}
 
 		UtiWarnCheck();
 	}
@@ -774,6 +1115,7 @@ EXP int CALL srwlCalcIntFromElecField(char* pInt, SRWLWfr* pWfr, char polar, cha
 
 	SRWLPrtTrj *pTrj=0; //OC23022020
 	srTTrjDat *pTrjDat=0;
+	CSmartPtr<srTTrjDat> hTrjDat; //keeps cached interpolating structure alive while its shallow copy (pTrjDat) is used
 	bool trjDataShouldBeDel = false;
 	int res = 0; //OC20022024
 	try 
@@ -803,7 +1145,13 @@ EXP int CALL srwlCalcIntFromElecField(char* pInt, SRWLWfr* pWfr, char polar, cha
 			}
 			else if(typeFldTrj == 2) pTrj = (SRWLPrtTrj*)pFldTrj;
 
-			pTrjDat = new srTTrjDat(pTrj); //this calculates interpolating structure required for SR calculation
+			if(typeFldTrj == 2)
+			{//user-supplied trajectory: interpolating structure is taken from cache (see srwlCalcElecFieldSR)
+				hTrjDat = srTTrjDatCache::Get(pTrj);
+				pTrjDat = new srTTrjDat(*(hTrjDat.ptr()));
+				pTrjDat->m_doNotDeleteData = true;
+			}
+			else pTrjDat = new srTTrjDat(pTrj); //this calculates interpolating structure required for SR calculation
 			pTrjDat->EbmDat.SetCurrentAndMom2(pWfr->partBeam.Iavg, pWfr->partBeam.arStatMom2, 21);
 			//pFldTrj = pTrjData;
 		}
@@ -1038,6 +1386,8 @@ EXP int CALL srwlPropagElecField(SRWLWfr* pWfr, SRWLOptC* pOpt, int nInt, char**
 //#endif //HG21032024 (commented-out)
 	try 
 	{
+		CSRWLProfScope profScope(srwlProfPropag, ((long long)pWfr->mesh.ne)*((long long)pWfr->mesh.nx)*((long long)pWfr->mesh.ny)*4*sizeof(float));
+
 		srTCompositeOptElem optCont(*pOpt);
 		srTSRWRadStructAccessData wfr(pWfr);
 		if(locErNo = optCont.CheckRadStructForPropagation(&wfr)) return locErNo;
@@ -1499,6 +1849,30 @@ EXP int CALL srwlUtiIntInf(double* arInf, char* pcData, char typeData, SRWLRadMe
 
 //-------------------------------------------------------------------------
 
+EXP int CALL srwlUtiIntInfMult(double* arInf, char* pcData, char typeData, SRWLRadMesh* pMesh, int nFrames, double* arPar, int nPar)
+{
+	if((arInf == 0) || (pcData == 0) || ((typeData != 'f') && (typeData != 'd')) || (pMesh == 0) || (nFrames <= 0)) return SRWL_INCORRECT_PARAM_FOR_INT_STAT;
+	try 
+	{
+		SRWLRadMesh meshSlice = *pMesh; //photon energy slices are interleaved in the data and processed separately
+		meshSlice.ne = 1;
+		srTWaveAccessData InData(pcData, typeData, &meshSlice);
+		if((InData.AmOfDims < 1) || (InData.AmOfDims > 2)) throw SRWL_INCORRECT_PARAM_FOR_INT_STAT;
+
+		long long nSlices = (pMesh->ne > 1)? pMesh->ne : 1;
+		srTAuxMatStat AuxMatStat;
+		int res = 0;
+		if(res = AuxMatStat.FindStatMult(InData, nSlices, nFrames, arInf, arPar, nPar)) throw res;
+	}
+	catch(int erNo)
+	{
+		return erNo;
+	}
+	return 0;
+}
+
+//-------------------------------------------------------------------------
+
 EXP int CALL srwlUtiIntProc(char* pcI1, char typeI1, SRWLRadMesh* pMesh1, char* pcI2, char typeI2, SRWLRadMesh* pMesh2, double* arPar, int nPar) //OC09032019
 //EXP int CALL srwlUtiIntProc(char* pcI1, char typeI1, SRWLRadMesh* pMesh1, char* pcI2, char typeI2, SRWLRadMesh* pMesh2, double* arPar)
 {//OC13112018
@@ -1529,6 +1903,66 @@ EXP int CALL srwlUtiIntProc(char* pcI1, char typeI1, SRWLRadMesh* pMesh1, char*
 
 //-------------------------------------------------------------------------
 
+EXP int CALL srwlUtiIntProcMult(char* pcI1, char typeI1, SRWLRadMesh* pMesh1, char* pcI2, char typeI2, SRWLRadMesh* pMesh2, int nFrames, double* arPar, int nPar)
+{
+	if((pcI1 == 0) || ((typeI1 != 'f') && (typeI1 != 'd')) || (pMesh1 == 0) || 
+	   (pcI2 == 0) || ((typeI2 != 'f') && (typeI2 != 'd')) || (pMesh2 == 0) || 
+	   (nFrames <= 0) || (arPar == 0) || (nPar <= 0) || ((char)arPar[0] != 3)) return SRWL_INCORRECT_PARAM_FOR_INT_PROC;
+
+	try 
+	{
+		srTWaveAccessData wI1(pcI1, typeI1, pMesh1), wI2(pcI2, typeI2, pMesh2);
+		srTRadGenManip::Int2DIntegOverAzimMult(&wI1, &wI2, nFrames, arPar + 1, nPar - 1);
+	}
+	catch(int erNo)
+	{
+		return erNo;
+	}
+	return 0;
+}
+
+//-------------------------------------------------------------------------
+
+EXP int CALL srwlUtiIntProcPrep(SRWLIntProcPlan** pHndl, SRWLRadMesh* pMesh1, SRWLRadMesh* pMesh2, double* arPar, int nPar)
+{
+	if((pHndl == 0) || (pMesh1 == 0) || (pMesh2 == 0) || (arPar == 0)) return SRWL_NO_FUNC_ARG_DATA;
+	if((nPar <= 0) || ((char)arPar[0] != 3)) return SRWL_INCORRECT_PARAM_FOR_INT_PROC;
+
+	try 
+	{//data pointers are not used by the plan
+		srTWaveAccessData wI1(0, 'f', pMesh1), wI2(0, 'f', pMesh2);
+		vector<double> vKey;
+		if(!srTAuxInt2DIntegOverAzimPlan::SetupKey(&wI1, &wI2, arPar + 1, nPar - 1, vKey)) return SRWL_INCORRECT_PARAM_FOR_INT_PROC;
+
+		SRWLIntProcPlan *pPlan = new SRWLIntProcPlan();
+		pPlan->hPlan = srTAuxInt2DIntegOverAzimPlan::Find(vKey);
+		if(pPlan->hPlan.ptr() == 0)
+		{
+			try { pPlan->hPlan = CSmartPtr<srTAuxInt2DIntegOverAzimPlan>(new srTAuxInt2DIntegOverAzimPlan(&wI1, &wI2, arPar + 1, nPar - 1));}
+			catch(int) { delete pPlan; throw;}
+		}
+		srTAuxInt2DIntegOverAzimPlan::Register(pPlan->hPlan);
+		*pHndl = pPlan;
+	}
+	catch(int erNo) 
+	{ 
+		return erNo;
+	}
+	return 0;
+}
+
+//-------------------------------------------------------------------------
+
+EXP int CALL srwlUtiIntProcPrepDel(SRWLIntProcPlan* hndl)
+{
+	if(hndl == 0) return SRWL_NO_FUNC_ARG_DATA;
+	srTAuxInt2DIntegOverAzimPlan::Unregister(hndl->hPlan.ptr());
+	delete hndl;
+	return 0;
+}
+
+//-------------------------------------------------------------------------
+
 EXP int CALL srwlUtiUndFromMagFldTab(SRWLMagFldC* pUndCnt, SRWLMagFldC* pMagCnt, double* arPrecPar)
 {
 	if((pUndCnt == 0) || (pMagCnt == 0) || (arPrecPar == 0)) return SRWL_INCORRECT_PARAM_FOR_CONV_MAG_2_PER;
@@ -1575,6 +2009,39 @@ EXP int CALL srwlUtiUndFindMagFldInterpInds(int* arResInds, int* pnResInds, doub
 
 //-------------------------------------------------------------------------
 
+EXP int CALL srwlUtiSampPartBeam(double* arPart, long long nPart, SRWLPartBeam* pPartBeam, long long iStart, char typeGen, long long seed)
+{
+	if((arPart == 0) || (nPart <= 0) || (pPartBeam == 0) || (iStart < 0) || ((typeGen != 1) && (typeGen != 2))) return SRWL_INCORRECT_PARAM_FOR_PART_BEAM_SAMP;
+
+	try 
+	{
+		SRWLParticle &part = pPartBeam->partStatMom1;
+		srTEbmDat eBeam(pPartBeam->Iavg, pPartBeam->nPart, 0, 0, pPartBeam->arStatMom2, 21, part.z, part.nq);
+		double arCov[36];
+		eBeam.GetCovMatr6D(arCov);
+		double arMean[] = {part.x, part.xp, part.y, part.yp, part.z, 0.};
+
+		CGenMathRandGaussSampler sampler;
+		if(!sampler.Setup(6, arMean, arCov, typeGen, (unsigned long long)seed)) throw SRWL_INCORRECT_PARAM_FOR_PART_BEAM_SAMP;
+		sampler.GetPoints(iStart, nPart, arPart);
+
+		double gamma0 = part.gamma;
+		double *t_arPart = arPart + 5;
+		for(long long i=0; i<nPart; i++) 
+		{
+			*t_arPart = gamma0*(1. + *t_arPart); //relative energy deviation -> gamma
+			t_arPart += 6;
+		}
+	}
+	catch(int erNo) 
+	{ 
+		return erNo;
+	}
+	return 0;
+}
+
+//-------------------------------------------------------------------------
+
 EXP int CALL srwlPropagRadMultiE(SRWLStokes* pStokes, SRWLWfr* pWfr0, SRWLOptC* pOpt, double* precPar, int (*pExtFunc)(int action, SRWLStokes* pStokesInst))
 {
 	if((pStokes == 0) || (pWfr0 == 0) || (pOpt == 0) || (precPar == 0)) return SRWL_INCORRECT_PARAM_FOR_WFR_PROP;
@@ -532,6 +532,27 @@ struct SRWLStructOpticsContainer {
 };
 typedef struct SRWLStructOpticsContainer SRWLOptC;
 
+/**
+ * Library context (opaque): holds warnings and external (call-back) functions which are otherwise process-wide.
+ * Independent srwl* calls can run concurrently in different threads of one process, if each of these threads has its own context bound (see srwlUtiCtxSetCurrent).
+ */
+typedef struct SRWLStructContext SRWLContext;
+
+/**
+ * Prepared particle trajectory (opaque): keeps interpolating structure computed for a trajectory in memory, so that it is reused by subsequent SR calculations (see srwlUtiTrjPrep).
+ */
+typedef struct SRWLStructPrtTrjPrep SRWLPrtTrjPrep;
+
+/**
+ * Prepared magnetic field interpolation (opaque): keeps fields of container members resampled on the mesh of the resulting field, so that subsequent interpolations vs gap / phase (see srwlCalcMagFld) only combine these data.
+ */
+typedef struct SRWLStructMagFldInterpPrep SRWLMagFldInterpPrep;
+
+/**
+ * Prepared intensity processing (opaque): keeps the resampling plan of azimuthal integration / averaging (srwlUtiIntProc with arPar[0] = 3 and arPar[2] = 1) as weights of input intensity values, so that subsequent processing of data on the same meshes only computes weighted sums.
+ */
+typedef struct SRWLStructIntProcPlan SRWLIntProcPlan;
+
 /************************************************************************//**
  * Main SRW C API
  ***************************************************************************/
@@ -556,6 +577,41 @@ EXP void CALL srwlUtiSetAllocArrayFunc(char* (*pExtFunc)(char type, long long le
  */
 EXP void CALL srwlUtiSetProgrIndFunc(int (*pExtFunc)(double curVal));
 
+/** 
+ * Requests abort of long computations (e.g. running in other threads), or cancels the request.
+ * While the request is on, computations of electric field, Stokes parameters, power density, etc., return error code of "computation aborted" shortly
+ * (checks are made at least once per observation point or macro-particle); the request has to be cancelled before starting new computations.
+ * Can be called from any thread, including from the progress indicator function (see srwlUtiSetProgrIndFunc).
+ * @param [in] ctx context of computations to abort (see srwlUtiCtxCreate); 0 means all computations of the process
+ * @param [in] on 1- request abort, 0- cancel the request
+ * @return	integer error (>0) or warnig (<0) code
+ */
+EXP int CALL srwlUtiCompAbort(SRWLContext* ctx, int on);
+
+/** 
+ * Creates new library context.
+ * @param [out] pCtx pointer to the context created (to be deleted by srwlUtiCtxDelete)
+ * @return	integer error (>0) or warnig (<0) code
+ * @see srwlUtiCtxSetCurrent
+ */
+EXP int CALL srwlUtiCtxCreate(SRWLContext** pCtx);
+
+/** 
+ * Deletes library context (which should not be bound to any other thread at this time).
+ * @param [in] ctx context to delete; if it is bound to the calling thread, the thread returns to process-wide state
+ * @return	integer error (>0) or warnig (<0) code
+ */
+EXP int CALL srwlUtiCtxDelete(SRWLContext* ctx);
+
+/** 
+ * Binds library context to the calling thread: warnings issued by subsequent srwl* calls of this thread are accumulated in the context,
+ * and external functions set by srwlUtiSetWfrModifFunc, srwlUtiSetAllocArrayFunc, srwlUtiSetProgrIndFunc are stored in it
+ * (those not set in the context are taken from process-wide state).
+ * @param [in] ctx context to bind; 0 unbinds the current context
+ * @return	integer error (>0) or warnig (<0) code
+ */
+EXP int CALL srwlUtiCtxSetCurrent(SRWLContext* ctx);
+
 /** 
  * Specifies current SRW version number.  
  * @param [out] verNoStr string specifying current version number of SRW (/API)
@@ -574,6 +630,35 @@ EXP int CALL srwlUtiVerNo(char* verNoStr, int code =1);
  */
 EXP int CALL srwlUtiGetErrText(char* t, int erNo);
 
+/** 
+ * Controls built-in profiling of main computation stages (wavefront propagation, FFTs, resizing, point-by-point modifications of wavefront,
+ * calculation of electric field and trajectory, mutual intensity updates); profiling is process-wide and disabled by default.
+ * @param [in] op operation: 0- disable, 1- enable, 2- reset accumulated data
+ * @return	integer error (>0) or warnig (<0) code
+ * @see srwlUtiProfGet
+ */
+EXP int CALL srwlUtiProfProc(int op);
+
+/** 
+ * Gets data accumulated by built-in profiling: tree of stages, each node corresponding to calls of a stage from the stage of its parent node
+ * (stages started in threads other than the one which called the parent stage, e.g. in OpenMP threads, are attached to the root).
+ * @param [out] arRes array of 6 values per node, for nodes in the order of their creation: index of parent node (-1 for top-level nodes),
+ *              stage number (see srwlUtiProfGetStageName), number of calls, total wall time [s], wall time of child stages [s], approximate volume of data processed [bytes];
+ *              can be 0 to get number of nodes only
+ * @param [in, out] pnNodes at input: max. number of nodes which can be stored in arRes; at output: actual number of nodes
+ * @return	integer error (>0) or warnig (<0) code
+ * @see srwlUtiProfProc
+ */
+EXP int CALL srwlUtiProfGet(double* arRes, int* pnNodes);
+
+/** 
+ * Provides name of a stage profiled by srwlUtiProfGet.
+ * @param [out] t output name of the stage (up to 32 characters)
+ * @param [in] iStage stage number
+ * @return	integer error (>0) or warnig (<0) code
+ */
+EXP int CALL srwlUtiProfGetStageName(char* t, int iStage);
+
 /** 
  * Calculates (tabulates) 3D magnetic field created by multiple elements
  * @param [in, out] pDispMagFld pointer to resulting magnetic field container with one element - 3D magnetic field structure to keep the tabulated field data (all arrays should be allocated in a calling function/application)
@@ -619,20 +704,73 @@ EXP int CALL srwlCalcPartTraj(SRWLPrtTrj* pTrj, SRWLMagFldC* pMagFld, double* pr
  */
 EXP int CALL srwlCalcPartTrajFromKickMatr(SRWLPrtTrj* pTrj, SRWLKickM* arKickM, int nKickM, double* precPar =0);
 
+/** 
+ * Calculates trajectories of many charged particles from an array of kick matrices (e.g. for tracking a particle ensemble through an insertion device);
+ * the kick matrices are prepared once for all particles, which are processed in parallel; each trajectory is the same as calculated by srwlCalcPartTrajFromKickMatr
+ * @param [in, out] arTrj array of resulting trajectory structures (all data arrays should be allocated in a calling function/application); the initial conditions and particle type must be specified in partInitCond of each structure (see srwlCalcPartTrajFromKickMatr)
+ * @param [in] nTrj number of trajectory structures in the array
+ * @param [in] arKickM array of kick matrix structures
+ * @param [in] nKickM number of kick matrices in the array
+ * @param [in] precPar (optional) precision parameters, as in srwlCalcPartTrajFromKickMatr
+ * @return	integer error (>0) or warnig (<0) code
+ * @see srwlCalcPartTrajFromKickMatr
+ */
+EXP int CALL srwlCalcPartTrajFromKickMatrMult(SRWLPrtTrj* arTrj, int nTrj, SRWLKickM* arKickM, int nKickM, double* precPar =0);
+
+/** 
+ * Prepares interpolating structure of a particle trajectory for SR calculations and keeps it in memory until srwlUtiTrjPrepDel is called.
+ * srwlCalcElecFieldSR, srwlCalcPowDenSR and srwlCalcIntFromElecField reuse interpolating structures of trajectories that were used before (a few most recent ones are kept without calling this function);
+ * a trajectory is recognized by its data arrays and their contents, so the structure is recomputed after any modification of the trajectory data.
+ * @param [out] pHndl pointer to the prepared trajectory handle created (to be deleted by srwlUtiTrjPrepDel)
+ * @param [in] pTrj pointer to particle trajectory structure (the arrays pTrj->arX, pTrj->arXp, pTrj->arY, pTrj->arYp should be defined)
+ * @return	integer error (>0) or warnig (<0) code
+ * @see srwlUtiTrjPrepDel
+ */
+EXP int CALL srwlUtiTrjPrep(SRWLPrtTrjPrep** pHndl, SRWLPrtTrj* pTrj);
+
+/** 
+ * Releases prepared particle trajectory.
+ * @param [in] hndl prepared trajectory handle (created by srwlUtiTrjPrep); if hndl = 0, all interpolating structures of trajectories kept in memory (including prepared ones) are released, so that they are not reused any more; handles created before remain valid and should still be deleted
+ * @return	integer error (>0) or warnig (<0) code
+ */
+EXP int CALL srwlUtiTrjPrepDel(SRWLPrtTrjPrep* hndl);
+
+/** 
+ * Prepares interpolation of magnetic field vs gap / phase (srwlCalcMagFld with precPar[0] = 1 or 2) for given mesh of resulting field and given container of tabulated fields, and keeps it until srwlUtiMagFldInterpPrepDel is called.
+ * Once prepared, srwlCalcMagFld calls with the same pDispMagFld mesh and pMagFld container (for any values of gap / phase) resample the field of each container member used at most once.
+ * Only containers of arbitrary 3D fields ('a' type) are supported; these fields are recognized by their data arrays and contents (checksums), so a modified field is resampled anew rather than taken for the prepared one.
+ * @param [out] pHndl pointer to the prepared interpolation handle created (to be deleted by srwlUtiMagFldInterpPrepDel)
+ * @param [in] pDispMagFld pointer to the container with one 3D magnetic field element defining the mesh of resulting field (as in srwlCalcMagFld)
+ * @param [in] pMagFld pointer to the container of tabulated magnetic fields (as in srwlCalcMagFld)
+ * @return	integer error (>0) or warnig (<0) code
+ * @see srwlUtiMagFldInterpPrepDel, srwlCalcMagFld
+ */
+EXP int CALL srwlUtiMagFldInterpPrep(SRWLMagFldInterpPrep** pHndl, SRWLMagFldC* pDispMagFld, SRWLMagFldC* pMagFld);
+
+/** 
+ * Releases prepared magnetic field interpolation.
+ * @param [in] hndl prepared interpolation handle (created by srwlUtiMagFldInterpPrep); if hndl = 0, all prepared interpolations are released, so that they are not reused any more; handles created before remain valid and should still be deleted
+ * @return	integer error (>0) or warnig (<0) code
+ */
+EXP int CALL srwlUtiMagFldInterpPrepDel(SRWLMagFldInterpPrep* hndl);
+
 /** 
  * Calculates Electric Field (Wavefront) of Synchrotron Radiation by a relativistic charged particle traveling in external 3D magnetic field
  * @param [in, out] pWfr pointer to resulting Wavefront structure; all data arrays should be allocated in a calling function/application; the mesh, presentation, etc., should be specified in this structure at input
  * @param [in] pTrj pointer to pre-calculated particle trajectory structure; the initial conditions and particle type must be specified in pTrj->partInitCond; if the trajectory data arrays (pTrj->arX, pTrj->arXp, pTrj->arY, pTrj->arYp) are defined, the SR will be calculated from these data; if these arrays are not supplied (pointers are zero), the function will attempt to calculate the SR from the magnetic field data (pMagFld) which has to be supplied
  * @param [in] pMagFld optional pointer to input magnetic field (container) structure; to be taken into account only if particle trajectroy arrays (pTrj->arX, pTrj->arXp, pTrj->arY, pTrj->arYp) are not supplied
  * @param [in] precPar precision parameters: 
- *	   precPar[0]: method ID (0- "manual", 1- "auto-undulator", 2- "auto-wiggler")
+ *	   precPar[0]: method ID (0- "manual", 1- "auto-undulator", 2- "auto-wiggler", 3- "periodic": single-period integrals are computed for a few periods and interpolated over the periodic part of the field)
  *            [1]: step size or relative precision
  *            [2]: longitudinal position to start integration
  *            [3]: longitudinal position to finish integration
  *            [4]: number of points to use for trajectory calculation 
  *            [5]: calculate terminating terms or not: 0- don't calculate two terms, 1- do calculate two terms, 2- calculate only upstream term, 3- calculate only downstream term 
  *            [6]: sampling factor (for propagation, effective if > 0)
- *            [7]: ... 
+ *            [7]: initial number of periods at which single-period integrals are computed directly; more periods are added until the interpolation over periods converges ("periodic" method only; default 5)
+ *            [8]: period length [m] ("periodic" method only; if [8] or [10] is not defined, the periodic part is taken from the first undulator in pMagFld, excluding one period at each end)
+ *            [9]: longitudinal position of the start of the periodic part [m] ("periodic" method only)
+ *            [10]: number of periods in the periodic part ("periodic" method only)
  * @param [in] nPrecPar number of precision parameters 
  * @return	integer error (>0) or warnig (<0) code
  * @see ...
@@ -649,6 +787,17 @@ EXP int CALL srwlCalcElecFieldSR(SRWLWfr* pWfr, SRWLPrtTrj* pTrj, SRWLMagFldC* p
  */
 EXP int CALL srwlCalcElecFieldGaussian(SRWLWfr* pWfr, SRWLGsnBm* pGsnBm, double* precPar =0);
 
+/** 
+ * Calculates Electric Fields (Wavefronts) of a set of Gauss-Hermite modes of a coherent Gaussian Beam (e.g. for coherent-mode-based partially-coherent simulations)
+ * @param [in, out] arWfr array of pointers to resulting Wavefront structures (one per mode); all data arrays should be allocated in a calling function/application; all wavefronts should have the same mesh, presentation, etc., specified at input
+ * @param [in] nWfr number of wavefronts (/modes) to calculate
+ * @param [in] pGsnBm pointer to a Gaussian beam parameters structure (pGsnBm->mx, pGsnBm->my are ignored)
+ * @param [in] arModeInds array of mode indexes: arModeInds[2*i], arModeInds[2*i+1] are the orders (mx, my) of the mode to be calculated in arWfr[i]
+ * @return	integer error (>0) or warnig (<0) code
+ * @see ...
+ */
+EXP int CALL srwlCalcElecFieldGaussianModes(SRWLWfr** arWfr, int nWfr, SRWLGsnBm* pGsnBm, int* arModeInds);
+
 /** 
  * Calculates Electric Field (Wavefront) of a Pont Source (i.e. spherical wave)
  * @param [in, out] pWfr pointer to resulting Wavefront structure; all data arrays should be allocated in a calling function/application; the mesh, presentation, etc., should be specified in this structure at input
@@ -692,6 +841,24 @@ EXP int CALL srwlCalcStokesUR(SRWLStokes* pStokes, SRWLPartBeam* pElBeam, SRWLMa
  */
 EXP int CALL srwlCalcPowDenSR(SRWLStokes* pStokes, SRWLPartBeam* pElBeam, SRWLPrtTrj* pTrj, SRWLMagFldC* pMagFld, double* precPar =0);
 
+/** 
+ * Calculates Power Density distribution of Synchrotron Radiation (as srwlCalcPowDenSR) using adaptive refinement of the observation mesh:
+ * power density is computed on a coarse grid, which is refined only where interpolation error exceeds relTol*(max. power density); values at the other mesh points are interpolated.
+ * Adaptive refinement is only used for transverse flat observation planes; in other cases power density is computed at all points of the mesh.
+ * @param [in, out] pStokes pointer to resulting Stokes structure (as in srwlCalcPowDenSR)
+ * @param [in] pElBeam pointer to input electron beam structure 
+ * @param [in] pTrj pointer to input trajectory structure (as in srwlCalcPowDenSR)
+ * @param [in] pMagFld pointer to input magnetic field container structure (as in srwlCalcPowDenSR)
+ * @param [in] precPar precision parameters (5 elements, as in srwlCalcPowDenSR)
+ * @param [in] relTol relative tolerance of the mesh refinement (if <= 0, power density is computed at all points of the mesh)
+ * @param [out] arStat optional array of 2 elements receiving refinement statistics:
+ *             arStat[0]: number of observation points at which power density was computed
+ *             [1]: number of mesh refinement levels used
+ * @return	integer error (>0) or warnig (<0) code
+ * @see srwlCalcPowDenSR
+ */
+EXP int CALL srwlCalcPowDenSRAdapt(SRWLStokes* pStokes, SRWLPartBeam* pElBeam, SRWLPrtTrj* pTrj, SRWLMagFldC* pMagFld, double* precPar, double relTol, double* arStat =0);
+
 /** 
  * Calculates/extracts Intensity and/or other characteristics from pre-calculated Electric Field
  * @param [out] pInt pointer to resulting Intensity (array)
@@ -727,8 +894,10 @@ EXP int CALL srwlCalcPowDenSR(SRWLStokes* pStokes, SRWLPartBeam* pElBeam, SRWLPr
  * @param [in] x horizontal position (to keep fixed)
  * @param [in] y vertical position (to keep fixed)
  * @param [in] arMeth array of (Mutual) Intensity extraction method-related parameters:
- *			   arMeth[0]: method number (0- simple calculation of Intensity (default); 1- calculation of Intensity with instant averaging; 2- adding of new Intensity value to previous one);
- *			   arMeth[1]: method-dependent parameter: if(arMeth[0]==1) it is iteration number
+ *			   arMeth[0]: method number (0- simple calculation of Intensity (default); 1- calculation of Intensity with instant averaging; 2- adding of new Intensity value to previous one;
+ *			              3- unwrapping of single-electron radiation phase vs x&y (intType = 4, depType = 3), otherwise phase is in [-Pi, Pi]);
+ *			   arMeth[1]: method-dependent parameter: if(arMeth[0]==1) it is iteration number; if(arMeth[0]==3) it is phase unwrapping method (1- scan of center row and all columns;
+ *			              2- quality-guided, i.e. following decreasing reliability of points, robust to noise and discontinuities; points of zero intensity are excluded)
  *			   arMeth[2]: horizontal wavefront radius of curvature defining quadratic term of radiation phase to be "subtracted" before calculation of Mutual Intensity (to be taken into account if != 0)
  *			   arMeth[3]: vertical wavefront radius of curvature defining quadratic term of radiation phase to be "subtracted" before calculation of Mutual Intensity (to be taken into account if != 0)
  *			   arMeth[4]: horizontal wavefront center defining quadratic term of radiation phase to be "subtracted" before calculation of Mutual Intensity
@@ -920,6 +1089,29 @@ EXP int CALL srwlUtiConvWithGaussian(char* pcData, char typeData, double* arMesh
  */
 EXP int CALL srwlUtiIntInf(double* arInf, char* pcData, char typeData, SRWLRadMesh* pMesh, double* arPar=0, int nPar=0);
 
+/** 
+ * Calculates statistical characteristics of a number of 1D or 2D intensity distributions in one pass over the data of each distribution
+ * @param [out] arInf (double) array of characteristics, 16 values per distribution:
+ *                  [0]: peak (max.) intensity
+ *                  [1], [2]: positions of peak intensity vs 1st and 2nd dimensions
+ *                  [3], [4]: FWHM values vs 1st and 2nd dimensions (as in srwlUtiIntInf)
+ *                  [5], [6]: (optional) Full Widths at Fractions arPar[1], arPar[2] of Maximum vs 1st and 2nd dimensions
+ *                  [7]: integral of intensity
+ *                  [8], [9]: centroid positions vs 1st and 2nd dimensions
+ *                  [10], [11]: RMS sizes vs 1st and 2nd dimensions
+ *                  [12], [13]: (optional) limits vs 1st dimension, within which the fraction arPar[3] of the integral is located (from projection of the distribution)
+ *                  [14], [15]: (optional) same limits vs 2nd dimension
+ * @param [in] pcData (char) pointer to intensity distributions, stored one after another
+ * @param [in] typeData character specifying data type ('f' for float, 'd' for double)
+ * @param [in] pMesh (pointer to SRWLRadMesh) mesh of one intensity distribution; if pMesh->ne > 1, each photon energy slice is treated separately
+ * @param [in] nFrames number of intensity distributions on pMesh; characteristics are stored for (nFrames*pMesh->ne) distributions, photon energy index varying fastest
+ * @param [in] arPar optional array of parameters: arPar[0..2] as in srwlUtiIntInf; arPar[3]: fraction of integral for determining the limits
+ * @param [in] nPar optional length of array of parameters
+ * @return	integer error (>0) or warnig (<0) code
+ * @see srwlUtiIntInf
+ */
+EXP int CALL srwlUtiIntInfMult(double* arInf, char* pcData, char typeData, SRWLRadMesh* pMesh, int nFrames, double* arPar=0, int nPar=0);
+
 /** 
  * Performs misc. operations on intensity distribution (or similar C-aligned) arrays
  * @param [in, out] pcI1 (char) pointer to intensity distribution data #1
@@ -955,6 +1147,42 @@ EXP int CALL srwlUtiIntInf(double* arInf, char* pcData, char typeData, SRWLRadMe
 EXP int CALL srwlUtiIntProc(char* pcI1, char typeI1, SRWLRadMesh* pMesh1, char* pcI2, char typeI2, SRWLRadMesh* pMesh2, double* arPar, int nPar);
 //EXP int CALL srwlUtiIntProc(char* pcI1, char typeI1, SRWLRadMesh* pMesh1, char* pcI2, char typeI2, SRWLRadMesh* pMesh2, double* arPar);
 
+/** 
+ * Performs azimuthal integration or averaging (as srwlUtiIntProc with arPar[0] = 3) for a number of 2D intensity distributions ("frames") on the same mesh.
+ * @param [out] pcI1 (char) pointer to resulting 1D distributions, stored one after another
+ * @param [in] typeI1 character specifying resulting data type ('f' for float, 'd' for double)
+ * @param [in] pMesh1 (pointer to SRWLRadMesh) mesh of one resulting 1D distribution
+ * @param [in] pcI2 (char) pointer to 2D intensity distributions, stored one after another
+ * @param [in] typeI2 character specifying input data type ('f' for float, 'd' for double)
+ * @param [in] pMesh2 (pointer to SRWLRadMesh) mesh of one 2D intensity distribution
+ * @param [in] nFrames number of 2D intensity distributions
+ * @param [in] arPar array of parameters, as in srwlUtiIntProc (arPar[0] = 3); with fixed numbers of points vs azimuth (arPar[2] = 1), the resampling plan is computed once for all frames (or taken from srwlUtiIntProcPrep)
+ * @param [in] nPar length of array of parameters
+ * @return	integer error (>0) or warnig (<0) code
+ * @see srwlUtiIntProc, srwlUtiIntProcPrep
+ */
+EXP int CALL srwlUtiIntProcMult(char* pcI1, char typeI1, SRWLRadMesh* pMesh1, char* pcI2, char typeI2, SRWLRadMesh* pMesh2, int nFrames, double* arPar, int nPar);
+
+/** 
+ * Prepares resampling plan of azimuthal integration or averaging (srwlUtiIntProc / srwlUtiIntProcMult with arPar[0] = 3 and arPar[2] = 1) for given meshes and parameters, and keeps it until srwlUtiIntProcPrepDel is called.
+ * Once prepared, calls with the same meshes and parameters (for any intensity data) use the plan instead of interpolating at each point.
+ * @param [out] pHndl pointer to the prepared processing handle created (to be deleted by srwlUtiIntProcPrepDel)
+ * @param [in] pMesh1 (pointer to SRWLRadMesh) mesh of resulting 1D distribution
+ * @param [in] pMesh2 (pointer to SRWLRadMesh) mesh of 2D intensity distribution
+ * @param [in] arPar array of parameters, as in srwlUtiIntProc
+ * @param [in] nPar length of array of parameters
+ * @return	integer error (>0) or warnig (<0) code
+ * @see srwlUtiIntProcPrepDel, srwlUtiIntProc
+ */
+EXP int CALL srwlUtiIntProcPrep(SRWLIntProcPlan** pHndl, SRWLRadMesh* pMesh1, SRWLRadMesh* pMesh2, double* arPar, int nPar);
+
+/** 
+ * Releases prepared intensity processing.
+ * @param [in] hndl prepared processing handle (created by srwlUtiIntProcPrep)
+ * @return	integer error (>0) or warnig (<0) code
+ */
+EXP int CALL srwlUtiIntProcPrepDel(SRWLIntProcPlan* hndl);
+
 /** 
  * Attempts to deduce parameters of peridic undulator magnetic field from tabulated field and set up Undulator structure
  * @param [in, out] pUndCnt pointer to magnetic field container structure with undulator structure to be set up
@@ -986,6 +1214,20 @@ EXP int CALL srwlUtiUndFromMagFldTab(SRWLMagFldC* pUndCnt, SRWLMagFldC* pMagCnt,
  */
 EXP int CALL srwlUtiUndFindMagFldInterpInds(int* arResInds, int* pnResInds, double* arGaps, double* arPhases, int nVals, double arPrecPar[5]);
 
+/** 
+ * Generates 6D phase-space coordinates of particles of a beam with Gaussian distribution defined by its 1st and 2nd order statistical moments;
+ * i-th particle depends only on its index (and on seed), so that blocks of particles can be generated by different threads / processes with bit-reproducible results
+ * @param [out] arPart array of particle coordinates: arPart[6*i] = x [m], arPart[6*i+1] = x' [rad], arPart[6*i+2] = y [m], arPart[6*i+3] = y' [rad], arPart[6*i+4] = z [m], arPart[6*i+5] = gamma (relative energy), for i = 0, 1, ... nPart-1
+ * @param [in] nPart number of particles to generate
+ * @param [in] pPartBeam pointer to particle beam structure (partStatMom1 and arStatMom2 are used)
+ * @param [in] iStart index of the first particle to generate (i.e. number of particles to skip)
+ * @param [in] typeGen type of generator: 1- LPTau (Sobol) quasi-random sequence (fewer than 2^52 particles), 2- counter-based pseudo-random generator
+ * @param [in] seed seed of the pseudo-random generator (used for typeGen = 2)
+ * @return	integer error (>0) or warnig (<0) code
+ * @see ...
+ */
+EXP int CALL srwlUtiSampPartBeam(double* arPart, long long nPart, SRWLPartBeam* pPartBeam, long long iStart, char typeGen, long long seed);
+
 //#ifdef _OFFLOAD_GPU //OC18022024 (commented-out) //HG30112023
 /**
  * Implements GPU related operations.
@@ -0,0 +1,161 @@
+/************************************************************************//**
+ * File: srwlprof.h
+ * Description: SRWLIB built-in profiling: wall time, numbers of calls and volumes of data processed by main computation stages (header-only)
+ * Project: Synchrotron Radiation Workshop Library (SRWLib)
+ * First release: 2026
+ *
+ * SRW is Copyright (C) European Synchrotron Radiation Facility, Grenoble, France
+ * SRW C/C++ API (SRWLib) is Copyright (C) European XFEL, Hamburg, Germany
+ * All Rights Reserved
+ *
+ * @version see srwlUtiVerNo
+ ***************************************************************************/
+
+#ifndef __SRWLPROF_H
+#define __SRWLPROF_H
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+//-------------------------------------------------------------------------
+
+enum { //profiled computation stages (names are returned by CSRWLProf::StageName)
+	srwlProfPropag = 1, //propagation of wavefront through optical elements
+	srwlProfFFT2D,
+	srwlProfFFT1D,
+	srwlProfResize, //resizing of wavefront
+	srwlProfPointModif, //point-by-point modification (traversal) of wavefront by optical element
+	srwlProfRadInteg, //calculation of electric field by integration over trajectory
+	srwlProfTrjInteg, //calculation of particle trajectory
+	srwlProfMutInt, //update of mutual intensity
+	srwlProfNumStages
+};
+
+//-------------------------------------------------------------------------
+
+class CSRWLProf {
+//Process-wide tree of profiled stages: each node accumulates data on calls of a stage made from the stage of its parent node.
+//Nesting of stages is followed per thread: stages started in other threads (e.g. OpenMP workers) are attached to the root.
+//When profiling is disabled (default), a profiled scope costs one check of an atomic flag.
+
+public:
+
+	static const int maxNodes = 512;
+
+	struct TNode {
+		int iParent, iStage;
+		std::atomic<int> arChild[srwlProfNumStages];
+		std::atomic<long long> nCalls, nsTot, nsChild, nBytes;
+	};
+
+	std::atomic<bool> m_isOn;
+	std::atomic<int> m_nNodes;
+	TNode m_arNodes[maxNodes]; //node 0 is root
+	std::mutex m_mtx;
+
+	CSRWLProf()
+	{
+		m_isOn = false;
+		m_nNodes = 1;
+		for(int i=0; i<maxNodes; i++)
+		{
+			TNode &node = m_arNodes[i];
+			node.iParent = -1; node.iStage = 0;
+			for(int j=0; j<srwlProfNumStages; j++) node.arChild[j] = 0;
+			node.nCalls = 0; node.nsTot = 0; node.nsChild = 0; node.nBytes = 0;
+		}
+	}
+
+	static CSRWLProf& Inst()
+	{
+		static CSRWLProf prof;
+		return prof;
+	}
+	static int& CurNode() //node of the stage being executed by calling thread
+	{
+		static thread_local int iNode = 0;
+		return iNode;
+	}
+	static bool IsOn() { return Inst().m_isOn.load(std::memory_order_relaxed);}
+
+	int FindOrAddNode(int iParent, int iStage) //returns -1 if the tree is full
+	{
+		int iNode = m_arNodes[iParent].arChild[iStage].load(std::memory_order_acquire);
+		if(iNode > 0) return iNode;
+
+		std::lock_guard<std::mutex> lock(m_mtx);
+		iNode = m_arNodes[iParent].arChild[iStage].load(std::memory_order_relaxed);
+		if(iNode > 0) return iNode;
+		iNode = m_nNodes.load(std::memory_order_relaxed);
+		if(iNode >= maxNodes) return -1;
+		m_arNodes[iNode].iParent = iParent; m_arNodes[iNode].iStage = iStage;
+		m_nNodes.store(iNode + 1, std::memory_order_release);
+		m_arNodes[iParent].arChild[iStage].store(iNode, std::memory_order_release);
+		return iNode;
+	}
+
+	void Reset() //zeroes accumulated data, keeping the tree
+	{
+		int nNodes = m_nNodes.load(std::memory_order_acquire);
+		for(int i=0; i<nNodes; i++)
+		{
+			TNode &node = m_arNodes[i];
+			node.nCalls = 0; node.nsTot = 0; node.nsChild = 0; node.nBytes = 0;
+		}
+	}
+
+	static const char* StageName(int iStage)
+	{
+		static const char* arNames[] = {"", "Propag", "FFT2D", "FFT1D", "Resize", "PointModif", "RadInteg", "TrjInteg", "MutInt"};
+		return ((iStage > 0) && (iStage < srwlProfNumStages))? arNames[iStage] : 0;
+	}
+};
+
+//-------------------------------------------------------------------------
+
+class CSRWLProfScope {
+//Profiled scope: to be declared at the beginning of code of a stage
+	int m_iNode, m_iPrevNode;
+	std::chrono::steady_clock::time_point m_tStart;
+
+public:
+
+	CSRWLProfScope(int iStage, long long nBytes=0)
+	{
+		m_iNode = -1;
+		if(!CSRWLProf::IsOn()) return;
+
+		CSRWLProf &prof = CSRWLProf::Inst();
+		int &iCurNode = CSRWLProf::CurNode();
+		m_iNode = prof.FindOrAddNode(iCurNode, iStage);
+		if(m_iNode < 0) return;
+
+		m_iPrevNode = iCurNode;
+		iCurNode = m_iNode;
+		if(nBytes > 0) prof.m_arNodes[m_iNode].nBytes.fetch_add(nBytes, std::memory_order_relaxed);
+		m_tStart = std::chrono::steady_clock::now();
+	}
+
+	~CSRWLProfScope()
+	{
+		if(m_iNode < 0) return;
+
+		long long ns = (long long)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_tStart).count();
+		CSRWLProf &prof = CSRWLProf::Inst();
+		CSRWLProf::TNode &node = prof.m_arNodes[m_iNode];
+		node.nCalls.fetch_add(1, std::memory_order_relaxed);
+		node.nsTot.fetch_add(ns, std::memory_order_relaxed);
+		if(m_iPrevNode > 0) prof.m_arNodes[m_iPrevNode].nsChild.fetch_add(ns, std::memory_order_relaxed);
+		CSRWLProf::CurNode() = m_iPrevNode;
+	}
+
+	void AddBytes(long long nBytes)
+	{
+		if((m_iNode >= 0) && (nBytes > 0)) CSRWLProf::Inst().m_arNodes[m_iNode].nBytes.fetch_add(nBytes, std::memory_order_relaxed);
+	}
+};
+
+//-------------------------------------------------------------------------
+
+#endif
@@ -11747,11 +11747,12 @@ function calculates charged particle trajectory in external 3D magnetic field (i
 """
 helpCalcPartTrajFromKickMatr = """CalcPartTrajFromKickMatr(_prtTrj, _inKickM, _inPrec)
 function calculates charged particle trajectory from one or a list of kick-matrices
-:param _prtTrj: input / output trajectory structure (instance of SRWLPrtTrj);
+:param _prtTrj: input / output trajectory structure (instance of SRWLPrtTrj) or a list of such structures;
        note that all data arrays should be allocated in Python script before calling this function;
        initial conditions and particle type must be specified in _partTraj.partInitCond;
        the initial conditions are assumed to be given for ct = 0,
-       however the trajectory will be calculated for the mesh defined by _prtTrj.np, _prtTrj.ctStart, _prtTrj.ctEnd
+       however the trajectory will be calculated for the mesh defined by _prtTrj.np, _prtTrj.ctStart, _prtTrj.ctEnd;
+       trajectories of a list are calculated in parallel, with the kick-matrices prepared once for all of them
 :param _inKickM: input kick-matrix (instance of SRWLKickM) or a list of such kick-matrices
 :param _inPrec: input list of calculation parameters:
        _inPrec[0]: switch specifying whether the new trajectory data should be added to pre-existing trajectory data (=1, default)
@@ -11835,6 +11836,10 @@ traveling in arbitrary magnetic field
        _inPrec[2]: initial longitudinal position [m] (effective if < _inPrec[3])
        _inPrec[3]: final longitudinal position [m] (effective if > _inPrec[2])
        _inPrec[4]: number of points to use for trajectory calculation 
+       _inPrec[5]: relative tolerance of adaptive observation mesh refinement (=0 or absent -power density is computed at all mesh points;
+                   >0 -it is computed on a coarse grid refined only where interpolation error exceeds this fraction of max. power density)
+       _inPrec[6]: (output, if _inPrec is a list of at least 8 elements) number of observation points at which power density was computed
+       _inPrec[7]: (output) number of mesh refinement levels used
 """
 helpCalcIntFromElecField = """CalcIntFromElecField(_arI, _inWfr, _inPol, _inIntType, _inDepType, _inE, _inX, _inY)
 function calculates/"extracts" Intensity from pre-calculated Electric Field